@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2009--2018, the KLFitter developer team
+ *
+ * This file is part of KLFitter.
+ *
+ * KLFitter is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * KLFitter is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with KLFitter. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLFITTER_DUAL_H_
+#define KLFITTER_DUAL_H_
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// ---------------------------------------------------------
+
+/**
+ * \namespace KLFitter
+ * \brief The KLFitter namespace
+ */
+namespace KLFitter {
+/**
+  * \class KLFitter::Dual
+  * \brief A dual number for forward-mode automatic differentiation.
+  *
+  * A dual number holds a value and its derivatives with respect to N
+  * parameters. All arithmetic operations and mathematical functions
+  * propagate the derivatives with the chain rule, so that a function
+  * written as a template over the scalar type yields its exact
+  * gradient when evaluated with Dual<N> instead of double. The
+  * mathematical functions are found by argument-dependent lookup, so
+  * templated code calls them unqualified, e.g. sqrt(x). See
+  * LikelihoodBase::LogLikelihoodGradient() and EvaluateGradient().
+  */
+template <std::size_t N>
+class Dual final {
+ public:
+  /** \name Constructors and destructors */
+  /* @{ */
+
+  /**
+    * The constructor of a constant, i.e. with vanishing derivatives.
+    * @param value The value.
+    */
+  Dual(double value = 0.) : fValue(value), fDerivatives() { fDerivatives.fill(0.); }
+
+  /**
+    * The constructor of a parameter.
+    * @param value The value of the parameter.
+    * @param index The index of the parameter.
+    */
+  Dual(double value, std::size_t index) : Dual(value) { fDerivatives[index] = 1.; }
+
+  /* @} */
+  /** \name Member functions (Get)  */
+  /* @{ */
+
+  /**
+    * Return the value.
+    */
+  double Value() const { return fValue; }
+
+  /**
+    * Return the derivative with respect to a parameter.
+    * @param index The index of the parameter.
+    * @return The derivative.
+    */
+  double Derivative(std::size_t index) const { return fDerivatives[index]; }
+
+  /**
+    * Return a function of this dual number, given the value of the
+    * function and its derivative at the value of this number.
+    * @param value The value of the function.
+    * @param derivative The derivative of the function.
+    * @return The function as a dual number.
+    */
+  Dual Chain(double value, double derivative) const {
+    Dual result(value);
+    for (std::size_t i = 0; i < N; ++i) result.fDerivatives[i] = derivative * fDerivatives[i];
+    return result;
+  }
+
+  /* @} */
+  /** \name Operators and mathematical functions  */
+  /* @{ */
+
+  Dual& operator+=(const Dual& o) {
+    fValue += o.fValue;
+    for (std::size_t i = 0; i < N; ++i) fDerivatives[i] += o.fDerivatives[i];
+    return *this;
+  }
+
+  Dual& operator-=(const Dual& o) {
+    fValue -= o.fValue;
+    for (std::size_t i = 0; i < N; ++i) fDerivatives[i] -= o.fDerivatives[i];
+    return *this;
+  }
+
+  Dual& operator*=(const Dual& o) {
+    for (std::size_t i = 0; i < N; ++i) fDerivatives[i] = fDerivatives[i] * o.fValue + fValue * o.fDerivatives[i];
+    fValue *= o.fValue;
+    return *this;
+  }
+
+  Dual& operator/=(const Dual& o) {
+    const double inverse = 1. / o.fValue;
+    fValue /= o.fValue;
+    for (std::size_t i = 0; i < N; ++i) fDerivatives[i] = (fDerivatives[i] - fValue * o.fDerivatives[i]) * inverse;
+    return *this;
+  }
+
+  Dual& operator+=(double a) { fValue += a; return *this; }
+  Dual& operator-=(double a) { fValue -= a; return *this; }
+
+  Dual& operator*=(double a) {
+    fValue *= a;
+    for (auto& d : fDerivatives) d *= a;
+    return *this;
+  }
+
+  Dual& operator/=(double a) {
+    fValue /= a;
+    for (auto& d : fDerivatives) d /= a;
+    return *this;
+  }
+
+  friend Dual operator-(Dual x) {
+    x.fValue = -x.fValue;
+    for (auto& d : x.fDerivatives) d = -d;
+    return x;
+  }
+
+  friend Dual operator+(Dual x, const Dual& y) { return x += y; }
+  friend Dual operator-(Dual x, const Dual& y) { return x -= y; }
+  friend Dual operator*(Dual x, const Dual& y) { return x *= y; }
+  friend Dual operator/(Dual x, const Dual& y) { return x /= y; }
+  friend Dual operator+(Dual x, double a) { return x += a; }
+  friend Dual operator-(Dual x, double a) { return x -= a; }
+  friend Dual operator*(Dual x, double a) { return x *= a; }
+  friend Dual operator/(Dual x, double a) { return x /= a; }
+  friend Dual operator+(double a, Dual x) { return x += a; }
+  friend Dual operator-(double a, const Dual& x) { return -x + a; }
+  friend Dual operator*(double a, Dual x) { return x *= a; }
+  friend Dual operator/(double a, const Dual& x) { return x.Chain(a / x.fValue, -a / (x.fValue * x.fValue)); }
+
+  friend bool operator<(const Dual& x, const Dual& y) { return x.fValue < y.fValue; }
+  friend bool operator>(const Dual& x, const Dual& y) { return x.fValue > y.fValue; }
+  friend bool operator<=(const Dual& x, const Dual& y) { return x.fValue <= y.fValue; }
+  friend bool operator>=(const Dual& x, const Dual& y) { return x.fValue >= y.fValue; }
+
+  friend Dual sqrt(const Dual& x) {
+    const double value = std::sqrt(x.fValue);
+    return x.Chain(value, 0.5 / value);
+  }
+
+  friend Dual log(const Dual& x) { return x.Chain(std::log(x.fValue), 1. / x.fValue); }
+
+  friend Dual exp(const Dual& x) {
+    const double value = std::exp(x.fValue);
+    return x.Chain(value, value);
+  }
+
+  friend Dual pow(const Dual& x, double a) { return x.Chain(std::pow(x.fValue, a), a * std::pow(x.fValue, a - 1.)); }
+  friend Dual sin(const Dual& x) { return x.Chain(std::sin(x.fValue), std::cos(x.fValue)); }
+  friend Dual cos(const Dual& x) { return x.Chain(std::cos(x.fValue), -std::sin(x.fValue)); }
+  friend Dual sinh(const Dual& x) { return x.Chain(std::sinh(x.fValue), std::cosh(x.fValue)); }
+  friend Dual cosh(const Dual& x) { return x.Chain(std::cosh(x.fValue), std::sinh(x.fValue)); }
+  friend Dual fabs(const Dual& x) { return x.fValue < 0. ? -x : x; }
+
+  /* @} */
+
+ private:
+  /**
+    * The value.
+    */
+  double fValue;
+
+  /**
+    * The derivatives with respect to the parameters.
+    */
+  std::array<double, N> fDerivatives;
+};
+
+/**
+  * Return the value of a scalar, i.e. the scalar itself.
+  */
+inline double Value(double x) { return x; }
+
+/**
+  * Return the value of a dual number.
+  */
+template <std::size_t N>
+double Value(const Dual<N>& x) { return x.Value(); }
+
+/**
+  * The logarithm of the relativistic Breit-Wigner distribution, the
+  * equivalent of BCMath::LogBreitWignerRel() for any scalar type.
+  * @param x The value of the random variable.
+  * @param mean The mean.
+  * @param gamma The width.
+  * @return The logarithm of the (unnormalized) distribution.
+  */
+template <typename T>
+T LogBreitWignerRel(const T& x, const T& mean, double gamma) {
+  using std::log;
+  return -log((x * x - mean * mean) * (x * x - mean * mean) + mean * mean * gamma * gamma);
+}
+
+/**
+  * Evaluate a function of the parameters and its gradient by
+  * forward-mode automatic differentiation.
+  * @param function The function, taking a std::vector<Dual<N> > of the
+  * parameters and returning a Dual<N>.
+  * @param parameters The parameters, at most N values. The callers
+  * check the number, as the function is evaluated by the minimizer.
+  * @param gradient The gradient, resized to the number of parameters.
+  * @return The value of the function.
+  */
+template <std::size_t N, typename Function>
+double EvaluateGradient(Function function, const std::vector<double>& parameters, std::vector<double>* gradient) {
+  const std::size_t n = parameters.size();
+  std::vector<Dual<N> > dual;
+  dual.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+    dual.emplace_back(parameters[i], i);
+
+  const Dual<N> result = function(dual);
+  gradient->resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+    (*gradient)[i] = result.Derivative(i);
+  return result.Value();
+}
+}  // namespace KLFitter
+
+#endif  // KLFITTER_DUAL_H_
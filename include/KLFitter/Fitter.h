@@ -20,6 +20,9 @@
 #ifndef KLFITTER_FITTER_H_
 #define KLFITTER_FITTER_H_
 
+#include <chrono>
+#include <functional>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -116,6 +119,29 @@ class Fitter final {
     */
   int SetParticles(KLFitter::Particles * particles, int nPartonsInPermutations = -1);
 
+  /**
+    * Only create a range of the permutations of the events, e.g. to
+    * share the permutations of a large event between several jobs (see
+    * Permutations::CreatePermutations()). The permutations are ranked
+    * before the b-tagging vetoes of the likelihood are applied.
+    * @param first The rank of the first permutation.
+    * @param count The number of permutations (all if negative).
+    */
+  void SetPermutationRange(long long first, long long count) { fPermutationFirst = first; fPermutationCount = count; }
+
+  /**
+    * Cache the permutation tables across events. The table of an event
+    * only depends on the numbers of particles, the invariances of the
+    * likelihood and, for the veto b-tagging methods, on which partons
+    * are b-tagged. With the cache, SetParticles() re-uses the table of
+    * a previous event with the same signature and only binds the new
+    * particles to it (without any further setup if the permutations
+    * are index-only, see Permutations::SetIndexOnly()). The cache is
+    * cleared when it is full and when the likelihood is set.
+    * @param maxentries The maximum number of cached tables (no cache if 0).
+    */
+  void SetPermutationCache(std::size_t maxentries) { fPermutationCacheSize = maxentries; fPermutationCache.clear(); }
+
   /**
     * Set truth particles.
     * @param particles A pointer to a set of particles.
@@ -145,6 +171,9 @@ class Fitter final {
 
   /**
     * Perform the fit for a single permutation of jets and leptons.
+    * The calls into BAT are guarded by a process-wide lock, so
+    * fitters with their own likelihoods can be used from different
+    * threads.
     * @param index The permutation index.
     * @return An error code.
     */
@@ -163,7 +192,9 @@ class Fitter final {
   int Status();
 
   /**
-    * Turn of simulated annealing.
+    * Turn of simulated annealing. This skips the simulated annealing
+    * stages which are fallbacks, i.e. which are not always run (see
+    * SetMinimizationStages()).
     */
   void TurnOffSA() { fTurnOffSA = true; }
 
@@ -174,7 +205,10 @@ class Fitter final {
     MinuitDidNotConverge = 1,
     FitAbortedDueToNaN = 2,
     AtLeastOneFitParameterAtItsLimit = 3,
-    InvalidTransferFunctionAtConvergence = 4
+    InvalidTransferFunctionAtConvergence = 4,
+    PermutationSkipped = 5,
+    FitNotRefined = 6,
+    BudgetExceeded = 7
   };
 
   /**
@@ -184,6 +218,9 @@ class Fitter final {
   static const unsigned int FitAbortedDueToNaNMask = 0x1 << FitAbortedDueToNaN;
   static const unsigned int AtLeastOneFitParameterAtItsLimitMask = 0x1 << AtLeastOneFitParameterAtItsLimit;
   static const unsigned int InvalidTransferFunctionAtConvergenceMask = 0x1 << InvalidTransferFunctionAtConvergence;
+  static const unsigned int PermutationSkippedMask = 0x1 << PermutationSkipped;
+  static const unsigned int FitNotRefinedMask = 0x1 << FitNotRefined;
+  static const unsigned int BudgetExceededMask = 0x1 << BudgetExceeded;
 
   /**
     * Enumerator for the minimization methods.
@@ -191,10 +228,127 @@ class Fitter final {
   enum kMinimizationMethod { kMinuit, kSimulatedAnnealing, kMarkovChainMC };
 
   /**
-    * Set the minimization method.
+    * Set the minimization method. This sets the default stages of
+    * the method (see SetMinimizationStages()): for Minuit, a Minuit
+    * fit, followed by simulated annealing from the initial parameters
+    * and another Minuit fit if the first fit failed; for simulated
+    * annealing and Markov Chain MC a single stage.
     * @param method The minimization method.
     */
-  void SetMinimizationMethod(kMinimizationMethod method) { fMinimizationMethod = method; }
+  void SetMinimizationMethod(kMinimizationMethod method);
+
+  /**
+    * Enumerator for the pruning of permutations: no pruning, skip
+    * permutations which cannot beat the best permutation fitted so
+    * far, or skip permutations which cannot add more than a given
+    * fraction to the sum of the event probabilities.
+    */
+  enum kPruningMode { kNoPruning, kPruneWorseThanBest, kPruneNegligible };
+
+  /**
+    * Set the pruning of permutations. Before fitting a permutation,
+    * Fit(int) compares the upper bound of its event probability (see
+    * LikelihoodBase::LogEventProbabilityUpperBound()) with the
+    * permutations of the event fitted before. If the permutation
+    * cannot contribute, the fit is skipped, the initial parameters
+    * are kept and the Minuit status is set to 511, with the
+    * PermutationSkipped bit in the convergence status. Pruning is
+    * not applied with Markov Chain MC or integration.
+    * @param mode The pruning mode.
+    * @param fraction The fraction of the sum of the event
+    * probabilities below which permutations are skipped (kPruneNegligible).
+    */
+  void SetPruning(kPruningMode mode, double fraction = 1e-3) { fPruningMode = mode; fPruningFraction = fraction; }
+
+  /**
+    * Set a budget for the fits of the permutations of an event. The
+    * budget starts with the first fit after SetParticles(). Once half
+    * of the budget is used, the re-runs with simulated annealing after
+    * a failed Minuit fit are skipped; these permutations keep the
+    * first Minuit result and have the BudgetExceeded bit set in the
+    * convergence status. Once the budget is used up, the remaining
+    * permutations are not fitted: they keep the initial parameters,
+    * the Minuit status is set to 511 and the PermutationSkipped and
+    * BudgetExceeded bits are set. The fits which are running are not
+    * interrupted. In FitBatch() and FitParallel(), the workers share
+    * one budget per event: the time runs from the first fit of the
+    * event and the evaluations of all workers count towards it. In
+    * FitParallel(), the fits of this fitter since SetParticles() count
+    * as well.
+    * @param seconds The wall-clock time per event in seconds (0: no limit).
+    * @param evaluations The number of likelihood evaluations per event (0: no limit).
+    */
+  void SetEventBudget(double seconds, long evaluations = 0) { fBudgetTime = seconds; fBudgetEvaluations = evaluations; }
+
+  /**
+    * Start the Minuit fit of a permutation from the best-fit
+    * parameters of the most similar permutation of the event fitted
+    * before, instead of the measured values. The most similar
+    * permutation is the one with the fewest partons in different
+    * positions and the same leptons and photons. The fitted parton
+    * energies move with their jets; partons not present in that
+    * permutation start from their measured energies. Only
+    * permutations with a Minuit status of 0 are used as starting
+    * points. The re-run with simulated annealing still starts from
+    * the measured values. Requires a likelihood which implements
+    * LikelihoodBase::PartonEnergyParameters(); otherwise the fits
+    * start from the measured values as before.
+    * @param flag Turn the warm start on or off.
+    */
+  void SetWarmStart(bool flag) { fWarmStart = flag; }
+
+  /**
+    * Run the Minuit stages with the analytic gradient of the
+    * likelihood (see LikelihoodBase::HasAnalyticGradient() and
+    * LikelihoodBase::FindModeMinuit2()), instead of the numerical
+    * derivatives of Minuit in BAT. Likelihoods without an analytic
+    * gradient are fitted with numerical derivatives as before.
+    * @param flag Turn the analytic gradient on or off.
+    */
+  void SetUseAnalyticGradient(bool flag) { fUseAnalyticGradient = flag; }
+
+  /**
+    * Run the Minuit stages with Minuit2, which calls the likelihood
+    * directly (see LikelihoodBase::FindModeMinuit2()), instead of
+    * with Minuit in BAT (default). Unlike the fits through BAT, these
+    * fits can run concurrently, so only with Minuit2 do the Minuit
+    * stages of FitBatch() and FitParallel() run in parallel. The
+    * results differ slightly from those of Minuit in BAT.
+    * @param flag Turn Minuit2 on or off.
+    */
+  void SetUseMinuit2(bool flag) { fUseMinuit2 = flag; }
+
+  /**
+    * Enumerator for the ranking of the permutations after the coarse
+    * pass of FitCoarseToFine().
+    */
+  enum kRankingMode { kRankByLogLikelihood, kRankByEventProbability };
+
+  /**
+    * Set the Minuit settings of the coarse pass of FitCoarseToFine().
+    * @param maxcalls The maximum number of function calls.
+    * @param tolerance The Minuit tolerance.
+    */
+  void SetCoarseFit(int maxcalls, double tolerance) { fCoarseMaxCalls = maxcalls; fCoarseTolerance = tolerance; }
+
+  /**
+    * Perform the fit for all permutations in two passes. Every
+    * permutation is first fitted with a single Minuit pass with
+    * loose settings (see SetCoarseFit()) and without the re-run
+    * with simulated annealing. The permutations are then ranked and
+    * only the best ntop of them are fitted again to full precision,
+    * as in Fit(int), starting from the result of the coarse pass.
+    * The other permutations keep the result of the coarse pass and
+    * have the FitNotRefined bit set in the convergence status.
+    * Permutations with an LH-invariant partner are fitted and
+    * counted once. The results can be retrieved with
+    * LoadPermutation(); permutation 0 is loaded on return. Only
+    * available for Minuit.
+    * @param ntop The number of permutations which are refined.
+    * @param ranking The quantity by which the permutations are ranked.
+    * @return An error code.
+    */
+  int FitCoarseToFine(unsigned int ntop, kRankingMode ranking = kRankByEventProbability);
 
   /**
     * Write fCachedMinuitStatus and fCachedConvergenceStatus to
@@ -216,6 +370,345 @@ class Fitter final {
   int GetFitStatusFromCache(int iperm);
 
   /* @} */
+  /** \name Minimization stages  */
+  /* @{ */
+
+  /**
+    * Enumerator for the conditions under which a stage of the
+    * minimization is run: always, if the last Minuit stage failed,
+    * or if the last Minuit stage ended with one of the given status
+    * codes. The status of a Minuit stage is the Minuit error flag, or
+    * 500 if a parameter is at its limit, or 508 if the likelihood was
+    * NaN. Before the first Minuit stage, the status is -1.
+    */
+  enum kStageTrigger { kAlways, kOnFailure, kOnStatus };
+
+  /**
+    * Enumerator for the starting point of a stage: the starting point
+    * of the fit (the initial parameters, or the warm start and coarse
+    * result, see SetWarmStart() and FitCoarseToFine()), the initial
+    * parameters, or the best-fit parameters of the previous stages.
+    */
+  enum kStageStart { kStartFit, kStartInitial, kStartPrevious };
+
+  /**
+    * A stage of the minimization.
+    */
+  struct MinimizationStage {
+    /**
+      * The constructor.
+      * @param m The minimization method.
+      * @param t The condition under which the stage is run.
+      * @param s The starting point.
+      */
+    explicit MinimizationStage(kMinimizationMethod m = kMinuit, kStageTrigger t = kAlways, kStageStart s = kStartFit)
+      : method(m), trigger(t), start(s) { }
+
+    kMinimizationMethod method;
+    kStageTrigger trigger;
+    kStageStart start;
+
+    /**
+      * The status codes for kOnStatus.
+      */
+    std::vector<int> statuses;
+
+    /**
+      * Discard the results of the previous stages before the stage.
+      */
+    bool resetResults = false;
+
+    /**
+      * The maximum number of calls and the tolerance of Minuit;
+      * non-positive values keep the settings of the likelihood, which
+      * are set with its SetMinuitArlist().
+      */
+    int maxCalls = -1;
+    double tolerance = -1;
+
+    /**
+      * The start and end temperature of simulated annealing; negative
+      * values keep the settings of the likelihood.
+      */
+    double saT0 = -1;
+    double saTmin = -1;
+
+    /**
+      * The number of chains and iterations of Markov Chain MC.
+      */
+    int mcmcChains = 5;
+    int mcmcIterationsRun = 20000;
+    int mcmcIterationsMax = 1000000;
+  };
+
+  /**
+    * The statistics of a stage of the minimization.
+    */
+  struct StageStatistics {
+    /**
+      * The number of times the stage was run, and the number of times
+      * it was triggered but skipped (see TurnOffSA() and
+      * SetEventBudget()).
+      */
+    unsigned long runs = 0;
+    unsigned long skipped = 0;
+
+    /**
+      * The number of Minuit stages which ended with status 0.
+      */
+    unsigned long successes = 0;
+
+    /**
+      * The number of likelihood evaluations and the wall-clock time
+      * in seconds spent in the stage.
+      */
+    long evaluations = 0;
+    double seconds = 0;
+  };
+
+  /**
+    * Set the stages of the minimization of a permutation. The stages
+    * are run in order, each if its trigger condition holds. The Minuit
+    * status of the fit is the one of the last Minuit stage which was
+    * run. The method of the first stage is taken as the minimization
+    * method, e.g. for the pruning and the warm start. The statistics
+    * are reset.
+    * @param stages The stages.
+    * @return An error code.
+    */
+  int SetMinimizationStages(const std::vector<MinimizationStage>& stages);
+
+  /**
+    * Return the stages of the minimization.
+    * @return The stages.
+    */
+  const std::vector<MinimizationStage>& MinimizationStages() const { return fStages; }
+
+  /**
+    * Return the statistics of the stages of the minimization since
+    * they were set or reset, in the order of the stages. The batch and
+    * parallel fits add the statistics of their workers.
+    * @return The statistics.
+    */
+  const std::vector<StageStatistics>& GetStageStatistics() const { return fStageStatistics; }
+
+  /**
+    * Reset the statistics of the stages of the minimization.
+    */
+  void ResetStageStatistics() { fStageStatistics.assign(fStages.size(), StageStatistics()); }
+
+  /* @} */
+  /** \name Fit results  */
+  /* @{ */
+
+  /**
+    * The result of the fit of a single permutation. It is filled by
+    * Fit(int) from the values computed during the fit, so that the
+    * likelihood does not need to be evaluated again. Which parts are
+    * filled depends on the detail level, see SetResultDetail().
+    */
+  struct FitResult {
+    /**
+      * Whether the permutation has been fitted.
+      */
+    bool fitted = false;
+
+    /**
+      * The Minuit status and the convergence status bits, see
+      * MinuitStatus() and ConvergenceStatus().
+      */
+    int minuitStatus = -1;
+    unsigned int convergenceStatus = 0;
+
+    /**
+      * The log-likelihood at the best-fit parameters.
+      */
+    double logLikelihood = 0;
+
+    /**
+      * The contribution from b tagging to the log of the event
+      * probability (0 without b tagging).
+      */
+    double logEventProbabilityBTag = 0;
+
+    /**
+      * The log of the (not normalized) event probability.
+      */
+    double logEventProbability = 0;
+
+    /**
+      * The best-fit parameters and their errors (kResultParameters
+      * and above).
+      */
+    std::vector<double> parameters;
+    std::vector<double> parameterErrors;
+
+    /**
+      * The model particles at the best-fit parameters
+      * (kResultModelParticles only).
+      */
+    std::shared_ptr<KLFitter::Particles> modelParticles;
+  };
+
+  /**
+    * Enumerator for the detail level of the fit results: the
+    * probabilities and the fit status only, in addition the best-fit
+    * parameters, or in addition the model particles.
+    */
+  enum kResultDetail { kResultProbability, kResultParameters, kResultModelParticles };
+
+  /**
+    * Set the detail level of the fit results. The default is
+    * kResultParameters.
+    * @param detail The detail level.
+    */
+  void SetResultDetail(kResultDetail detail) { fResultDetail = detail; }
+
+  /**
+    * Return the result of a permutation of the current event.
+    * @param index The permutation index.
+    * @return A pointer to the result, or a null pointer if the
+    * permutation has not been fitted.
+    */
+  const FitResult * Result(int index) const;
+
+  /**
+    * Return the permutation of the current event with the largest
+    * event probability among the fitted permutations. Permutations
+    * which were skipped (see SetPruning() and SetEventBudget()) are
+    * not considered.
+    * @return The permutation index, -1 if no permutation has been fitted.
+    */
+  int BestPermutation() const;
+
+  /* @} */
+  /** \name Parallel fitting  */
+  /* @{ */
+
+  /**
+    * The input of a single event for the batch fit.
+    */
+  struct BatchEvent {
+    /**
+      * The constructor.
+      * @param p A pointer to the measured particles of the event.
+      * @param etx The x component of the missing ET.
+      * @param ety The y component of the missing ET.
+      * @param sumet The measured scalar sum of transverse energy.
+      * @param npartons The number of partons per permutation (see SetParticles()).
+      */
+    BatchEvent(KLFitter::Particles * p, double etx, double ety, double sumet, int npartons = -1)
+      : particles(p), etmiss_x(etx), etmiss_y(ety), sumet(sumet), nPartonsInPermutations(npartons) { }
+
+    KLFitter::Particles * particles;
+    double etmiss_x;
+    double etmiss_y;
+    double sumet;
+    int nPartonsInPermutations;
+  };
+
+  /**
+    * The result of the fit of a single event in the batch fit.
+    */
+  struct EventResult {
+    /**
+      * The status of the event: 1 if all permutations were
+      * fitted, 0 otherwise.
+      */
+    int status;
+
+    /**
+      * The results of the individual permutations, in the order
+      * of the permutation table.
+      */
+    std::vector<FitResult> permutations;
+  };
+
+  /**
+    * A function returning a new, fully configured likelihood.
+    * The batch fit calls it once per worker thread.
+    */
+  typedef std::function<std::unique_ptr<KLFitter::LikelihoodBase>()> LikelihoodFactory;
+
+  /**
+    * Fit all permutations of many events on a pool of worker
+    * threads. Every worker has its own likelihood (created by the
+    * factory on the calling thread), permutation table and fit
+    * status; the detector and its transfer functions are shared.
+    * The permutation tables of all events are created first. The
+    * permutations are then split into blocks, which are distributed
+    * in event order over the workers; a worker which runs out of
+    * blocks steals from the others, so that a few expensive events
+    * do not leave the other workers idle. Permutations with an
+    * LH-invariant partner are fitted once, as in Fit(int).
+    * The fit settings are taken over from this fitter, so the
+    * results are those of Fit(int). The workers share one budget
+    * per event (see SetEventBudget()). All calls into BAT are
+    * serialised: by default, this includes the Minuit stages, and
+    * only the rest of the fit runs concurrently. With Minuit2 (see
+    * SetUseMinuit2()), the Minuit stages run concurrently as well;
+    * the simulated annealing, Markov Chain MC and integration still
+    * go through BAT, so fits which need them, like the SA fallback
+    * after a failed Minuit fit, do not gain from more threads.
+    * @param events The events to be fitted.
+    * @param results The per-event results, in the order of the events.
+    * @param factory The function creating the per-worker likelihoods.
+    * @param nthreads The number of worker threads (0: one per core).
+    * @return An error code.
+    */
+  int FitBatch(const std::vector<BatchEvent>& events, std::vector<EventResult>* results,
+               const LikelihoodFactory& factory, unsigned int nthreads = 0);
+
+  /**
+    * Fit all permutations of many events on a pool of worker
+    * threads, with clones of the likelihood of this fitter (see
+    * LikelihoodBase::Clone()).
+    * @param events The events to be fitted.
+    * @param results The per-event results, in the order of the events.
+    * @param nthreads The number of worker threads (0: one per core).
+    * @return An error code.
+    */
+  int FitBatch(const std::vector<BatchEvent>& events, std::vector<EventResult>* results,
+               unsigned int nthreads = 0);
+
+  /**
+    * Perform the fit for all permutations of the current event on a
+    * pool of worker threads. Every worker fits with its own
+    * likelihood (created by the factory on the calling thread) and
+    * a copy of the permutation table. Permutations with an
+    * LH-invariant partner are fitted once and the result is shared,
+    * as in Fit(int). The results are merged into the caches of this
+    * fitter and its likelihood and can be retrieved with
+    * LoadPermutation(); permutation 0 is loaded on return. The
+    * workers share the budget of the event (see SetEventBudget()),
+    * so the event costs no more than with Fit(int). As in
+    * FitBatch(), the calls into BAT are serialised, so the Minuit
+    * stages only run concurrently with Minuit2 (see SetUseMinuit2()).
+    * @param factory The function creating the per-worker likelihoods.
+    * @param nthreads The number of worker threads (0: one per core).
+    * @return An error code.
+    */
+  int FitParallel(const LikelihoodFactory& factory, unsigned int nthreads = 0);
+
+  /**
+    * Perform the fit for all permutations of the current event on a
+    * pool of worker threads, with clones of the likelihood of this
+    * fitter (see LikelihoodBase::Clone()).
+    * @param nthreads The number of worker threads (0: one per core).
+    * @return An error code.
+    */
+  int FitParallel(unsigned int nthreads = 0);
+
+  /**
+    * Set the permutation and restore its best-fit parameters and fit
+    * status from the caches, without fitting. The permutation must
+    * have been fitted before, e.g. by FitParallel().
+    * @param index The permutation index.
+    * @return An error code.
+    */
+  int LoadPermutation(int index);
+
+  /* @} */
 
  private:
   /**
@@ -255,6 +748,25 @@ class Fitter final {
     */
   std::unique_ptr<KLFitter::Permutations> fPermutations;
 
+  /**
+    * The range of permutations to be created.
+    */
+  long long fPermutationFirst;
+  long long fPermutationCount;
+
+  /**
+    * The cached permutation tables by their signature, and the maximum
+    * number of cached tables.
+    */
+  std::map<std::vector<long long>, std::vector<std::vector<int> > > fPermutationCache;
+  std::size_t fPermutationCacheSize;
+
+  /**
+    * The signature of the current table of permutations, kept to
+    * re-use its storage.
+    */
+  std::vector<long long> fPermutationSignature;
+
   /**
     * The TMinuit status
     */
@@ -275,6 +787,104 @@ class Fitter final {
     */
   kMinimizationMethod fMinimizationMethod;
 
+  /**
+    * The stages of the minimization and their statistics.
+    */
+  std::vector<MinimizationStage> fStages;
+  std::vector<StageStatistics> fStageStatistics;
+
+  /**
+    * The pruning mode.
+    */
+  kPruningMode fPruningMode;
+
+  /**
+    * The fraction of the sum of the event probabilities below which
+    * permutations are skipped.
+    */
+  double fPruningFraction;
+
+  /**
+    * The largest log of the event probability of the permutations of
+    * the current event fitted so far.
+    */
+  double fPruningBest;
+
+  /**
+    * The log of the sum of the event probabilities of the permutations
+    * of the current event fitted so far.
+    */
+  double fPruningLogSum;
+
+  /**
+    * Flag for starting the fits from the most similar permutation.
+    */
+  bool fWarmStart;
+
+  /**
+    * Flag for using the analytic gradient of the likelihood in Minuit.
+    */
+  bool fUseAnalyticGradient;
+
+  /**
+    * Flag for running the Minuit stages with Minuit2 instead of BAT.
+    */
+  bool fUseMinuit2;
+
+  /**
+    * The permutations of the current event which can be used as
+    * starting points, and their best-fit parameters.
+    */
+  std::vector<int> fWarmStartIndices;
+  std::vector<std::vector<double> > fWarmStartParameters;
+
+  /**
+    * The maximum number of function calls in the coarse pass of
+    * FitCoarseToFine().
+    */
+  int fCoarseMaxCalls;
+
+  /**
+    * The Minuit tolerance in the coarse pass of FitCoarseToFine().
+    */
+  double fCoarseTolerance;
+
+  /**
+    * Flag for the coarse pass of FitCoarseToFine().
+    */
+  bool fCoarseFit;
+
+  /**
+    * The wall-clock time and the number of likelihood evaluations
+    * per event, 0 for no limit.
+    */
+  double fBudgetTime;
+  long fBudgetEvaluations;
+
+  /**
+    * Flag whether the budget of the current event has started, the
+    * start time and the number of likelihood evaluations at the start.
+    */
+  bool fBudgetStarted;
+  std::chrono::steady_clock::time_point fBudgetStart;
+  long fBudgetStartEvaluations;
+
+  /**
+    * The detail level of the fit results.
+    */
+  kResultDetail fResultDetail;
+
+  /**
+    * The fit results of the permutations of the current event.
+    */
+  std::vector<FitResult> fResults;
+
+  /**
+    * The log-likelihood at the best-fit parameters of the last
+    * minimization, NaN if it has not been evaluated.
+    */
+  double fLogLikelihoodAtMode;
+
   /**
     * A vector of cached Minuit status
     */
@@ -290,6 +900,116 @@ class Fitter final {
     * @return An error code.
     */
   int ResetCache();
+
+  /**
+    * Fit a single permutation of the current event of the batch fit
+    * and fill its result.
+    * @param index The permutation index.
+    * @param result The result of the permutation.
+    * @return An error code.
+    */
+  int FitBatchPermutation(int index, FitResult* result);
+
+  /**
+    * Set the permutation and initialize the likelihood for it. This
+    * is the common part of Fit(int) and LoadPermutation().
+    * @param index The permutation index.
+    * @return An error code.
+    */
+  int SetUpPermutation(int index);
+
+  /**
+    * Minimize the likelihood for the current permutation with the
+    * chosen method and set the fit status. This is the common part of
+    * Fit(int) and the refinement in FitCoarseToFine(); the results are
+    * not cached.
+    * @param start The starting point of the minimization.
+    */
+  void Minimize(const std::vector<double>& start);
+
+  /**
+    * Fill the result of the current permutation from the best-fit
+    * parameters and the fit status.
+    * @param index The permutation index.
+    */
+  void FillResult(int index);
+
+  /**
+    * Check whether the current permutation can be skipped, see
+    * SetPruning().
+    * @return True if the permutation cannot contribute.
+    */
+  bool PrunePermutation();
+
+  /**
+    * Add the event probability of the fitted permutation to the
+    * running best and sum used for the pruning.
+    */
+  void UpdatePruning();
+
+  /**
+    * Reset the running best and sum used for the pruning, e.g. for a
+    * new event.
+    */
+  void ResetPruning();
+
+  /**
+    * Return the starting point for the fit of a permutation, see
+    * SetWarmStart().
+    * @param index The permutation index.
+    * @return The starting point.
+    */
+  std::vector<double> WarmStartParameters(int index);
+
+  /**
+    * Add the result of the fitted permutation to the starting points
+    * for the warm start.
+    * @param index The permutation index.
+    */
+  void UpdateWarmStart(int index);
+
+  /**
+    * Clear the starting points for the warm start, e.g. for a new
+    * event.
+    */
+  void ResetWarmStart();
+
+  /**
+    * Return the fraction of the budget of the current event used so
+    * far, see SetEventBudget(). The first call for an event starts
+    * the budget.
+    * @return The used fraction, 0 without a budget.
+    */
+  double BudgetUsed();
+
+  /**
+    * Reset the budget, e.g. for a new event.
+    */
+  void ResetBudget() { fBudgetStarted = false; }
+
+  /**
+    * Check whether a stage of the minimization is triggered.
+    * @param stage The stage.
+    * @param status The status of the last Minuit stage.
+    * @return True if the stage is to be run.
+    */
+  static bool StageTriggered(const MinimizationStage& stage, int status);
+
+  /**
+    * Add the stage statistics of a worker to the statistics of this
+    * fitter.
+    * @param worker The worker.
+    */
+  void AddStageStatistics(const KLFitter::Fitter& worker);
+
+  /**
+    * Create a worker fitter for the parallel fits. The worker shares
+    * the detector and takes over the minimization settings of this
+    * fitter.
+    * @param likelihood The likelihood of the worker.
+    * @return The worker.
+    */
+  std::unique_ptr<KLFitter::Fitter> CreateWorker(KLFitter::LikelihoodBase * likelihood);
 };
 }  // namespace KLFitter
 
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2009--2018, the KLFitter developer team
+ *
+ * This file is part of KLFitter.
+ *
+ * KLFitter is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * KLFitter is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with KLFitter. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLFITTER_FOURVECTOR_H_
+#define KLFITTER_FOURVECTOR_H_
+
+#include <cmath>
+
+// ---------------------------------------------------------
+
+/**
+ * \namespace KLFitter
+ * \brief The KLFitter namespace
+ */
+namespace KLFitter {
+/**
+  * \class KLFitter::FourVector
+  * \brief A plain four-vector for the internal calculations.
+  *
+  * This class is a trivially copyable replacement of TLorentzVector
+  * for the evaluation of the likelihoods: it has no virtual functions
+  * and all functions are inline. The calculations follow
+  * TLorentzVector, so that the results are identical. Four-vectors of
+  * the API, e.g. of KLFitter::Particles, are converted with From() and
+  * To().
+  */
+class FourVector final {
+ public:
+  /** \name Constructors and destructors */
+  /* @{ */
+
+  /**
+    * The default constructor, a null vector.
+    */
+  constexpr FourVector() : fPx(0.), fPy(0.), fPz(0.), fE(0.) { }
+
+  /**
+    * The constructor from the components.
+    * @param px The x component of the momentum.
+    * @param py The y component of the momentum.
+    * @param pz The z component of the momentum.
+    * @param e The energy.
+    */
+  constexpr FourVector(double px, double py, double pz, double e) : fPx(px), fPy(py), fPz(pz), fE(e) { }
+
+  /**
+    * Convert another four-vector, e.g. a TLorentzVector.
+    * @param v The four-vector.
+    * @return The four-vector.
+    */
+  template <typename LorentzVector>
+  static FourVector From(const LorentzVector& v) { return FourVector(v.Px(), v.Py(), v.Pz(), v.E()); }
+
+  /* @} */
+  /** \name Member functions (Get)  */
+  /* @{ */
+
+  constexpr double Px() const { return fPx; }
+  constexpr double Py() const { return fPy; }
+  constexpr double Pz() const { return fPz; }
+  constexpr double E() const { return fE; }
+
+  /**
+    * Return the squared magnitude of the momentum.
+    */
+  constexpr double P2() const { return fPx * fPx + fPy * fPy + fPz * fPz; }
+
+  /**
+    * Return the magnitude of the momentum.
+    */
+  double P() const { return std::sqrt(P2()); }
+
+  /**
+    * Return the transverse momentum.
+    */
+  double Pt() const { return std::sqrt(fPx * fPx + fPy * fPy); }
+
+  /**
+    * Return the squared invariant mass.
+    */
+  constexpr double M2() const { return fE * fE - P2(); }
+
+  /**
+    * Return the invariant mass, negative for space-like vectors.
+    */
+  double M() const { return M2() < 0. ? -std::sqrt(-M2()) : std::sqrt(M2()); }
+
+  /**
+    * Return the pseudorapidity.
+    */
+  double Eta() const {
+    const double p = P();
+    const double costheta = p == 0. ? 1. : fPz / p;
+    if (costheta * costheta < 1.)
+      return -0.5 * std::log((1. - costheta) / (1. + costheta));
+    if (fPz == 0.)
+      return 0.;
+    return fPz > 0. ? 10e10 : -10e10;
+  }
+
+  /**
+    * Return the azimuthal angle.
+    */
+  double Phi() const { return (fPx == 0. && fPy == 0.) ? 0. : std::atan2(fPy, fPx); }
+
+  /**
+    * Return the angle between the momenta of two four-vectors.
+    * @param other The other four-vector.
+    * @return The angle.
+    */
+  double Angle(const FourVector& other) const {
+    const double ptot2 = P2() * other.P2();
+    if (ptot2 <= 0.)
+      return 0.;
+    double arg = (fPx * other.fPx + fPy * other.fPy + fPz * other.fPz) / std::sqrt(ptot2);
+    if (arg > 1.) arg = 1.;
+    if (arg < -1.) arg = -1.;
+    return std::acos(arg);
+  }
+
+  /**
+    * Convert to another four-vector type, e.g. TLorentzVector.
+    * @return The four-vector.
+    */
+  template <typename LorentzVector>
+  LorentzVector To() const { return LorentzVector(fPx, fPy, fPz, fE); }
+
+  /* @} */
+  /** \name Member functions (Set)  */
+  /* @{ */
+
+  void SetPxPyPzE(double px, double py, double pz, double e) { fPx = px; fPy = py; fPz = pz; fE = e; }
+
+  void SetPtEtaPhiE(double pt, double eta, double phi, double e) {
+    pt = std::fabs(pt);
+    SetPxPyPzE(pt * std::cos(phi), pt * std::sin(phi), pt * std::sinh(eta), e);
+  }
+
+  /* @} */
+  /** \name Member functions (misc)  */
+  /* @{ */
+
+  /**
+    * Apply a Lorentz boost.
+    * @param bx The x component of the boost vector.
+    * @param by The y component of the boost vector.
+    * @param bz The z component of the boost vector.
+    */
+  void Boost(double bx, double by, double bz) {
+    const double b2 = bx * bx + by * by + bz * bz;
+    const double gamma = 1. / std::sqrt(1. - b2);
+    const double bp = bx * fPx + by * fPy + bz * fPz;
+    const double gamma2 = b2 > 0. ? (gamma - 1.) / b2 : 0.;
+    SetPxPyPzE(fPx + gamma2 * bp * bx + gamma * bx * fE,
+               fPy + gamma2 * bp * by + gamma * by * fE,
+               fPz + gamma2 * bp * bz + gamma * bz * fE,
+               gamma * (fE + bp));
+  }
+
+  /**
+    * Boost into the rest frame of another four-vector.
+    * @param frame The four-vector of the rest frame.
+    */
+  void BoostToRestFrame(const FourVector& frame) { Boost(-(frame.fPx / frame.fE), -(frame.fPy / frame.fE), -(frame.fPz / frame.fE)); }
+
+  constexpr FourVector operator+(const FourVector& o) const { return FourVector(fPx + o.fPx, fPy + o.fPy, fPz + o.fPz, fE + o.fE); }
+  constexpr FourVector operator-(const FourVector& o) const { return FourVector(fPx - o.fPx, fPy - o.fPy, fPz - o.fPz, fE - o.fE); }
+  constexpr FourVector operator-() const { return FourVector(-fPx, -fPy, -fPz, -fE); }
+  constexpr FourVector operator*(double a) const { return FourVector(a * fPx, a * fPy, a * fPz, a * fE); }
+  friend constexpr FourVector operator*(double a, const FourVector& v) { return v * a; }
+
+  /**
+    * The Minkowski product, in the order of TLorentzVector.
+    */
+  constexpr double operator*(const FourVector& o) const { return fE * o.fE - fPz * o.fPz - fPy * o.fPy - fPx * o.fPx; }
+
+  FourVector& operator+=(const FourVector& o) { fPx += o.fPx; fPy += o.fPy; fPz += o.fPz; fE += o.fE; return *this; }
+
+  /* @} */
+
+ private:
+  /**
+    * The momentum components and the energy.
+    */
+  double fPx;
+  double fPy;
+  double fPz;
+  double fE;
+};
+}  // namespace KLFitter
+
+#endif  // KLFITTER_FOURVECTOR_H_
@@ -21,6 +21,9 @@
 #define KLFITTER_LIKELIHOODBASE_H_
 
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "BAT/BCLog.h"
@@ -73,6 +76,20 @@ class LikelihoodBase : public BCModel {
     */
   virtual ~LikelihoodBase();
 
+  /**
+    * Create a copy of the likelihood with the same configuration
+    * (parameters and their ranges, physics constants, b-tagging
+    * method, flags and the likelihood-specific settings). Read-only
+    * pieces like the detector and its transfer functions or the
+    * UDSep histograms are shared with the original, the event data
+    * and fit results are not copied. The clone has to be attached
+    * to a fitter before it can be used. This is the cheap way to
+    * set up one likelihood per thread.
+    * @return The copy, or an empty pointer if the likelihood does
+    * not support cloning.
+    */
+  virtual std::unique_ptr<KLFitter::LikelihoodBase> Clone() const;
+
   /* @} */
   /** \name Member functions (Get)  */
   /* @{ */
@@ -116,6 +133,19 @@ class LikelihoodBase : public BCModel {
     */
   int NParameters() { return this -> GetNParameters(); }
 
+  /**
+    * Return the number of evaluations of the posterior (see LogEval())
+    * since the construction of the likelihood.
+    * @return The number of evaluations.
+    */
+  long NEvaluations() const { return fNEvaluations; }
+
+  /**
+    * Return the MINUIT arguments set with SetMinuitArlist().
+    * @return The maximum number of calls and the tolerance.
+    */
+  const double* GetMinuitArglist() const { return fMinuitArglist; }
+
   /**
     * Return the lower boundary of a parameter
     * @param index The index of the parameter.
@@ -296,6 +326,14 @@ class LikelihoodBase : public BCModel {
     */
   virtual double LogAPrioriProbability(const std::vector <double> & parameters) { return 0; }
 
+  /**
+    * The logarithm of the posterior probability as seen by the
+    * minimization, overloaded from BCModel to count the evaluations.
+    * @param parameters A vector of parameters (double values).
+    * @return The logarithm of the posterior probability.
+    */
+  double LogEval(const std::vector <double> & parameters) override;
+
   /**
     * The posterior probability definition, overloaded from BCModel.
     * @param parameters A vector of parameters (double values).
@@ -310,6 +348,41 @@ class LikelihoodBase : public BCModel {
     */
   virtual std::vector<double> LogLikelihoodComponents(std::vector <double> parameters) = 0;
 
+  /**
+    * Return true if LogLikelihoodGradient() is implemented in closed
+    * form. Only then FindModeMinuit2() with the gradient is faster
+    * than the minimization with numerical derivatives by Minuit.
+    * @return True if the likelihood provides an analytic gradient.
+    */
+  virtual bool HasAnalyticGradient() const { return false; }
+
+  /**
+    * Calculate the logarithm of the likelihood and its gradient with
+    * respect to the parameters. The default implementation uses
+    * central finite differences of LogLikelihood().
+    * @param parameters A vector of parameters (double values).
+    * @param gradient The gradient, resized to the number of parameters.
+    * @return The logarithm of the likelihood at the parameters.
+    */
+  virtual double LogLikelihoodGradient(const std::vector<double>& parameters, std::vector<double>* gradient);
+
+  /**
+    * Find the mode with MIGRAD of Minuit2, which calls LogLikelihood()
+    * and LogAPrioriProbability() directly instead of going through
+    * the process-wide Minuit FCN of BAT. Different likelihoods can
+    * therefore be minimized concurrently, unlike with FindMode().
+    * The maximum number of calls and the tolerance are taken from
+    * SetMinuitArlist(), and the results are available as for
+    * FindMode(): GetBestFitParameters(), GetBestFitParameterErrors()
+    * and GetMinuitErrorFlag() (0 if MIGRAD converged, 4 otherwise).
+    * @param start The starting point, the initial parameters if empty.
+    * @param gradient If true, the gradient is taken from
+    * LogLikelihoodGradient() and the prior is assumed to be constant;
+    * otherwise Minuit2 uses numerical derivatives.
+    * @return An error code.
+    */
+  int FindModeMinuit2(std::vector<double> start = std::vector<double>(), bool gradient = false);
+
   /**
     * Return the log of the event probability fof the current
     * combination
@@ -317,6 +390,15 @@ class LikelihoodBase : public BCModel {
     */
   virtual double LogEventProbability();
 
+  /**
+    * Return the log of the event probability of the current
+    * combination for a given log-likelihood at the mode, without
+    * evaluating the likelihood again.
+    * @param loglikelihood The log-likelihood at the best-fit parameters.
+    * @return The event probability
+    */
+  virtual double LogEventProbability(double loglikelihood);
+
   /**
     * Return the contribution from b tagging to the log of the
     * event probability for the current combination
@@ -324,6 +406,25 @@ class LikelihoodBase : public BCModel {
     */
   virtual double LogEventProbabilityBTag();
 
+  /**
+    * Return an upper bound of the log-likelihood of the current
+    * permutation over the allowed parameter ranges, computed without
+    * a fit (e.g. from the peak values of the transfer functions and
+    * Breit-Wigner distributions). Must be called after Initialize().
+    * The default implementation returns infinity, i.e. no bound.
+    * @return The upper bound of the log-likelihood.
+    */
+  virtual double LogLikelihoodUpperBound() { return std::numeric_limits<double>::infinity(); }
+
+  /**
+    * Return an upper bound of the log of the event probability of
+    * the current permutation, i.e. LogLikelihoodUpperBound() plus
+    * the parameter-independent terms of LogEventProbability(). The
+    * bound is infinite if the likelihood is integrated.
+    * @return The upper bound of the log of the event probability.
+    */
+  virtual double LogEventProbabilityUpperBound();
+
   /**
     * Remove invariant particle permutations.
     * @return An error code.
@@ -331,11 +432,20 @@ class LikelihoodBase : public BCModel {
   virtual int RemoveInvariantParticlePermutations() = 0;
 
   /**
-    * Remove forbidden particle permutations.
+    * Remove forbidden particle permutations. The veto b-tagging
+    * methods are available for up to 64 model partons.
     * @return An error code.
     */
   virtual int RemoveForbiddenParticlePermutations();
 
+  /**
+    * Return whether RemoveForbiddenParticlePermutations() depends on
+    * the b-tagging of the partons, i.e. whether a veto b-tagging
+    * method is used.
+    * @return The flag.
+    */
+  virtual bool BTaggingVetoesPermutations();
+
   /**
    * Build the model particles from the best fit parameters.
    * @return An error code.
@@ -348,12 +458,32 @@ class LikelihoodBase : public BCModel {
     */
   virtual std::vector<double> GetInitialParameters() = 0;
 
+  /**
+    * Return the indices of the parameters which describe the energies
+    * of the partons of the permutation, in the order of the partons,
+    * with -1 for partons without an energy parameter. The fitter uses
+    * this to start a fit from the result of a similar permutation,
+    * see Fitter::SetWarmStart(). An empty vector (default) means
+    * that the likelihood does not support this.
+    * @return The parameter indices.
+    */
+  virtual std::vector<int> PartonEnergyParameters() const { return std::vector<int>(); }
+
   /**
     * Check if there are TF problems.
     * @return Return false if TF problem.
     */
   virtual bool NoTFProblem(std::vector<double> parameters);
 
+  /**
+    * Check if there are TF problems and return the log-likelihood,
+    * which is evaluated for the check.
+    * @param parameters The parameters.
+    * @param loglikelihood The log-likelihood at the parameters.
+    * @return Return false if TF problem.
+    */
+  bool NoTFProblem(const std::vector<double>& parameters, double * loglikelihood);
+
   /**
     * Returns the best fit parameters, overloaded from BCModel
     * @return The best fit parameters */
@@ -395,14 +525,25 @@ class LikelihoodBase : public BCModel {
   using BCModel::GetBestFitParameterError;
   //
   /**
-    * Check if the permutation is LH invariant.
+    * Check if the permutation is LH invariant. By default, the partner
+    * is the permutation with the particles in the positions of one of
+    * the declared LH invariances exchanged (see AddLHInvariance() and
+    * UpdateLHInvariantPermutationPartners()).
     * @param iperm Current permutation
     * @param nperms Total number of permutations
-    * @param switchpar1 ???
-    * @param switchpar2 ???
+    * @param switchpar1 The first parameter exchanged with the partner.
+    * @param switchpar2 The second parameter exchanged with the partner.
     * @return Permutation of the invariant partner, -1 if there is no one.
     */
-  virtual int LHInvariantPermutationPartner(int iperm, int nperms, int *switchpar1, int *switchpar2) { return -1; }
+  virtual int LHInvariantPermutationPartner(int iperm, int nperms, int *switchpar1, int *switchpar2);
+
+  /**
+    * Find the LH-invariant partners of all permutations in the
+    * current permutation table. Has to be called whenever the table
+    * changes; this is done by the fitter.
+    * @return An error code.
+    */
+  int UpdateLHInvariantPermutationPartners();
 
   /**
     * Write parameters from fCachedParametersVector.at(iperm) to fCachedParameters
@@ -419,6 +560,37 @@ class LikelihoodBase : public BCModel {
     */
   int SetParametersToCache(int iperm, int nperms);
 
+  /**
+    * Write the given parameters to fCachedParametersVector.at(iperm)
+    * instead of the result of BAT, e.g. for permutations which were
+    * not fitted.
+    * @param iperm Current permutation
+    * @param nperms Number of permutations
+    * @param parameters The parameters.
+    * @param errors The parameter errors.
+    * @param normalization The normalization.
+    * @return An error code.
+    */
+  int SetParametersToCache(int iperm, int nperms, const std::vector<double>& parameters,
+                           const std::vector<double>& errors, double normalization);
+
+  /**
+    * Set the size of the per-permutation cache vectors and clear
+    * their contents.
+    * @param nperms Number of permutations
+    * @return An error code.
+    */
+  int InitCache(int nperms);
+
+  /**
+    * Copy the cached parameters, errors and normalization of one
+    * permutation from another likelihood of the same type.
+    * @param other The likelihood to copy from.
+    * @param iperm The permutation.
+    * @return An error code.
+    */
+  int CopyCacheEntry(const KLFitter::LikelihoodBase& other, int iperm);
+
   /**
     * @return The normalization factor of the probability, overloaded from BCModel */
   double GetIntegral();
@@ -436,6 +608,45 @@ class LikelihoodBase : public BCModel {
   /* @} */
 
  protected:
+  /**
+    * The copy constructor used by Clone(). The BAT parameters are
+    * rebuilt with the names and ranges of the original, as BAT does
+    * not support copying models.
+    * @param other The likelihood to copy the configuration from.
+    */
+  LikelihoodBase(const LikelihoodBase& other);
+
+  /**
+    * Likelihoods cannot be assigned, use Clone() instead.
+    */
+  LikelihoodBase& operator=(const LikelihoodBase& other) = delete;
+
+  /**
+    * Copy the configuration which is not part of the BAT model from
+    * another likelihood: physics constants, detector, b-tagging
+    * method, flags and the parameter ranges.
+    * @param other The likelihood to copy the configuration from.
+    * @return An error code.
+    */
+  int CopyConfiguration(const LikelihoodBase& other);
+
+  /**
+    * Declare that the likelihood is invariant under the exchange of
+    * the particles in two positions of the model, if the given pairs
+    * of parameters are exchanged as well. Permutations which only
+    * differ by this exchange share their fit (see
+    * LHInvariantPermutationPartner()). This is meant for exchanges
+    * which change the event probability, e.g. by the b-tagging;
+    * otherwise the permutations should not be created at all (see
+    * RemoveInvariantParticlePermutations()).
+    * @param ptype The type of the particles.
+    * @param position1 The first position.
+    * @param position2 The second position.
+    * @param parameters The pairs of exchanged parameters.
+    */
+  void AddLHInvariance(KLFitter::Particles::ParticleType ptype, int position1, int position2,
+                       const std::vector<std::pair<int, int> >& parameters);
+
   /**
    * Save permuted particles.
    */
@@ -509,6 +720,11 @@ class LikelihoodBase : public BCModel {
    */
   bool fTFgood;
 
+  /**
+    * The number of evaluations of the posterior.
+    */
+  long fNEvaluations;
+
   /**
     * Name of btagging enum
     */
@@ -545,6 +761,40 @@ class LikelihoodBase : public BCModel {
   std::vector<double>  fCachedNormalizationVector;
 
  private:
+  /**
+    * An exchange of two positions of the model under which the
+    * likelihood is invariant (see AddLHInvariance()).
+    */
+  struct LHInvariance {
+    KLFitter::Particles::ParticleType ptype;
+    int position1;
+    int position2;
+    std::vector<std::pair<int, int> > parameters;
+  };
+
+  /**
+    * The declared LH invariances.
+    */
+  std::vector<LHInvariance> fLHInvariances;
+
+  /**
+    * The LH-invariant partner of each permutation and the index of
+    * the invariance relating them (-1 if there is no partner).
+    */
+  std::vector<int> fLHInvariantPartners;
+  std::vector<int> fLHInvariantExchanges;
+
+  /**
+    * The negative logarithm of the posterior, minimized by
+    * FindModeMinuit2() with numerical derivatives.
+    */
+  class NegativeLogPosterior;
+
+  /**
+    * The negative logarithm of the posterior with the gradient from
+    * LogLikelihoodGradient(), minimized by FindModeMinuit2().
+    */
+  class NegativeLogPosteriorGradient;
 };
 }  // namespace KLFitter
 
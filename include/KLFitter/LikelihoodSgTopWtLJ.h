@@ -140,6 +140,23 @@ class LikelihoodSgTopWtLJ : public KLFitter::LikelihoodBase {
     */
   double LogLikelihood(const std::vector<double> & parameters) override;
 
+  /**
+    * The likelihood is templated on the scalar type, so that its
+    * gradient is exact by automatic differentiation.
+    * @return True if the dual numbers have a component for every
+    * parameter.
+    */
+  bool HasAnalyticGradient() const override { return GetNParameters() <= parNuPz + 1; }
+
+  /**
+    * Calculate the logarithm of the likelihood and its gradient with
+    * dual numbers, see LikelihoodBase::LogLikelihoodGradient().
+    * @param parameters A vector of parameters (double values).
+    * @param gradient The gradient, resized to the number of parameters.
+    * @return The logarithm of the likelihood at the parameters.
+    */
+  double LogLikelihoodGradient(const std::vector<double>& parameters, std::vector<double>* gradient) override;
+
   /**
     * Get initial values for the parameters.
     * @return vector of initial values.
@@ -158,6 +175,28 @@ class LikelihoodSgTopWtLJ : public KLFitter::LikelihoodBase {
     */
   int CalculateLorentzVectors(const std::vector <double>& parameters) override;
 
+  /**
+    * The fitted 4-vectors and invariant masses, for any scalar type:
+    * double for the likelihood and KLFitter::Dual for its gradient.
+    */
+  template <typename T> struct Kinematics;
+
+  /**
+    * Calculate the kinematics from the parameters, see
+    * CalculateLorentzVectors().
+    * @param parameters A vector of parameters.
+    * @param fit The kinematics.
+    */
+  template <typename T> void CalculateKinematics(const std::vector<T>& parameters, Kinematics<T>* fit) const;
+
+  /**
+    * The logarithm of the likelihood for any scalar type, see
+    * LogLikelihood() and LogLikelihoodGradient().
+    * @param parameters A vector of parameters.
+    * @return The logarithm of the likelihood.
+    */
+  template <typename T> T LogLikelihoodTemplate(const std::vector<T>& parameters);
+
   /**
     * Initialize the likelihood for the event
     */
@@ -60,6 +60,12 @@ class LikelihoodTTHLeptonJets : public KLFitter::LikelihoodBase {
     */
   ~LikelihoodTTHLeptonJets();
 
+  /**
+    * Create a copy of the likelihood, see LikelihoodBase::Clone().
+    * @return The copy.
+    */
+  std::unique_ptr<KLFitter::LikelihoodBase> Clone() const override;
+
   /* @} */
   /** \name Member functions (Get)  */
   /* @{ */
@@ -153,12 +159,36 @@ class LikelihoodTTHLeptonJets : public KLFitter::LikelihoodBase {
     */
   std::vector<double> LogLikelihoodComponents(std::vector <double> parameters) override;
 
+  /**
+    * The likelihood is templated on the scalar type, so that its
+    * gradient is exact by automatic differentiation.
+    * @return True if the dual numbers have a component for every
+    * parameter.
+    */
+  bool HasAnalyticGradient() const override { return GetNParameters() <= parHiggsM + 1; }
+
+  /**
+    * Calculate the logarithm of the likelihood and its gradient with
+    * dual numbers, see LikelihoodBase::LogLikelihoodGradient().
+    * @param parameters A vector of parameters (double values).
+    * @param gradient The gradient, resized to the number of parameters.
+    * @return The logarithm of the likelihood at the parameters.
+    */
+  double LogLikelihoodGradient(const std::vector<double>& parameters, std::vector<double>* gradient) override;
+
   /**
     * Get initial values for the parameters.
     * @return vector of initial values.
     */
   std::vector<double> GetInitialParameters() override;
 
+  /**
+    * Return the indices of the parton energy parameters, see
+    * LikelihoodBase::PartonEnergyParameters().
+    * @return The parameter indices.
+    */
+  std::vector<int> PartonEnergyParameters() const override { return {parBhadE, parBlepE, parLQ1E, parLQ2E, parBHiggs1E, parBHiggs2E}; }
+
   /**
     * Get initial values for the parameters with a dummy of "0.0" for the neutrino pz.
     * The decision on the initial value for the neutrino pz then needs to be done in
@@ -179,6 +209,28 @@ class LikelihoodTTHLeptonJets : public KLFitter::LikelihoodBase {
     */
   int CalculateLorentzVectors(std::vector <double> const& parameters) override;
 
+  /**
+    * The fitted 4-vectors and invariant masses, for any scalar type:
+    * double for the likelihood and KLFitter::Dual for its gradient.
+    */
+  template <typename T> struct Kinematics;
+
+  /**
+    * Calculate the kinematics from the parameters, see
+    * CalculateLorentzVectors().
+    * @param parameters A vector of parameters.
+    * @param fit The kinematics.
+    */
+  template <typename T> void CalculateKinematics(const std::vector<T>& parameters, Kinematics<T>* fit) const;
+
+  /**
+    * The logarithm of the likelihood for any scalar type, see
+    * LogLikelihood() and LogLikelihoodGradient().
+    * @param parameters A vector of parameters.
+    * @return The logarithm of the likelihood.
+    */
+  template <typename T> T LogLikelihoodTemplate(const std::vector<T>& parameters);
+
   /**
     * Adjust parameter ranges
     */
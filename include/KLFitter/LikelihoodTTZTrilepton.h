@@ -58,6 +58,12 @@ class LikelihoodTTZTrilepton : public KLFitter::LikelihoodBase {
     */
   ~LikelihoodTTZTrilepton();
 
+  /**
+    * Create a copy of the likelihood, see LikelihoodBase::Clone().
+    * @return The copy.
+    */
+  std::unique_ptr<KLFitter::LikelihoodBase> Clone() const override;
+
   /* @} */
   /** \name Member functions (Get)  */
   /* @{ */
@@ -167,12 +173,36 @@ class LikelihoodTTZTrilepton : public KLFitter::LikelihoodBase {
     */
   std::vector<double> LogLikelihoodComponents(std::vector <double> parameters) override;
 
+  /**
+    * The likelihood is templated on the scalar type, so that its
+    * gradient is exact by automatic differentiation.
+    * @return True if the dual numbers have a component for every
+    * parameter.
+    */
+  bool HasAnalyticGradient() const override { return GetNParameters() <= parZM + 1; }
+
+  /**
+    * Calculate the logarithm of the likelihood and its gradient with
+    * dual numbers, see LikelihoodBase::LogLikelihoodGradient().
+    * @param parameters A vector of parameters (double values).
+    * @param gradient The gradient, resized to the number of parameters.
+    * @return The logarithm of the likelihood at the parameters.
+    */
+  double LogLikelihoodGradient(const std::vector<double>& parameters, std::vector<double>* gradient) override;
+
   /**
     * Get initial values for the parameters.
     * @return vector of initial values.
     */
   std::vector<double> GetInitialParameters() override;
 
+  /**
+    * Return the indices of the parton energy parameters, see
+    * LikelihoodBase::PartonEnergyParameters().
+    * @return The parameter indices.
+    */
+  std::vector<int> PartonEnergyParameters() const override { return {parBhadE, parBlepE, parLQ1E, parLQ2E}; }
+
   /**
     * Get initial values for the parameters with a dummy of "0.0" for the neutrino pz.
     * The decision on the initial value for the neutrino pz then needs to be done in
@@ -191,13 +221,14 @@ class LikelihoodTTZTrilepton : public KLFitter::LikelihoodBase {
     * Provide a local modification of BCMath::LogBreitWignerRel such
     * that the relativistic Breit-Wigner distribution is normalised
     * to 1. The function then returns the log of this distribution.
+    * The scalar type is double or KLFitter::Dual.
     *
     * @param x Value to be evaluated.
     * @param mean The mean of the distribution, i.e. Z pole mass.
     * @param gamma The FWHM of the distribution, i.e. the Z decay width.
     * @return Log of the relativistic B-W.
     */
-  double LogBreitWignerRelNorm(const double& x, const double& mean, const double& gamma);
+  template <typename T> T LogBreitWignerRelNorm(const T& x, const T& mean, double gamma);
 
   /**
     * Evaluate a combined Z/y invariant mass distribution. The B-W
@@ -209,7 +240,7 @@ class LikelihoodTTZTrilepton : public KLFitter::LikelihoodBase {
     * @param gamma The FWHM of the distribution, i.e. the Z decay width.
     * @return Log of combined mass distribution.
     */
-  double LogZCombinedDistribution(const double& x, const double& mean, const double& gamma);
+  template <typename T> T LogZCombinedDistribution(const T& x, const T& mean, double gamma);
 
   /**
     * Update 4-vectors of model particles.
@@ -217,6 +248,28 @@ class LikelihoodTTZTrilepton : public KLFitter::LikelihoodBase {
     */
   int CalculateLorentzVectors(std::vector <double> const& parameters) override;
 
+  /**
+    * The fitted 4-vectors and invariant masses, for any scalar type:
+    * double for the likelihood and KLFitter::Dual for its gradient.
+    */
+  template <typename T> struct Kinematics;
+
+  /**
+    * Calculate the kinematics from the parameters, see
+    * CalculateLorentzVectors().
+    * @param parameters A vector of parameters.
+    * @param fit The kinematics.
+    */
+  template <typename T> void CalculateKinematics(const std::vector<T>& parameters, Kinematics<T>* fit) const;
+
+  /**
+    * The logarithm of the likelihood for any scalar type, see
+    * LogLikelihood() and LogLikelihoodGradient().
+    * @param parameters A vector of parameters.
+    * @return The logarithm of the likelihood.
+    */
+  template <typename T> T LogLikelihoodTemplate(const std::vector<T>& parameters);
+
   /**
     * Adjust parameter ranges
     */
@@ -57,6 +57,12 @@ class LikelihoodTopAllHadronic : public KLFitter::LikelihoodBase {
     */
   ~LikelihoodTopAllHadronic();
 
+  /**
+    * Create a copy of the likelihood, see LikelihoodBase::Clone().
+    * @return The copy.
+    */
+  std::unique_ptr<KLFitter::LikelihoodBase> Clone() const override;
+
   /* @} */
   /** \name Member functions (Get)  */
   /* @{ */
@@ -127,12 +133,36 @@ class LikelihoodTopAllHadronic : public KLFitter::LikelihoodBase {
     */
   std::vector<double> LogLikelihoodComponents(std::vector <double> parameters) override;
 
+  /**
+    * The likelihood is templated on the scalar type, so that its
+    * gradient is exact by automatic differentiation.
+    * @return True if the dual numbers have a component for every
+    * parameter.
+    */
+  bool HasAnalyticGradient() const override { return GetNParameters() <= parTopM + 1; }
+
+  /**
+    * Calculate the logarithm of the likelihood and its gradient with
+    * dual numbers, see LikelihoodBase::LogLikelihoodGradient().
+    * @param parameters A vector of parameters (double values).
+    * @param gradient The gradient, resized to the number of parameters.
+    * @return The logarithm of the likelihood at the parameters.
+    */
+  double LogLikelihoodGradient(const std::vector<double>& parameters, std::vector<double>* gradient) override;
+
   /**
     * Get initial values for the parameters.
     * @return vector of initial values.
     */
   std::vector<double> GetInitialParameters() override;
 
+  /**
+    * Return the indices of the parton energy parameters, see
+    * LikelihoodBase::PartonEnergyParameters().
+    * @return The parameter indices.
+    */
+  std::vector<int> PartonEnergyParameters() const override { return {parBhad1E, parBhad2E, parLQ1E, parLQ2E, parLQ3E, parLQ4E}; }
+
   /* @} */
 
  protected:
@@ -145,6 +175,28 @@ class LikelihoodTopAllHadronic : public KLFitter::LikelihoodBase {
     */
   int CalculateLorentzVectors(std::vector <double> const& parameters) override;
 
+  /**
+    * The fitted 4-vectors and invariant masses, for any scalar type:
+    * double for the likelihood and KLFitter::Dual for its gradient.
+    */
+  template <typename T> struct Kinematics;
+
+  /**
+    * Calculate the kinematics from the parameters, see
+    * CalculateLorentzVectors().
+    * @param parameters A vector of parameters.
+    * @param fit The kinematics.
+    */
+  template <typename T> void CalculateKinematics(const std::vector<T>& parameters, Kinematics<T>* fit) const;
+
+  /**
+    * The logarithm of the likelihood for any scalar type, see
+    * LogLikelihood() and LogLikelihoodGradient().
+    * @param parameters A vector of parameters.
+    * @return The logarithm of the likelihood.
+    */
+  template <typename T> T LogLikelihoodTemplate(const std::vector<T>& parameters);
+
   /**
     * Adjust parameter ranges
     */
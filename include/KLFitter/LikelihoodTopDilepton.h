@@ -30,6 +30,7 @@
 class TLorentzVector;
 
 namespace KLFitter {
+  class FourVector;
   class NuSolutions;  // defined in implementation file
   class ResolutionBase;
 }
@@ -66,6 +67,12 @@ class LikelihoodTopDilepton : public KLFitter::LikelihoodBase {
     */
   ~LikelihoodTopDilepton();
 
+  /**
+    * Create a copy of the likelihood, see LikelihoodBase::Clone().
+    * @return The copy.
+    */
+  std::unique_ptr<KLFitter::LikelihoodBase> Clone() const override;
+
   /* @} */
   /** \name Member functions (Get)  */
   /* @{ */
@@ -172,6 +179,13 @@ class LikelihoodTopDilepton : public KLFitter::LikelihoodBase {
     */
   std::vector<double> GetInitialParameters() override;
 
+  /**
+    * Return the indices of the parton energy parameters, see
+    * LikelihoodBase::PartonEnergyParameters().
+    * @return The parameter indices.
+    */
+  std::vector<int> PartonEnergyParameters() const override { return {parB1E, parB2E}; }
+
   /**
     * Return Gaussian term for neutrino
     * pseudorapidity.
@@ -193,18 +207,18 @@ class LikelihoodTopDilepton : public KLFitter::LikelihoodBase {
     * Return NuWT weight for a set of jet1, jet2, lep1, lep2
     * @return A double.
     */
-  double CalculateWeightPerm(TLorentzVector * l1, TLorentzVector * l2, TLorentzVector * j1, TLorentzVector * j2, const std::vector<double> & parameters);
+  double CalculateWeightPerm(const KLFitter::FourVector * l1, const KLFitter::FourVector * l2, const KLFitter::FourVector * j1, const KLFitter::FourVector * j2, const std::vector<double> & parameters);
   /**
     * Return set of neutrino/antineutrino kinematic solutions
     * (up to 2)
     * @return A KLFitter::NuSolutions object.
     */
-  KLFitter::NuSolutions SolveForNuMom(TLorentzVector * l, TLorentzVector * b, double mtop, double nueta);
+  KLFitter::NuSolutions SolveForNuMom(const KLFitter::FourVector * l, const KLFitter::FourVector * b, double mtop, double nueta);
   /**
     * Return neutrino weight for a given nu solution and antinu solution
     * @return A double.
     */
-  double neutrino_weight(TLorentzVector nu, TLorentzVector nubar);
+  double neutrino_weight(const KLFitter::FourVector & nu, const KLFitter::FourVector & nubar);
   /**
     * Return sum of invariant masses of each (lep,jet) pair,
     * including a tuning factor alpha.
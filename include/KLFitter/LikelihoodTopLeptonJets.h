@@ -59,6 +59,12 @@ class LikelihoodTopLeptonJets : public KLFitter::LikelihoodBase {
     */
   ~LikelihoodTopLeptonJets();
 
+  /**
+    * Create a copy of the likelihood, see LikelihoodBase::Clone().
+    * @return The copy.
+    */
+  std::unique_ptr<KLFitter::LikelihoodBase> Clone() const override;
+
   /* @} */
   /** \name Member functions (Get)  */
   /* @{ */
@@ -145,12 +151,43 @@ class LikelihoodTopLeptonJets : public KLFitter::LikelihoodBase {
     */
   std::vector<double> LogLikelihoodComponents(std::vector <double> parameters) override;
 
+  /**
+    * The likelihood provides its gradient in closed form.
+    * @return True.
+    */
+  bool HasAnalyticGradient() const override { return true; }
+
+  /**
+    * Calculate the logarithm of the likelihood and its analytic
+    * gradient with respect to the parameters, see
+    * LikelihoodBase::LogLikelihoodGradient().
+    * @param parameters A vector of parameters (double values).
+    * @param gradient The gradient, resized to the number of parameters.
+    * @return The logarithm of the likelihood at the parameters.
+    */
+  double LogLikelihoodGradient(const std::vector<double>& parameters, std::vector<double>* gradient) override;
+
+  /**
+    * Return an upper bound of the log-likelihood of the current
+    * permutation: the sum of the maxima of the transfer functions
+    * within the parameter ranges and of the Breit-Wigner peaks.
+    * @return The upper bound of the log-likelihood.
+    */
+  double LogLikelihoodUpperBound() override;
+
   /**
     * Get initial values for the parameters.
     * @return vector of initial values.
     */
   std::vector<double> GetInitialParameters() override;
 
+  /**
+    * Return the indices of the parton energy parameters, see
+    * LikelihoodBase::PartonEnergyParameters().
+    * @return The parameter indices.
+    */
+  std::vector<int> PartonEnergyParameters() const override { return {parBhadE, parBlepE, parLQ1E, parLQ2E}; }
+
   /**
     * Get initial values for the parameters with a dummy of "0.0" for the neutrino pz.
     * The decision on the initial value for the neutrino pz then needs to be done in
@@ -69,6 +69,12 @@ class LikelihoodTopLeptonJetsUDSep : public KLFitter::LikelihoodTopLeptonJets {
     */
   ~LikelihoodTopLeptonJetsUDSep();
 
+  /**
+    * Create a copy of the likelihood, see LikelihoodBase::Clone().
+    * @return The copy.
+    */
+  std::unique_ptr<KLFitter::LikelihoodBase> Clone() const override;
+
   /* @} */
 
   /**
@@ -77,11 +83,14 @@ class LikelihoodTopLeptonJetsUDSep : public KLFitter::LikelihoodTopLeptonJets {
   void DefineParameters() override;
 
   /**
-    * Return the log of the event probability fof the current
-    * combination
+    * Return the log of the event probability of the current
+    * combination for a given log-likelihood at the mode, including
+    * the light jet reweighting.
+    * @param loglikelihood The log-likelihood at the best-fit parameters.
     * @return The event probability
     */
-  double LogEventProbability() override;
+  double LogEventProbability(double loglikelihood) override;
+  using KLFitter::LikelihoodTopLeptonJets::LogEventProbability;
 
   /**
     * Return the contribution from b tagging to the log of the
@@ -90,6 +99,13 @@ class LikelihoodTopLeptonJetsUDSep : public KLFitter::LikelihoodTopLeptonJets {
     */
   double LogEventProbabilityBTag() override;
 
+  /**
+    * Return an upper bound of the log of the event probability of
+    * the current permutation, including the light jet reweighting.
+    * @return The upper bound of the log of the event probability.
+    */
+  double LogEventProbabilityUpperBound() override;
+
   /**
     * Return the contribution from pT and b tag weight probability (by LJetSeparationMethod)
     * to the log of the event probability for the current combination
@@ -200,12 +216,6 @@ class LikelihoodTopLeptonJetsUDSep : public KLFitter::LikelihoodTopLeptonJets {
     */
   void SetLJetSeparationMethod(KLFitter::LikelihoodTopLeptonJetsUDSep::LJetSeparationMethod flag) { fLJetSeparationMethod = flag; }
 
-  /**
-    * Check if the permutation is LH invariant.
-    * @return Permutation of the invariant partner, -1 if there is no one.
-    */
-  int LHInvariantPermutationPartner(int iperm, int nperms, int *switchpar1, int *switchpar2) override;
-
   /**
     * Set histogram for tag weight distribution of up type jets.
     * @param hist Pointer to histogram.
@@ -249,6 +259,12 @@ class LikelihoodTopLeptonJetsUDSep : public KLFitter::LikelihoodTopLeptonJets {
     */
   int RemoveForbiddenParticlePermutations() override { return 1; }
 
+  /**
+    * No permutations are vetoed by the b-tagging.
+    * @return The flag.
+    */
+  bool BTaggingVetoesPermutations() override { return false; }
+
   /**
     * A flag for using an additional reweighting of the permutations with the pT and tag weight probability (default: false);
     */
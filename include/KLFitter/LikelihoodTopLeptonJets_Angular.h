@@ -59,6 +59,12 @@ class LikelihoodTopLeptonJets_Angular : public KLFitter::LikelihoodBase {
     */
   ~LikelihoodTopLeptonJets_Angular();
 
+  /**
+    * Create a copy of the likelihood, see LikelihoodBase::Clone().
+    * @return The copy.
+    */
+  std::unique_ptr<KLFitter::LikelihoodBase> Clone() const override;
+
   /* @} */
   /** \name Member functions (Get)  */
   /* @{ */
@@ -149,6 +155,13 @@ class LikelihoodTopLeptonJets_Angular : public KLFitter::LikelihoodBase {
     */
   std::vector<double> GetInitialParameters() override;
 
+  /**
+    * Return the indices of the parton energy parameters, see
+    * LikelihoodBase::PartonEnergyParameters().
+    * @return The parameter indices.
+    */
+  std::vector<int> PartonEnergyParameters() const override { return {parBhadE, parBlepE, parLQ1E, parLQ2E}; }
+
   /**
     * Get initial values for the parameters with a dummy of "0.0" for the neutrino pz.
     * The decision on the initial value for the neutrino pz then needs to be done in
@@ -59,6 +59,12 @@ class LikelihoodTopLeptonJets_JetAngles : public KLFitter::LikelihoodBase {
     */
   ~LikelihoodTopLeptonJets_JetAngles();
 
+  /**
+    * Create a copy of the likelihood, see LikelihoodBase::Clone().
+    * @return The copy.
+    */
+  std::unique_ptr<KLFitter::LikelihoodBase> Clone() const override;
+
   /* @} */
   /** \name Member functions (Get)  */
   /* @{ */
@@ -22,6 +22,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 // ---------------------------------------------------------
@@ -38,7 +39,13 @@ namespace KLFitter {
   * \brief A class describing particles.
   *
   * This class contains sets of TLorentzVectors for quarks, leptons,
-  * etc.
+  * etc. The four-vectors and the other properties of each type of
+  * particles are stored in contiguous arrays, so that copying a set of
+  * particles only allocates one array per property. Pointers to the
+  * four-vectors are invalidated when particles of the same type are
+  * added or removed. The names are interned in a table that is
+  * shared between copies, e.g. the permuted sets of particles, and
+  * are looked up by hashing.
   */
 class Particles final {
  public:
@@ -74,11 +81,21 @@ class Particles final {
     */
   ~Particles();
 
+  /**
+    * The move constructor.
+    */
+  Particles(Particles&& o) noexcept;
+
   /**
    * The assignment operator.
    */
   Particles& operator=(const Particles& o);
 
+  /**
+    * The move assignment operator.
+    */
+  Particles& operator=(Particles&& o) noexcept;
+
   /* @} */
   /** \name Member functions (Get)  */
   /* @{ */
@@ -87,43 +104,43 @@ class Particles final {
     * Return the number of partons.
     * @return The number of partons.
     */
-  int NPartons() { return static_cast<int>(fPartons.size()); }
+  int NPartons() { return static_cast<int>(fNamePartons.size()); }
 
   /**
     * Return the number of electrons.
     * @return The number of electrons.
     */
-  int NElectrons() { return int (fElectrons.size()); }
+  int NElectrons() { return static_cast<int>(fNameElectrons.size()); }
 
   /**
     * Return the number of muons.
     * @return The number of muons.
     */
-  int NMuons() { return int (fMuons.size()); }
+  int NMuons() { return static_cast<int>(fNameMuons.size()); }
 
   /**
     * Return the number of taus.
     * @return The number of taus.
     */
-  int NTaus() { return int (fTaus.size()); }
+  int NTaus() { return static_cast<int>(fNameTaus.size()); }
 
   /**
     * Return the number of neutrinos.
     * @return The number of neutrinos.
     */
-  int NNeutrinos() { return int (fNeutrinos.size()); }
+  int NNeutrinos() { return static_cast<int>(fNameNeutrinos.size()); }
 
   /**
     * Return the number of bosons.
     * @return The number of bosons.
     */
-  int NBosons() { return int (fBosons.size()); }
+  int NBosons() { return static_cast<int>(fNameBosons.size()); }
 
   /**
     * Return the number of photons.
     * @return The number of photons.
     */
-  int NPhotons() { return int (fPhotons.size()); }
+  int NPhotons() { return static_cast<int>(fNamePhotons.size()); }
 
   /**
     * Return the particle with a certain name
@@ -203,7 +220,7 @@ class Particles final {
     * Return the number of particles.
     * @return The number of particles.
     */
-  int NParticles() { return static_cast<int>(fPartons.size() + fElectrons.size() + fMuons.size() + fTaus.size() + fNeutrinos.size() + fBosons.size() + fPhotons.size()); }
+  int NParticles() { return NPartons() + NElectrons() + NMuons() + NTaus() + NNeutrinos() + NBosons() + NPhotons(); }
 
   /**
     * Return the number of particles of a certain type.
@@ -456,19 +473,49 @@ class Particles final {
     */
   int RemoveParticle(std::string name);
 
+  /**
+    * Remove all particles. The allocated storage is kept, so that
+    * the set of particles can be re-used, e.g. for the next event,
+    * without allocating memory.
+    */
+  void Clear();
+
+  /**
+    * Overwrite a particle with a particle of another set of particles,
+    * keeping its place in this set. The particle is copied as by
+    * AddParticle(); the lepton charge is only copied if both sets have
+    * one.
+    * @param index The index of the particle to be overwritten.
+    * @param ptype The type of the particles.
+    * @param source The other set of particles.
+    * @param sourceindex The index of the particle in the other set.
+    * @return An error code.
+    */
+  int CopyParticle(int index, KLFitter::Particles::ParticleType ptype, KLFitter::Particles* source, int sourceindex);
+
   /**
     * Return the particle container of a type of particles
     * @param ptype The type of the particle.
     * @return The particle container.
     */
-  std::vector<std::unique_ptr<TLorentzVector> >* ParticleContainer(KLFitter::Particles::ParticleType ptype);
+  std::vector<TLorentzVector>* ParticleContainer(KLFitter::Particles::ParticleType ptype);
 
   /**
-    * Return the particle name container of a type of particles
+    * Return the container of the name handles of a type of particles.
+    * The handles index the name table of this set of particles.
     * @param ptype The type of the particle.
-    * @return The particle name container.
+    * @return The name handle container.
     */
-  std::vector <std::string> * ParticleNameContainer(KLFitter::Particles::ParticleType ptype);
+  std::vector<int> * ParticleNameContainer(KLFitter::Particles::ParticleType ptype);
+
+  /**
+    * Use the name table of another set of particles, so that adding
+    * particles with the same names does not copy the names. This is
+    * only possible for an empty set of particles.
+    * @param other The other set of particles.
+    * @return An error code.
+    */
+  int ShareNameTable(const KLFitter::Particles& other);
 
   /**
     * Checks if the index is within range.
@@ -476,80 +523,115 @@ class Particles final {
     * @param index The index of particle.
     * @return An error flag.
     */
-  int CheckIndex(std::vector<std::unique_ptr<TLorentzVector> >* container, int index);
+  int CheckIndex(std::vector<TLorentzVector>* container, int index);
 
   /* @} */
 
  private:
+  /**
+    * The table of the interned names, defined in the implementation
+    * file.
+    */
+  struct NameTable;
+
+  /**
+    * Return the handle of a name, adding it to the name table if
+    * needed. A table shared with other sets of particles is copied
+    * before it is modified.
+    * @param name The name.
+    * @return The handle.
+    */
+  int InternName(const std::string& name);
+
+  /**
+    * Rebuild the lookup of the particles by name handle.
+    */
+  void UpdateNameLocations();
+
   /**
     * A set of quarks and gluons.
     */
-  std::vector<std::unique_ptr<TLorentzVector> > fPartons;
+  std::vector<TLorentzVector> fPartons;
 
   /**
     * A set of electrons.
     */
-  std::vector<std::unique_ptr<TLorentzVector> > fElectrons;
+  std::vector<TLorentzVector> fElectrons;
 
   /**
     * A set of muons.
     */
-  std::vector<std::unique_ptr<TLorentzVector> > fMuons;
+  std::vector<TLorentzVector> fMuons;
 
   /**
     * A set of taus.
     */
-  std::vector<std::unique_ptr<TLorentzVector> > fTaus;
+  std::vector<TLorentzVector> fTaus;
 
   /**
     * A set of neutrinos.
     */
-  std::vector<std::unique_ptr<TLorentzVector> > fNeutrinos;
+  std::vector<TLorentzVector> fNeutrinos;
 
   /**
     * A set of bosons.
     */
-  std::vector<std::unique_ptr<TLorentzVector> > fBosons;
+  std::vector<TLorentzVector> fBosons;
 
   /**
     * A set of photons.
     */
-  std::vector<std::unique_ptr<TLorentzVector> > fPhotons;
+  std::vector<TLorentzVector> fPhotons;
+
+  /**
+    * The name handles of the partons.
+    */
+  std::vector<int> fNamePartons;
+
+  /**
+    * The name handles of the electrons.
+    */
+  std::vector<int> fNameElectrons;
+
+  /**
+    * The name handles of the muons.
+    */
+  std::vector<int> fNameMuons;
 
   /**
-    * The name of the partons.
+    * The name handles of the taus.
     */
-  std::vector<std::string> fNamePartons;
+  std::vector<int> fNameTaus;
 
   /**
-    * The name of the electrons.
+    * The name handles of the neutrinos.
     */
-  std::vector<std::string> fNameElectrons;
+  std::vector<int> fNameNeutrinos;
 
   /**
-    * The name of the muons.
+    * The name handles of the bosons.
     */
-  std::vector<std::string> fNameMuons;
+  std::vector<int> fNameBosons;
 
   /**
-    * The name of the taus.
+    * The name handles of the photons.
     */
-  std::vector<std::string> fNameTaus;
+  std::vector<int> fNamePhotons;
 
   /**
-    * The name of the neutrinos.
+    * The name table, shared between copies.
     */
-  std::vector<std::string> fNameNeutrinos;
+  std::shared_ptr<NameTable> fNameTable;
 
   /**
-    * The name of the bosons.
+    * The type and index of the particle for each name handle, or -1.
     */
-  std::vector<std::string> fNameBosons;
+  std::vector<std::pair<int, int> > fNameLocations;
 
   /**
-    * The name of the photons.
+    * Flag if the name locations are up to date.
     */
-  std::vector<std::string> fNamePhotons;
+  bool fNameLocationsValid;
 
   /**
     * The index of the corresponding measured parton.
@@ -577,9 +659,9 @@ class Particles final {
   std::vector<TrueFlavorType> fTrueFlavor;
 
   /**
-    * Vector containing a boolean for the b-tagging.
+    * Vector containing a flag for the b-tagging.
     */
-  std::vector<bool> fIsBTagged;
+  std::vector<char> fIsBTagged;
 
   /**
     * Vector containing the b-tagging efficiencies for the jets.
@@ -597,9 +679,9 @@ class Particles final {
   std::vector<double> fBTagWeight;
 
   /**
-    * Vector containing the bool if b-tagging weights for the jets were set.
+    * Vector containing the flag if b-tagging weights for the jets were set.
     */
-  std::vector<bool> fBTagWeightSet;
+  std::vector<char> fBTagWeightSet;
 
   /**
     * Vector containing the detector eta of electrons.
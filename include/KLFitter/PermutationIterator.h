@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2009--2018, the KLFitter developer team
+ *
+ * This file is part of KLFitter.
+ *
+ * KLFitter is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * KLFitter is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with KLFitter. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLFITTER_PERMUTATIONITERATOR_H_
+#define KLFITTER_PERMUTATIONITERATOR_H_
+
+#include <cstdint>
+#include <vector>
+
+// ---------------------------------------------------------
+
+/**
+ * \namespace KLFitter
+ * \brief The KLFitter namespace
+ */
+namespace KLFitter {
+/**
+  * \class KLFitter::PermutationIterator
+  * \brief An iterator over the permutations of M of N objects.
+  *
+  * This class walks the combinations of M of N objects in
+  * lexicographic order and, for each combination, its permutations in
+  * lexicographic order, i.e. in the order of the sub-tables of
+  * Permutations::CreateSubTable(). The combinations are stepped as
+  * bitmasks, so that no memory is allocated after the construction.
+  * The number of objects is limited to 63.
+  */
+class PermutationIterator final {
+ public:
+  /** \name Constructors and destructors */
+  /* @{ */
+
+  /**
+    * The constructor. The iterator starts at the first permutation.
+    * @param nobjects The number of objects N.
+    * @param npositions The number of objects per permutation M (all if negative).
+    */
+  PermutationIterator(int nobjects, int npositions = -1);
+
+  /**
+    * The (defaulted) destructor.
+    */
+  ~PermutationIterator();
+
+  /* @} */
+  /** \name Member functions (Get)  */
+  /* @{ */
+
+  /**
+    * Return whether the iterator points to a permutation.
+    * @return The flag.
+    */
+  bool Valid() const { return fValid; }
+
+  /**
+    * Return the current combination, i.e. the sorted indices of the
+    * objects.
+    * @return The combination.
+    */
+  const std::vector<int>& Combination() const { return fCombination; }
+
+  /**
+    * Return the current permutation of the objects of the combination.
+    * @return The permutation.
+    */
+  const std::vector<int>& Permutation() const { return fPermutation; }
+
+  /* @} */
+  /** \name Member functions (misc)  */
+  /* @{ */
+
+  /**
+    * Go to the next permutation, which is the first permutation of the
+    * next combination after the last permutation of a combination.
+    * @return Whether the iterator points to a permutation.
+    */
+  bool Next();
+
+  /**
+    * Go to the first permutation of the next combination.
+    * @return Whether the iterator points to a permutation.
+    */
+  bool NextCombination();
+
+  /**
+    * Go back to the first permutation.
+    */
+  void Rewind();
+
+  /* @} */
+
+ private:
+  /**
+    * Set the combination and permutation from the bitmask.
+    */
+  void SetCombination();
+
+  /**
+    * The number of objects and of objects per permutation.
+    */
+  int fNObjects;
+  int fNPositions;
+
+  /**
+    * The bitmask of the objects not in the current combination, with
+    * object i in bit N-1-i. The masks of the combinations in
+    * lexicographic order are decreasing, so their complements are
+    * stepped in increasing order with Gosper's hack.
+    */
+  std::uint64_t fUnused;
+
+  /**
+    * Flag whether the iterator points to a permutation.
+    */
+  bool fValid;
+
+  /**
+    * The current combination and permutation.
+    */
+  std::vector<int> fCombination;
+  std::vector<int> fPermutation;
+};
+}  // namespace KLFitter
+
+#endif  // KLFITTER_PERMUTATIONITERATOR_H_
@@ -20,6 +20,7 @@
 #ifndef KLFITTER_PERMUTATIONS_H_
 #define KLFITTER_PERMUTATIONS_H_
 
+#include <utility>
 #include <vector>
 
 #include "KLFitter/Particles.h"
@@ -39,6 +40,17 @@ namespace KLFitter {
   * pointer to the currently used permutations. It can calculate all
   * permutations and created a table. The pointer of the current
   * permutation is set to the entry in the table.
+  *
+  * In the index-only mode, only the indices of the permutations are
+  * stored, and the current permutation is a single set of particles
+  * which is overwritten from the original particles on every call of
+  * SetPermutation().
+  *
+  * Invariances and forbidden positions can be declared after Reset()
+  * and before CreatePermutations(). They are then applied while the
+  * permutations are created, so that only the canonical permutations
+  * are created at all. The permutations defined this way can also be
+  * counted, ranked and unranked without creating them.
   */
 class Permutations final {
  public:
@@ -53,7 +65,7 @@ class Permutations final {
   Permutations(KLFitter::Particles** p, KLFitter::Particles** pp);
 
   /**
-    * The (defaulted) copy constructor.
+    * The copy constructor.
     */
   explicit Permutations(const Permutations& o);
 
@@ -63,7 +75,8 @@ class Permutations final {
   ~Permutations();
 
   /**
-    * The (defaulted) assignment operator.
+    * The assignment operator. The tables are copied into the storage
+    * of this object.
     */
   Permutations& operator=(const Permutations& obj);
 
@@ -92,7 +105,7 @@ class Permutations final {
   /**
     * Return the number of permutations.
     */
-  int NPermutations() { return static_cast<int>(fParticlesTable.size()); }
+  int NPermutations() { return static_cast<int>(fPermutationTable.size()); }
 
   /**
     * Return the current permutation index.
@@ -108,6 +121,26 @@ class Permutations final {
 
   std::vector<std::vector<int> >* TablePhotons() { return &fTablePhotons; }
 
+  /**
+    * Return whether only the indices of the permutations are stored.
+    * @return The flag.
+    */
+  bool IndexOnly() const { return fIndexOnly; }
+
+  /**
+    * Return a signature of the table which CreatePermutations() would
+    * create, i.e. of the numbers of particles and the invariances and
+    * forbidden positions declared since the last Reset(). Tables with
+    * the same signature are identical, independent of the kinematics
+    * of the particles.
+    * @param nPartonsInPermutations The number of partons per permutation (all if negative).
+    * @param first The rank of the first permutation.
+    * @param count The number of permutations (all if negative).
+    * @param signature The signature, overwritten.
+    * @return An error code.
+    */
+  int TableSignature(int nPartonsInPermutations, long long first, long long count, std::vector<long long>* signature);
+
   /* @} */
   /** \name Member functions (Set)  */
   /* @{ */
@@ -126,6 +159,33 @@ class Permutations final {
     */
   int SetPermutation(int index);
 
+  /**
+    * Copy the tables of another permutation object. The pointers to
+    * the original and the permuted particles of this object are kept.
+    * @param other The permutation object to copy from.
+    * @return An error code.
+    */
+  int CopyTables(const KLFitter::Permutations& other);
+
+  /**
+    * Store only the indices of the permutations instead of a set of
+    * particles per permutation. This saves memory and the time to
+    * create the permutations, in particular for many jets. The flag
+    * is applied by the next call of CreatePermutations().
+    * @param flag The flag.
+    */
+  void SetIndexOnly(bool flag) { fIndexOnly = flag; }
+
+  /**
+    * Set the permutation table instead of creating it, e.g. from a
+    * table created for a previous event with the same signature (see
+    * TableSignature()). The particles of the permutations are taken
+    * from the current original particles.
+    * @param table The permutation table.
+    * @return An error code.
+    */
+  int SetPermutationTable(const std::vector<std::vector<int> >& table);
+
   /* @} */
   /** \name Member functions (misc)  */
   /* @{ */
@@ -133,8 +193,48 @@ class Permutations final {
   /**
     * Create all possible permutations of jets and leptons.
     * However, make permutations with exactly nPartonsInPermutations.
+    * The invariances and forbidden positions declared since the last
+    * Reset() are applied. Optionally, only a range of the permutations
+    * is created (see UnrankPermutation()), e.g. to share the
+    * permutations of an event between several jobs; this is not
+    * available with group invariances.
+    * @param nPartonsInPermutations The number of partons per permutation (all if negative).
+    * @param first The rank of the first permutation.
+    * @param count The number of permutations (all if negative).
+    * @return An error code.
     */
-  int CreatePermutations(int nPartonsInPermutations = -1);
+  int CreatePermutations(int nPartonsInPermutations = -1, long long first = 0, long long count = -1);
+
+  /**
+    * Return the number of permutations which CreatePermutations()
+    * would create with the invariances and forbidden positions declared
+    * since the last Reset(), without creating them. This is not
+    * available with group invariances.
+    * @param nPartonsInPermutations The number of partons per permutation (all if negative).
+    * @return The number of permutations, or -1 in case of an error.
+    */
+  long long CountPermutations(int nPartonsInPermutations = -1);
+
+  /**
+    * Get the permutation with the given rank, i.e. the permutation at
+    * this index of the table which CreatePermutations() would create
+    * with the invariances and forbidden positions declared since the
+    * last Reset(), without creating the table. This is not available
+    * with group invariances.
+    * @param rank The rank.
+    * @param permutation The permutation (see PermutationTable()).
+    * @param nPartonsInPermutations The number of partons per permutation (all if negative).
+    * @return An error code.
+    */
+  int UnrankPermutation(long long rank, std::vector<int>* permutation, int nPartonsInPermutations = -1);
+
+  /**
+    * Get the rank of a permutation, the inverse of UnrankPermutation().
+    * @param permutation The permutation (see PermutationTable()).
+    * @param nPartonsInPermutations The number of partons per permutation (all if negative).
+    * @return The rank, or -1 if the permutation would not be created.
+    */
+  long long RankPermutation(const std::vector<int>& permutation, int nPartonsInPermutations = -1);
 
   /**
     * Remove permutations in which all indices in the vector indexVector are exchanged
@@ -142,6 +242,8 @@ class Permutations final {
     * This is useful to reduce the number of permutations if
     * interchanging for example jets doesn't have any effect, e.g.,
     * if two jets come from a W (top).
+    * If called before CreatePermutations(), only the permutations with
+    * increasing particle indices in these positions are created.
     * @param ptype The type of the particle.
     * @param indexVector Vector of indices.
     * @return An error code.
@@ -154,6 +256,9 @@ class Permutations final {
     * This is useful to reduce the number of permutations if
     * interchanging a whole set of particles doesn't have any effect, e.g.,
     * the particles coming from the two hadronic top quarks in the fully hadronic channel.
+    * Of two such permutations, the later one in the table is kept.
+    * If called before CreatePermutations(), the permutations are removed
+    * right after they are created.
     * @param ptype The type of the particle.
     * @param indexVectorPosition1 Vector of indices of first set of particle.
     * @param indexVectorPosition2 Vector of corresponding indices for second set of particle.
@@ -165,6 +270,8 @@ class Permutations final {
     * Remove permutations in which a certain particles is in a certain position.
     * This is useful to reduce the number of permutations if for example
     * a b-tagged jet is forbidden in the position of a light jet.
+    * If called before CreatePermutations(), these permutations are not
+    * created.
     * @param ptype The type of the particle.
     * @param index The index of the particle.
     * @param position The position in which it is forbidden.
@@ -173,15 +280,30 @@ class Permutations final {
   int RemoveParticlePermutations(KLFitter::Particles::ParticleType ptype, int index, int position);
 
   /**
-    * Reset Permutations.
+    * Remove the flagged permutations, keeping the order of the others.
+    * @param remove The flags, one per permutation.
+    * @return An error code.
+    */
+  int RemovePermutations(const std::vector<bool>& remove);
+
+  /**
+    * Reset Permutations. This also removes the declared invariances
+    * and forbidden positions.
     * @return An error code.
     */
   int Reset();
 
   /**
     * Creates table of permutations.
+    * @param Nobj The number of objects.
+    * @param table The table.
+    * @param Nmax The number of objects per permutation (all if negative).
+    * @param ordered Pairs of positions with increasing indices.
+    * @param forbidden Pairs of positions and indices which are forbidden.
     */
-  int CreateSubTable(int Nobj, std::vector<std::vector<int> >* table, int Nmax = -1);
+  int CreateSubTable(int Nobj, std::vector<std::vector<int> >* table, int Nmax = -1,
+                     const std::vector<std::pair<int, int> >& ordered = std::vector<std::pair<int, int> >(),
+                     const std::vector<std::pair<int, int> >& forbidden = std::vector<std::pair<int, int> >());
 
   /* @} */
 
@@ -191,15 +313,61 @@ class Permutations final {
     */
   int CheckParticles();
 
- private:
   /**
-    * Helper functions to efficiently create permutations of N particles of only M selected particles.
+    * Add the particles of a permutation to a set of particles.
+    * @param permutation The permutation.
+    * @param particles The set of particles.
     */
+  void AddPermutedParticles(const std::vector<int>& permutation, KLFitter::Particles* particles);
 
-  std::vector<int> Get_int_vector(int i);
-  std::vector<int> Get_int_plus_vector(int i, std::vector<int> v);
-  std::vector<std::vector<int> > Get_M_from_N(unsigned int N, unsigned int M, unsigned int start = 0);
+  /**
+    * Return the combinations of objects of the sub-tables of all
+    * permuted particle types, in the order of CreateSubTable().
+    * @param nPartonsInPermutations The number of partons per permutation (all if negative).
+    * @return The particle types and combinations.
+    */
+  std::vector<std::pair<KLFitter::Particles::ParticleType, std::vector<std::vector<int> > > >
+  SubTableCombinations(int nPartonsInPermutations);
+
+  /**
+    * Remove the flagged permutations from the tables.
+    * @param remove The flags, one per permutation.
+    */
+  void ErasePermutations(const std::vector<bool>& remove);
+
+  /**
+    * Clear the tables of permutations and particles. Their entries
+    * are kept in pools and re-used by the next tables, so that the
+    * tables of new events do not allocate memory once the pools are
+    * large enough.
+    */
+  void RecycleTables();
+
+  /**
+    * Append an empty set of particles to the table of particles,
+    * taken from the pool if available.
+    * @return A pointer to the set of particles.
+    */
+  KLFitter::Particles* NewPermutedParticles();
+
+  /**
+    * Append an empty permutation to the table of permutations, taken
+    * from the pool if available.
+    * @return A pointer to the permutation.
+    */
+  std::vector<int>* NewPermutation();
+
+  /**
+    * A group invariance declared before the creation of the
+    * permutations (see InvariantParticleGroupPermutations()).
+    */
+  struct GroupInvariance {
+    KLFitter::Particles::ParticleType ptype;
+    std::vector<int> indexVectorPosition1;
+    std::vector<int> indexVectorPosition2;
+  };
 
+ private:
   /**
     * A pointer to the pointer of original particles.
     */
@@ -215,16 +383,48 @@ class Permutations final {
     */
   std::vector<KLFitter::Particles> fParticlesTable;
 
+  /**
+    * Store only the indices of the permutations.
+    */
+  bool fIndexOnly;
+
+  /**
+    * The current permutation in the index-only mode.
+    */
+  KLFitter::Particles fParticlesView;
+
   /**
     * A table of permutations. Needed for the math.
     */
   std::vector<std::vector<int> > fPermutationTable;
 
+  /**
+    * The pools of unused sets of particles and permutations (see
+    * RecycleTables()).
+    */
+  std::vector<KLFitter::Particles> fParticlesPool;
+  std::vector<std::vector<int> > fPermutationPool;
+
   /**
     * The permutation index
     */
   int fPermutationIndex;
 
+  /**
+    * Flag whether the permutations have been created since the last
+    * Reset().
+    */
+  bool fCreated;
+
+  /**
+    * The declared invariances and forbidden positions per particle
+    * type: pairs of positions with increasing indices, pairs of
+    * positions and forbidden indices, and group invariances.
+    */
+  std::vector<std::vector<std::pair<int, int> > > fOrderedPositions;
+  std::vector<std::vector<std::pair<int, int> > > fForbiddenPositions;
+  std::vector<GroupInvariance> fGroupInvariances;
+
   std::vector<std::vector<int> > fTablePartons;
   std::vector<std::vector<int> > fTableElectrons;
   std::vector<std::vector<int> > fTableMuons;
@@ -100,6 +100,46 @@ class ResDoubleGaussBase : public ResolutionBase {
     */
   virtual double GetSigma2(double x) = 0;
 
+  /**
+    * Calculate the derivative of the mean of the first Gaussian with respect to x.
+    * The default implementation uses a central finite difference.
+    * @param x The value of x.
+    * @return The derivative.
+    */
+  virtual double GetMean1Derivative(double x);
+
+  /**
+    * Calculate the derivative of the width of the first Gaussian with respect to x.
+    * The default implementation uses a central finite difference.
+    * @param x The value of x.
+    * @return The derivative.
+    */
+  virtual double GetSigma1Derivative(double x);
+
+  /**
+    * Calculate the derivative of the amplitude of the second Gaussian with respect to x.
+    * The default implementation uses a central finite difference.
+    * @param x The value of x.
+    * @return The derivative.
+    */
+  virtual double GetAmplitude2Derivative(double x);
+
+  /**
+    * Calculate the derivative of the mean of the second Gaussian with respect to x.
+    * The default implementation uses a central finite difference.
+    * @param x The value of x.
+    * @return The derivative.
+    */
+  virtual double GetMean2Derivative(double x);
+
+  /**
+    * Calculate the derivative of the width of the second Gaussian with respect to x.
+    * The default implementation uses a central finite difference.
+    * @param x The value of x.
+    * @return The derivative.
+    */
+  virtual double GetSigma2Derivative(double x);
+
   /**
     * Return the approximate width of the TF depending on the measured value of x.
     * Used to adjust the range of the fit parameter that correspond to the TF.
@@ -129,6 +169,30 @@ class ResDoubleGaussBase : public ResolutionBase {
     */
   double p(double x, double xmeas, bool *good, double par) override { *good = true; return 0; }
 
+  /**
+    * Return the derivative of log p(x, xmeas) with respect to x,
+    * see ResolutionBase::LogPDerivative(). Parameters which are
+    * modified by the sanity check do not contribute.
+    * @param x The true value of x.
+    * @param xmeas The measured value of x.
+    * @param good False if problem with TF.
+    * @return The derivative of the logarithm of the probability.
+    */
+  double LogPDerivative(double x, double xmeas, bool *good) override;
+
+  /**
+    * Return an upper bound of the probability for true values in
+    * [xmin, xmax], see ResolutionBase::GetPMax().
+    * The double Gaussian is bounded by the peak of the narrower
+    * Gaussian. The widths are assumed to be monotonic in x, which
+    * holds for all parameterizations in KLFitter.
+    * @param xmin The lower limit of the true value.
+    * @param xmax The upper limit of the true value.
+    * @param par Not used.
+    * @return The upper bound of the probability.
+    */
+  double GetPMax(double xmin, double xmax, double par) override;
+
   /* @} */
 
   /**
@@ -155,6 +219,15 @@ class ResDoubleGaussBase : public ResolutionBase {
 
     return true;
   }
+
+ protected:
+  /**
+    * Central finite difference of one of the parameterization functions.
+    * @param func The function, e.g. GetMean1.
+    * @param x The value of x.
+    * @return The derivative.
+    */
+  double NumericDerivative(double (ResDoubleGaussBase::*func)(double), double x);
 };
 }  // namespace KLFitter
 
@@ -100,6 +100,41 @@ class ResDoubleGaussE_1 : public ResDoubleGaussBase {
     */
   double GetSigma2(double x) override;
 
+  /**
+    * Calculate the derivative of the mean of the first Gaussian with respect to x.
+    * @param x The value of x.
+    * @return The derivative.
+    */
+  double GetMean1Derivative(double x) override;
+
+  /**
+    * Calculate the derivative of the width of the first Gaussian with respect to x.
+    * @param x The value of x.
+    * @return The derivative.
+    */
+  double GetSigma1Derivative(double x) override;
+
+  /**
+    * Calculate the derivative of the amplitude of the second Gaussian with respect to x.
+    * @param x The value of x.
+    * @return The derivative.
+    */
+  double GetAmplitude2Derivative(double x) override;
+
+  /**
+    * Calculate the derivative of the mean of the second Gaussian with respect to x.
+    * @param x The value of x.
+    * @return The derivative.
+    */
+  double GetMean2Derivative(double x) override;
+
+  /**
+    * Calculate the derivative of the width of the second Gaussian with respect to x.
+    * @param x The value of x.
+    * @return The derivative.
+    */
+  double GetSigma2Derivative(double x) override;
+
   /* @} */
 };
 }  // namespace KLFitter
@@ -88,6 +88,26 @@ class ResGaussE : public ResolutionBase {
     */
   double p(double x, double xmeas, bool *good) override;
 
+  /**
+    * Return the derivative of log p(x, xmeas) with respect to x,
+    * see ResolutionBase::LogPDerivative().
+    * @param x The true value of x.
+    * @param xmeas The measured value of x.
+    * @param good False if problem with TF.
+    * @return The derivative of the logarithm of the probability.
+    */
+  double LogPDerivative(double x, double xmeas, bool *good) override;
+
+  /**
+    * Return an upper bound of the probability for true values in
+    * [xmin, xmax], see ResolutionBase::GetPMax().
+    * @param xmin The lower limit of the true value.
+    * @param xmax The upper limit of the true value.
+    * @param par Not used.
+    * @return The upper bound of the probability.
+    */
+  double GetPMax(double xmin, double xmax, double par) override;
+
   /* @} */
   /** \name Member functions (Set)  */
   /* @{ */
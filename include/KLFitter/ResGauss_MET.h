@@ -93,6 +93,27 @@ class ResGauss_MET : public ResolutionBase {
     */
   double p(double x, double xmeas, bool *good, double sumet) override;
 
+  /**
+    * Return the derivative of log p(x, xmeas, sumet) with respect to
+    * x, see ResolutionBase::LogPDerivative().
+    * @param x The true value of x.
+    * @param xmeas The measured value of x.
+    * @param good False if problem with TF.
+    * @param sumet SumET, as the width of the TF depends on this.
+    * @return The derivative of the logarithm of the probability.
+    */
+  double LogPDerivative(double x, double xmeas, bool *good, double sumet) override;
+
+  /**
+    * Return an upper bound of the probability for true values in
+    * [xmin, xmax], see ResolutionBase::GetPMax().
+    * @param xmin The lower limit of the true value.
+    * @param xmax The upper limit of the true value.
+    * @param sumet SumET, as the width of the TF depends on this.
+    * @return The upper bound of the probability.
+    */
+  double GetPMax(double xmin, double xmax, double sumet) override;
+
   /* @} */
   /** \name Member functions (Set)  */
   /* @{ */
@@ -20,8 +20,12 @@
 #ifndef KLFITTER_RESOLUTIONBASE_H_
 #define KLFITTER_RESOLUTIONBASE_H_
 
+#include <cmath>
+#include <cstddef>
 #include <vector>
 
+#include "KLFitter/Dual.h"
+
 // ---------------------------------------------------------
 
 /**
@@ -91,6 +95,76 @@ class ResolutionBase {
     */
   virtual double p(double x, double xmeas, bool *good, double par) { *good = true; return 0; }
 
+  /**
+    * Return the derivative of log p(x, xmeas) with respect to the
+    * true value x. The default implementation uses a central finite
+    * difference of p(x, xmeas, good).
+    * @param x The true value of x.
+    * @param xmeas The measured value of x.
+    * @param good False if problem with TF.
+    * @return The derivative of the logarithm of the probability.
+    */
+  virtual double LogPDerivative(double x, double xmeas, bool *good);
+
+  /**
+    * Return the derivative of log p(x, xmeas, par) with respect to
+    * the true value x. The default implementation uses a central
+    * finite difference of p(x, xmeas, good, par).
+    * @param x The true value of x.
+    * @param xmeas The measured value of x.
+    * @param good False if problem with TF.
+    * @param par Optional additional parameter (SumET in case of MET TF).
+    * @return The derivative of the logarithm of the probability.
+    */
+  virtual double LogPDerivative(double x, double xmeas, bool *good, double par);
+
+  /**
+    * Return the logarithm of p(x, xmeas). The overload for dual
+    * numbers propagates the derivative from LogPDerivative(), so that
+    * likelihoods templated on the scalar type can be differentiated.
+    * @param x The true value of x.
+    * @param xmeas The measured value of x.
+    * @param good False if problem with TF.
+    * @return The logarithm of the probability.
+    */
+  double LogP(double x, double xmeas, bool *good) { return std::log(p(x, xmeas, good)); }
+
+  template <std::size_t N>
+  Dual<N> LogP(const Dual<N>& x, double xmeas, bool *good) {
+    bool gooddev = true;
+    const double value = std::log(p(x.Value(), xmeas, good));
+    return x.Chain(value, LogPDerivative(x.Value(), xmeas, &gooddev));
+  }
+
+  /**
+    * Return the logarithm of p(x, xmeas, par), see LogP().
+    * @param x The true value of x.
+    * @param xmeas The measured value of x.
+    * @param good False if problem with TF.
+    * @param par Optional additional parameter (SumET in case of MET TF).
+    * @return The logarithm of the probability.
+    */
+  double LogP(double x, double xmeas, bool *good, double par) { return std::log(p(x, xmeas, good, par)); }
+
+  template <std::size_t N>
+  Dual<N> LogP(const Dual<N>& x, double xmeas, bool *good, double par) {
+    bool gooddev = true;
+    const double value = std::log(p(x.Value(), xmeas, good, par));
+    return x.Chain(value, LogPDerivative(x.Value(), xmeas, &gooddev, par));
+  }
+
+  /**
+    * Return an upper bound of the probability p(x, xmeas) for any
+    * measured value and any true value x in [xmin, xmax]. The bound
+    * is used to skip the fit of permutations which cannot contribute.
+    * The default implementation returns infinity, i.e. no bound.
+    * @param xmin The lower limit of the true value.
+    * @param xmax The upper limit of the true value.
+    * @param par Optional additional parameter (SumET in case of MET TF).
+    * @return The upper bound of the probability.
+    */
+  virtual double GetPMax(double xmin, double xmax, double par = 0);
+
   /**
     * Return a parameter of the parameterization.
     * @param index The parameter index.
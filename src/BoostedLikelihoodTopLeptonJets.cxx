@@ -50,6 +50,11 @@ KLFitter::BoostedLikelihoodTopLeptonJets::BoostedLikelihoodTopLeptonJets()
 // ---------------------------------------------------------
 KLFitter::BoostedLikelihoodTopLeptonJets::~BoostedLikelihoodTopLeptonJets() = default;
 
+// ---------------------------------------------------------
+std::unique_ptr<KLFitter::LikelihoodBase> KLFitter::BoostedLikelihoodTopLeptonJets::Clone() const {
+  return std::unique_ptr<KLFitter::LikelihoodBase>(new KLFitter::BoostedLikelihoodTopLeptonJets(*this));
+}
+
 // ---------------------------------------------------------
 int KLFitter::BoostedLikelihoodTopLeptonJets::SetET_miss_XY_SumET(double etx, double ety, double sumet) {
   // set missing ET x and y component and the SumET
@@ -160,19 +165,19 @@ void KLFitter::BoostedLikelihoodTopLeptonJets::DefineParameters() {
 
 // ---------------------------------------------------------
 int KLFitter::BoostedLikelihoodTopLeptonJets::CalculateLorentzVectors(std::vector <double> const& parameters) {
-  static double scale;
-  static double wlep_fit_e;
-  static double wlep_fit_px;
-  static double wlep_fit_py;
-  static double wlep_fit_pz;
-  static double thad_fit_e;
-  static double thad_fit_px;
-  static double thad_fit_py;
-  static double thad_fit_pz;
-  static double tlep_fit_e;
-  static double tlep_fit_px;
-  static double tlep_fit_py;
-  static double tlep_fit_pz;
+  double scale;
+  double wlep_fit_e;
+  double wlep_fit_px;
+  double wlep_fit_py;
+  double wlep_fit_pz;
+  double thad_fit_e;
+  double thad_fit_px;
+  double thad_fit_py;
+  double thad_fit_pz;
+  double tlep_fit_e;
+  double tlep_fit_px;
+  double tlep_fit_py;
+  double tlep_fit_pz;
 
   // hadronic b quark
   bhad_fit_e = parameters[parBhadE];
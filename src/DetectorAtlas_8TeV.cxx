@@ -132,180 +132,160 @@ KLFitter::DetectorAtlas_8TeV::~DetectorAtlas_8TeV() = default;
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorAtlas_8TeV::ResEnergyLightJet(double eta) {
   if (fabs(eta) < fJetEtaBin_1) {
-    fResEnergyLightJet = fResEnergyLightJet_eta1.get();
+    return fResEnergyLightJet_eta1.get();
   } else if (fabs(eta) < fJetEtaBin_2) {
-    fResEnergyLightJet = fResEnergyLightJet_eta2.get();
+    return fResEnergyLightJet_eta2.get();
   } else if (fabs(eta) < fJetEtaBin_3) {
-    fResEnergyLightJet = fResEnergyLightJet_eta3.get();
+    return fResEnergyLightJet_eta3.get();
   } else if (fabs(eta) <= fJetEtaBin_4) {
-    fResEnergyLightJet = fResEnergyLightJet_eta4.get();
+    return fResEnergyLightJet_eta4.get();
   } else {
     std::cout << "KLFitter::DetectorAtlas_8TeV::ResEnergyLightJet(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResEnergyLightJet;
 }
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorAtlas_8TeV::ResEnergyBJet(double eta) {
   if (fabs(eta) < fJetEtaBin_1) {
-    fResEnergyBJet = fResEnergyBJet_eta1.get();
+    return fResEnergyBJet_eta1.get();
   } else if (fabs(eta) < fJetEtaBin_2) {
-    fResEnergyBJet = fResEnergyBJet_eta2.get();
+    return fResEnergyBJet_eta2.get();
   } else if (fabs(eta) < fJetEtaBin_3) {
-    fResEnergyBJet = fResEnergyBJet_eta3.get();
+    return fResEnergyBJet_eta3.get();
   } else if (fabs(eta) <= fJetEtaBin_4) {
-    fResEnergyBJet = fResEnergyBJet_eta4.get();
+    return fResEnergyBJet_eta4.get();
   } else {
     std::cout << "KLFitter::DetectorAtlas_8TeV::ResEnergyBJet(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResEnergyBJet;
 }
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorAtlas_8TeV::ResEnergyGluonJet(double eta) {
   if (fabs(eta) < fJetEtaBin_1) {
-    fResEnergyGluonJet = fResEnergyGluonJet_eta1.get();
+    return fResEnergyGluonJet_eta1.get();
   } else if (fabs(eta) < fJetEtaBin_2) {
-    fResEnergyGluonJet = fResEnergyGluonJet_eta2.get();
+    return fResEnergyGluonJet_eta2.get();
   } else if (fabs(eta) < fJetEtaBin_3) {
-    fResEnergyGluonJet = fResEnergyGluonJet_eta3.get();
+    return fResEnergyGluonJet_eta3.get();
   } else if (fabs(eta) <= fJetEtaBin_4) {
-    fResEnergyGluonJet = fResEnergyGluonJet_eta4.get();
+    return fResEnergyGluonJet_eta4.get();
   } else {
     std::cout << "KLFitter::DetectorAtlas_8TeV::ResEnergyGluonJet(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResEnergyGluonJet;
 }
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorAtlas_8TeV::ResEnergyElectron(double eta) {
   if (fabs(eta) < fElectronEtaBin_1) {
-    fResEnergyElectron = fResEnergyElectron_eta1.get();
+    return fResEnergyElectron_eta1.get();
   } else if (fabs(eta) < fElectronEtaBin_2) {
-    fResEnergyElectron = fResEnergyElectron_eta2.get();
+    return fResEnergyElectron_eta2.get();
   } else if (fabs(eta) < fElectronEtaBin_3) {
     std::cout << "KLFitter::DetectorAtlas_8TeV::ResEnergyElectron(). Electron in crack region" << std::endl;
     return 0;
   } else if (fabs(eta) <= fElectronEtaBin_4) {
-    fResEnergyElectron = fResEnergyElectron_eta4.get();
+    return fResEnergyElectron_eta4.get();
   } else {
     std::cout << "KLFitter::DetectorAtlas_8TeV::ResEnergyElectron(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResEnergyElectron;
 }
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorAtlas_8TeV::ResEnergyMuon(double eta) {
   if (fabs(eta) < fMuonEtaBin_1) {
-    fResEnergyMuon = fResEnergyMuon_eta1.get();
+    return fResEnergyMuon_eta1.get();
   } else if (fabs(eta) < fMuonEtaBin_2) {
-    fResEnergyMuon = fResEnergyMuon_eta2.get();
+    return fResEnergyMuon_eta2.get();
   } else if (fabs(eta) < fMuonEtaBin_3) {
-    fResEnergyMuon = fResEnergyMuon_eta3.get();
+    return fResEnergyMuon_eta3.get();
   } else {
     std::cout << "KLFitter::DetectorAtlas_8TeV::ResEnergyMuon(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResEnergyMuon;
 }
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorAtlas_8TeV::ResEnergyPhoton(double eta) {
   if (fabs(eta) < fPhotonEtaBin_1) {
-    fResEnergyPhoton = fResEnergyPhoton_eta1.get();
+    return fResEnergyPhoton_eta1.get();
   } else if (fabs(eta) < fPhotonEtaBin_2) {
-    fResEnergyPhoton = fResEnergyPhoton_eta2.get();
+    return fResEnergyPhoton_eta2.get();
   } else if (fabs(eta) < fPhotonEtaBin_3) {
-    fResEnergyPhoton = fResEnergyPhoton_eta3.get();
+    return fResEnergyPhoton_eta3.get();
   } else if (fabs(eta) <= fPhotonEtaBin_4) {
-    fResEnergyPhoton = fResEnergyPhoton_eta4.get();
+    return fResEnergyPhoton_eta4.get();
   } else {
     std::cout << "KLFitter::DetectorAtlas_8TeV::ResEnergyPhoton(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResEnergyPhoton;
 }
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorAtlas_8TeV::ResEtaLightJet(double eta) {
   if (fabs(eta) < fJetEtaBin_1) {
-    fResEtaLightJet = fResEtaLightJet_eta1.get();
+    return fResEtaLightJet_eta1.get();
   } else if (fabs(eta) < fJetEtaBin_2) {
-    fResEtaLightJet = fResEtaLightJet_eta2.get();
+    return fResEtaLightJet_eta2.get();
   } else if (fabs(eta) < fJetEtaBin_3) {
-    fResEtaLightJet = fResEtaLightJet_eta3.get();
+    return fResEtaLightJet_eta3.get();
   } else if (fabs(eta) <= fJetEtaBin_4) {
-    fResEtaLightJet = fResEtaLightJet_eta4.get();
+    return fResEtaLightJet_eta4.get();
   } else {
     std::cout << "KLFitter::DetectorAtlas_8TeV::ResEtaLightJet(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResEtaLightJet;
 }
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorAtlas_8TeV::ResEtaBJet(double eta) {
   if (fabs(eta) < fJetEtaBin_1) {
-    fResEtaBJet = fResEtaBJet_eta1.get();
+    return fResEtaBJet_eta1.get();
   } else if (fabs(eta) < fJetEtaBin_2) {
-    fResEtaBJet = fResEtaBJet_eta2.get();
+    return fResEtaBJet_eta2.get();
   } else if (fabs(eta) < fJetEtaBin_3) {
-    fResEtaBJet = fResEtaBJet_eta3.get();
+    return fResEtaBJet_eta3.get();
   } else if (fabs(eta) <= fJetEtaBin_4) {
-    fResEtaBJet = fResEtaBJet_eta4.get();
+    return fResEtaBJet_eta4.get();
   } else {
     std::cout << "KLFitter::DetectorAtlas_8TeV::ResEtaBJet(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResEtaBJet;
 }
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorAtlas_8TeV::ResPhiLightJet(double eta) {
   if (fabs(eta) < fJetEtaBin_1) {
-    fResPhiLightJet = fResPhiLightJet_eta1.get();
+    return fResPhiLightJet_eta1.get();
   } else if (fabs(eta) < fJetEtaBin_2) {
-    fResPhiLightJet = fResPhiLightJet_eta2.get();
+    return fResPhiLightJet_eta2.get();
   } else if (fabs(eta) < fJetEtaBin_3) {
-    fResPhiLightJet = fResPhiLightJet_eta3.get();
+    return fResPhiLightJet_eta3.get();
   } else if (fabs(eta) <= fJetEtaBin_4) {
-    fResPhiLightJet = fResPhiLightJet_eta4.get();
+    return fResPhiLightJet_eta4.get();
   } else {
     std::cout << "KLFitter::DetectorAtlas_8TeV::ResPhiLightJet(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResPhiLightJet;
 }
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorAtlas_8TeV::ResPhiBJet(double eta) {
   if (fabs(eta) < fJetEtaBin_1) {
-    fResPhiBJet = fResPhiBJet_eta1.get();
+    return fResPhiBJet_eta1.get();
   } else if (fabs(eta) < fJetEtaBin_2) {
-    fResPhiBJet = fResPhiBJet_eta2.get();
+    return fResPhiBJet_eta2.get();
   } else if (fabs(eta) < fJetEtaBin_3) {
-    fResPhiBJet = fResPhiBJet_eta3.get();
+    return fResPhiBJet_eta3.get();
   } else if (fabs(eta) <= fJetEtaBin_4) {
-    fResPhiLightJet = fResPhiLightJet_eta4.get();
+    return fResPhiBJet_eta4.get();
   } else {
     std::cout << "KLFitter::DetectorAtlas_8TeV::ResPhiBJet(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResPhiBJet;
 }
 
 // ---------------------------------------------------------
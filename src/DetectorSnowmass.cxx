@@ -70,41 +70,37 @@ KLFitter::DetectorSnowmass::~DetectorSnowmass() = default;
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorSnowmass::ResEnergyLightJet(double eta) {
   if (fabs(eta) < fJetEtaBin_1) {
-    fResEnergyLightJet = fResEnergyJet_eta1.get();
+    return fResEnergyJet_eta1.get();
   } else if (fabs(eta) < fJetEtaBin_2) {
-    fResEnergyLightJet = fResEnergyJet_eta2.get();
+    return fResEnergyJet_eta2.get();
   } else if (fabs(eta) < fJetEtaBin_3) {
-    fResEnergyLightJet = fResEnergyJet_eta3.get();
+    return fResEnergyJet_eta3.get();
   } else {
     std::cout << "KLFitter::DetectorSnowmass::ResEnergyLightJet(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResEnergyLightJet;
 }
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorSnowmass::ResEnergyBJet(double eta) {
   if (fabs(eta) < fJetEtaBin_1) {
-    fResEnergyBJet = fResEnergyJet_eta1.get();
+    return fResEnergyJet_eta1.get();
   } else if (fabs(eta) < fJetEtaBin_2) {
-    fResEnergyBJet = fResEnergyJet_eta2.get();
+    return fResEnergyJet_eta2.get();
   } else if (fabs(eta) < fJetEtaBin_3) {
-    fResEnergyBJet = fResEnergyJet_eta3.get();
+    return fResEnergyJet_eta3.get();
   } else {
     std::cout << "KLFitter::DetectorSnowmass::ResEnergyBJet(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResEnergyBJet;
 }
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorSnowmass::ResEnergyElectron(double eta) {
   if (fabs(eta) < fElectronEtaBin_1) {
-    fResEnergyElectron = fResEnergyElectron_eta1.get();
+    return fResEnergyElectron_eta1.get();
   } else if (fabs(eta) < fElectronEtaBin_2) {
-    fResEnergyElectron = fResEnergyElectron_eta2.get();
+    return fResEnergyElectron_eta2.get();
   } else {
     std::cout << "KLFitter::DetectorSnowmass::ResEnergyElectron(). Eta range exceeded." << std::endl;
     return 0;
@@ -115,15 +111,13 @@ KLFitter::ResolutionBase * KLFitter::DetectorSnowmass::ResEnergyElectron(double
 // ---------------------------------------------------------
 KLFitter::ResolutionBase * KLFitter::DetectorSnowmass::ResEnergyMuon(double eta) {
   if (fabs(eta) < fMuonEtaBin_1) {
-    fResEnergyMuon = fResMomentumMuon_eta1.get();
+    return fResMomentumMuon_eta1.get();
   } else if (fabs(eta) < fMuonEtaBin_2) {
-    fResEnergyMuon = fResMomentumMuon_eta2.get();
+    return fResMomentumMuon_eta2.get();
   } else {
     std::cout << "KLFitter::DetectorSnowmass::ResEnergyMuon(). Eta range exceeded." << std::endl;
     return 0;
   }
-
-  return fResEnergyMuon;
 }
 
 // ---------------------------------------------------------
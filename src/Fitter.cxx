@@ -19,7 +19,19 @@
 
 #include "KLFitter/Fitter.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #include "BAT/BCParameter.h"
 #include "KLFitter/DetectorBase.h"
@@ -27,6 +39,124 @@
 #include "KLFitter/Particles.h"
 #include "KLFitter/Permutations.h"
 
+namespace {
+/**
+  * The lock serialising all calls into BAT. BAT binds the Minuit
+  * FCN and its MCMC engine through process-wide globals, so only
+  * one minimisation can run at a time, even with separate models.
+  * The fits with Minuit2 (see LikelihoodBase::FindModeMinuit2()) do
+  * not go through BAT and need no lock.
+  */
+std::mutex& BATMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+/**
+  * The result of a single permutation in FitCoarseToFine().
+  */
+struct CoarseToFineResult {
+  int minuitStatus;
+  unsigned int convergenceStatus;
+  std::vector<double> parameters;
+  std::vector<double> parameterErrors;
+  double normalization;
+};
+
+/**
+  * The number of permutation blocks per worker the batch fit aims
+  * for. More blocks balance better, fewer blocks mean fewer switches
+  * between events.
+  */
+const std::size_t kBlocksPerWorker = 16;
+
+/**
+  * A block of permutations of one event of the batch fit.
+  */
+struct BatchTask {
+  std::size_t event;
+  std::vector<int> permutations;
+};
+
+/**
+  * The state of an event of the batch fit which is shared by the
+  * workers fitting its blocks of permutations: the budget, the
+  * pruning bounds and the starting points of the warm start. The
+  * workers take it over before and merge into it after each fit.
+  * FitParallel() shares only the budget.
+  */
+struct BatchEventState {
+  std::mutex mutex;
+  bool budgetStarted = false;
+  std::chrono::steady_clock::time_point budgetStart;
+  long evaluations = 0;
+  double pruningBest = -std::numeric_limits<double>::infinity();
+  double pruningLogSum = -std::numeric_limits<double>::infinity();
+  std::vector<int> warmStartIndices;
+  std::vector<std::vector<double> > warmStartParameters;
+  std::atomic<std::size_t> remainingTasks{0};
+};
+
+/**
+  * Add the log of the event probability of a permutation to the
+  * pruning bounds, i.e. the largest log of the event probability and
+  * the log of the sum of the event probabilities.
+  */
+void AddToPruning(double logprob, double* best, double* logsum) {
+  if (logprob <= -1e99)
+    return;
+
+  *best = std::max(*best, logprob);
+
+  // add to the sum in log space
+  if (*logsum < logprob)
+    *logsum = logprob + log1p(exp(*logsum - logprob));
+  else
+    *logsum = *logsum + log1p(exp(logprob - *logsum));
+}
+
+/**
+  * A set of task queues, one per worker. A worker takes the tasks
+  * from the front of its own queue, so that it works through its
+  * events in order. Once its queue is empty, it steals from the back
+  * of the other queues.
+  */
+class WorkStealingQueues {
+ public:
+  explicit WorkStealingQueues(unsigned int nqueues) : fQueues(nqueues) { }
+
+  void Push(unsigned int iqueue, const BatchTask& task) {
+    std::lock_guard<std::mutex> lock(fQueues[iqueue].mutex);
+    fQueues[iqueue].tasks.push_back(task);
+  }
+
+  bool Pop(unsigned int iqueue, BatchTask* task) {
+    for (std::size_t i = 0; i < fQueues.size(); ++i) {
+      Queue& queue = fQueues[(iqueue + i) % fQueues.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (queue.tasks.empty())
+        continue;
+      if (i == 0) {
+        *task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      } else {
+        *task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      }
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<BatchTask> tasks;
+  };
+  std::vector<Queue> fQueues;
+};
+}  // namespace
+
 // ---------------------------------------------------------
 KLFitter::Fitter::Fitter()
   : fDetector(nullptr)
@@ -38,34 +168,150 @@ KLFitter::Fitter::Fitter()
   , fMyParticlesTruth(nullptr)
   , fLikelihood(nullptr)
   , fPermutations(std::unique_ptr<KLFitter::Permutations>(new KLFitter::Permutations{&fParticles, &fParticlesPermuted}))
+  , fPermutationFirst(0)
+  , fPermutationCount(-1)
+  , fPermutationCacheSize(0)
   , fMinuitStatus(0)
   , fConvergenceStatus(0)
   , fTurnOffSA(false)
-  , fMinimizationMethod(kMinuit) {
-  // empty
+  , fMinimizationMethod(kMinuit)
+  , fPruningMode(kNoPruning)
+  , fPruningFraction(1e-3)
+  , fPruningBest(-std::numeric_limits<double>::infinity())
+  , fPruningLogSum(-std::numeric_limits<double>::infinity())
+  , fWarmStart(false)
+  , fUseAnalyticGradient(false)
+  , fUseMinuit2(false)
+  , fCoarseMaxCalls(500)
+  , fCoarseTolerance(1.)
+  , fCoarseFit(false)
+  , fBudgetTime(0)
+  , fBudgetEvaluations(0)
+  , fBudgetStarted(false)
+  , fBudgetStartEvaluations(0)
+  , fResultDetail(kResultParameters)
+  , fLogLikelihoodAtMode(std::numeric_limits<double>::quiet_NaN()) {
+  SetMinimizationMethod(kMinuit);
 }
 
 // ---------------------------------------------------------
 KLFitter::Fitter::~Fitter() = default;
 
+// ---------------------------------------------------------
+void KLFitter::Fitter::SetMinimizationMethod(kMinimizationMethod method) {
+  std::vector<MinimizationStage> stages;
+  if (method == kMinuit) {
+    // Minuit, re-run after simulated annealing if it failed
+    MinimizationStage annealing(kSimulatedAnnealing, kOnFailure, kStartInitial);
+    annealing.resetResults = true;
+    stages.emplace_back(kMinuit);
+    stages.emplace_back(annealing);
+    stages.emplace_back(kMinuit, kOnFailure, kStartPrevious);
+  } else if (method == kSimulatedAnnealing) {
+    MinimizationStage annealing(kSimulatedAnnealing, kAlways, kStartInitial);
+    annealing.saT0 = 10;
+    annealing.saTmin = 0.001;
+    stages.emplace_back(annealing);
+  } else {
+    stages.emplace_back(method);
+  }
+  SetMinimizationStages(stages);
+}
+
+// ---------------------------------------------------------
+int KLFitter::Fitter::SetMinimizationStages(const std::vector<MinimizationStage>& stages) {
+  if (stages.empty()) {
+    std::cout << "KLFitter::Fitter::SetMinimizationStages(). No stages given." << std::endl;
+    return 0;
+  }
+
+  fStages = stages;
+  fMinimizationMethod = fStages.front().method;
+  ResetStageStatistics();
+
+  // no error
+  return 1;
+}
+
+// ---------------------------------------------------------
+bool KLFitter::Fitter::StageTriggered(const MinimizationStage& stage, int status) {
+  if (stage.trigger == kOnFailure)
+    return status > 0;
+  if (stage.trigger == kOnStatus)
+    return std::find(stage.statuses.begin(), stage.statuses.end(), status) != stage.statuses.end();
+  return true;
+}
+
+// ---------------------------------------------------------
+void KLFitter::Fitter::AddStageStatistics(const KLFitter::Fitter& worker) {
+  for (std::size_t istage = 0; istage < fStageStatistics.size() && istage < worker.fStageStatistics.size(); ++istage) {
+    StageStatistics& statistics = fStageStatistics[istage];
+    const StageStatistics& other = worker.fStageStatistics[istage];
+    statistics.runs += other.runs;
+    statistics.skipped += other.skipped;
+    statistics.successes += other.successes;
+    statistics.evaluations += other.evaluations;
+    statistics.seconds += other.seconds;
+  }
+}
+
 // ---------------------------------------------------------
 int KLFitter::Fitter::SetParticles(KLFitter::Particles * particles, int nPartonsInPermutations) {
   fParticles = particles;
+  ResetPruning();
+  ResetWarmStart();
+  ResetBudget();
+  fResults.clear();
 
   // reset old table of permutations
   if (fPermutations)
     fPermutations->Reset();
 
-  // create table of permutations
-  fPermutations->CreatePermutations(nPartonsInPermutations);
-
-  // remove invariant permutations if likelihood exists
+  // declare the invariant permutations if likelihood exists, only
+  // the canonical permutations are created
   if (fLikelihood)
     fLikelihood->RemoveInvariantParticlePermutations();
 
-  // remove forbidden permutations
+  // get the signature of the table of permutations, which includes
+  // the b-tagging of the partons if it is used for vetoes
+  std::vector<long long>& signature = fPermutationSignature;
+  signature.clear();
+  if (fPermutationCacheSize > 0) {
+    fPermutations->TableSignature(nPartonsInPermutations, fPermutationFirst, fPermutationCount, &signature);
+    if (fLikelihood) {
+      signature.push_back(fLikelihood->GetBTagging());
+      if (fLikelihood->BTaggingVetoesPermutations()) {
+        for (int i = 0; i < fParticles->NPartons(); ++i)
+          signature.push_back(fParticles->IsBTagged(i));
+      }
+    }
+  }
+
+  // re-use a cached table of permutations
+  auto cached = signature.empty() ? fPermutationCache.end() : fPermutationCache.find(signature);
+  if (cached != fPermutationCache.end()) {
+    if (!fPermutations->SetPermutationTable(cached->second))
+      return 0;
+  } else {
+    // create table of permutations
+    if (!fPermutations->CreatePermutations(nPartonsInPermutations, fPermutationFirst, fPermutationCount))
+      return 0;
+
+    // remove forbidden permutations
+    if (fLikelihood && !fLikelihood->RemoveForbiddenParticlePermutations())
+      return 0;
+
+    // add the table to the cache
+    if (!signature.empty()) {
+      if (fPermutationCache.size() >= fPermutationCacheSize)
+        fPermutationCache.clear();
+      fPermutationCache[signature] = *fPermutations->PermutationTable();
+    }
+  }
+
+  // find the permutations which share their fits
   if (fLikelihood)
-    fLikelihood->RemoveForbiddenParticlePermutations();
+    fLikelihood->UpdateLHInvariantPermutationPartners();
 
   // check if any permutations are left
   if (fPermutations->NPermutations() == 0) {
@@ -116,6 +362,9 @@ int KLFitter::Fitter::SetLikelihood(KLFitter::LikelihoodBase * likelihood) {
   // set likelihood
   fLikelihood = likelihood;
 
+  // the cached permutation tables depend on the likelihood
+  fPermutationCache.clear();
+
   // set pointer to pointer of detector
   fLikelihood->SetDetector(&fDetector);
 
@@ -126,18 +375,21 @@ int KLFitter::Fitter::SetLikelihood(KLFitter::LikelihoodBase * likelihood) {
   fLikelihood->SetParticlesPermuted(&fParticlesPermuted);
 
   // remove invariant permutations if particles are defined alreday
-  if (fParticles)
+  if (fParticles) {
     fLikelihood->RemoveInvariantParticlePermutations();
+    fLikelihood->UpdateLHInvariantPermutationPartners();
+  }
 
   // no error
   return 1;
 }
 
 // ---------------------------------------------------------
-int KLFitter::Fitter::Fit(int index) {
+int KLFitter::Fitter::SetUpPermutation(int index) {
   fLikelihood->ResetCache();
   fLikelihood->ResetResults();
   ResetCache();
+  fLogLikelihoodAtMode = std::numeric_limits<double>::quiet_NaN();
 
   // check status
   if (!Status())
@@ -164,105 +416,361 @@ int KLFitter::Fitter::Fit(int index) {
     fLikelihood->PropagateBTaggingInformation();
   }
 
+  // no error
+  return 1;
+}
+
+// ---------------------------------------------------------
+int KLFitter::Fitter::Fit(int index) {
+  if (!SetUpPermutation(index))
+    return 0;
+
   // perform fitting
   // Check if LH is invariant
   int dummy;
   int nperms = fPermutations->NPermutations();
+  if (static_cast<int>(fResults.size()) != nperms)
+    fResults.assign(nperms, FitResult());
   int partnerindex = fLikelihood->LHInvariantPermutationPartner(index, nperms, &dummy, &dummy);
 
   // check if permutation is LH invariant and has already been calculated
   if ((partnerindex > -1)&&(partnerindex < index)) {
     fLikelihood->GetParametersFromCache(index);
     GetFitStatusFromCache(index);
+  } else if (BudgetUsed() >= 1.) {
+    // the budget of the event is used up, keep the initial parameters
+    fLikelihood->SetParametersToCache(index, nperms, fLikelihood->GetInitialParameters(),
+                                      std::vector<double>(fLikelihood->NParameters(), 0.), 0.);
+    fMinuitStatus = 511;
+    fConvergenceStatus = PermutationSkippedMask | BudgetExceededMask;
+    SetFitStatusToCache(index, nperms);
+  } else if (PrunePermutation()) {
+    // the permutation cannot contribute, keep the initial parameters
+    fLikelihood->SetParametersToCache(index, nperms, fLikelihood->GetInitialParameters(),
+                                      std::vector<double>(fLikelihood->NParameters(), 0.), 0.);
+    fMinuitStatus = 511;
+    fConvergenceStatus = PermutationSkippedMask;
+    SetFitStatusToCache(index, nperms);
   } else {
-    // Markov Chain MC
-    if (fMinimizationMethod == kMarkovChainMC) {
+    Minimize(WarmStartParameters(index));
+
+    // caching parameters
+    fLikelihood->SetParametersToCache(index, nperms);
+    SetFitStatusToCache(index, nperms);
+
+    UpdatePruning();
+    UpdateWarmStart(index);
+  }  // end of fitting "else"
+
+  FillResult(index);
+
+  // no error
+  return 1;
+}
+
+// ---------------------------------------------------------
+void KLFitter::Fitter::Minimize(const std::vector<double>& start) {
+  // run the stages; in the coarse pass only the first stage is run
+  // with the coarse settings
+  int status = -1;
+  bool minuit = false;
+  // the Minuit settings of the likelihood, restored after the stages
+  double previousarglist[2] = {fLikelihood->GetMinuitArglist()[0], fLikelihood->GetMinuitArglist()[1]};
+  bool budgetexceeded = false;
+  for (std::size_t istage = 0; istage < fStages.size(); ++istage) {
+    const MinimizationStage& stage = fStages[istage];
+    StageStatistics& statistics = fStageStatistics.at(istage);
+    if (!StageTriggered(stage, status))
+      continue;
+
+    // fallback stages are skipped in the coarse pass and once half of
+    // the budget is used
+    if (stage.trigger != kAlways && (fCoarseFit || BudgetUsed() >= 0.5)) {
+      budgetexceeded |= !fCoarseFit;
+      ++statistics.skipped;
+      continue;
+    }
+
+    if (stage.resetResults) {
+      fLikelihood->ResetCache();
+      fLikelihood->ResetResults();
+    }
+    if (stage.method == kSimulatedAnnealing && stage.trigger != kAlways && fTurnOffSA) {
+      ++statistics.skipped;
+      continue;
+    }
+    if (stage.resetResults)
+      fLikelihood->SetFlagIsNan(false);
+
+    std::vector<double> parameters;
+    if (stage.start == kStartFit)
+      parameters = start;
+    else if (stage.start == kStartInitial)
+      parameters = fLikelihood->GetInitialParameters();
+    else
+      parameters = fLikelihood->GetBestFitParameters();
+
+    const auto time = std::chrono::steady_clock::now();
+    const long evaluations = fLikelihood->NEvaluations();
+    if (stage.method == kMarkovChainMC) {
+      // Markov Chain MC
       fLikelihood->MCMCSetFlagFillHistograms(true);
-      fLikelihood->MCMCSetNChains(5);
-      fLikelihood->MCMCSetNIterationsRun(20000);
-      fLikelihood->MCMCSetNIterationsMax(1000000);
+      fLikelihood->MCMCSetNChains(stage.mcmcChains);
+      fLikelihood->MCMCSetNIterationsRun(stage.mcmcIterationsRun);
+      fLikelihood->MCMCSetNIterationsMax(stage.mcmcIterationsMax);
       fLikelihood->MCMCSetNIterationsUpdate(100);
+      std::lock_guard<std::mutex> lock(BATMutex());
       fLikelihood->MarginalizeAll();
-    } else if (fMinimizationMethod == kSimulatedAnnealing) {
+    } else if (stage.method == kSimulatedAnnealing) {
       // simulated annealing
       fLikelihood->SetOptimizationMethod(BCIntegrate::kOptSimAnn);
-      fLikelihood->SetSAT0(10);
-      fLikelihood->SetSATmin(0.001);
-      fLikelihood->FindMode(fLikelihood->GetInitialParameters());
-    } else if (fMinimizationMethod == kMinuit) {
+      if (stage.saT0 > 0)
+        fLikelihood->SetSAT0(stage.saT0);
+      if (stage.saTmin > 0)
+        fLikelihood->SetSATmin(stage.saTmin);
+      std::lock_guard<std::mutex> lock(BATMutex());
+      fLikelihood->FindMode(parameters);
+    } else if (stage.method == kMinuit) {
       // MINUIT
       fLikelihood->SetOptimizationMethod(BCIntegrate::kOptMinuit);
-      fLikelihood->FindMode(fLikelihood->GetInitialParameters());
-
+      double arglist[2] = {previousarglist[0], previousarglist[1]};
+      if (stage.maxCalls > 0)
+        arglist[0] = stage.maxCalls;
+      if (stage.tolerance > 0)
+        arglist[1] = stage.tolerance;
+      if (fCoarseFit) {
+        arglist[0] = fCoarseMaxCalls;
+        arglist[1] = fCoarseTolerance;
+      }
+      fLikelihood->SetMinuitArlist(arglist);
+      const bool gradient = fUseAnalyticGradient && fLikelihood->HasAnalyticGradient();
+      if (fUseMinuit2 || gradient) {
+        fLikelihood->FindModeMinuit2(parameters, gradient);
+      } else {
+        std::lock_guard<std::mutex> lock(BATMutex());
+        fLikelihood->FindMode(parameters);
+      }
+      minuit = true;
       fMinuitStatus = fLikelihood->GetMinuitErrorFlag();
 
-      // check if any parameter is at its borders->set MINUIT flag to 500
-      if (fMinuitStatus == 0) {
+      // check if any parameter is at its borders->set status to 500
+      status = fMinuitStatus;
+      if (status == 0) {
         std::vector<double> BestParameters = fLikelihood->GetBestFitParameters();
         for (unsigned int iPar = 0; iPar < fLikelihood->GetNParameters(); iPar++) {
           if (fLikelihood->GetParameter(0)->IsAtLimit(BestParameters[iPar])) {
-            fMinuitStatus = 500;
+            status = 500;
           }
         }
       }
       if (fLikelihood->GetFlagIsNan()== true) {
-        fMinuitStatus = 508;
+        status = 508;
       }
+      if (status == 0)
+        ++statistics.successes;
+    }
+    ++statistics.runs;
+    statistics.evaluations += fLikelihood->NEvaluations() - evaluations;
+    statistics.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - time).count();
 
-      // re-run if Minuit status bad
-      if (fMinuitStatus != 0) {
-        fLikelihood->ResetCache();
-        fLikelihood->ResetResults();
-        if (!fTurnOffSA) {
-          fLikelihood->SetFlagIsNan(false);
-          fLikelihood->SetOptimizationMethod(BCIntegrate::kOptSimAnn);
-          fLikelihood->FindMode(fLikelihood->GetInitialParameters());
-        }
+    if (fCoarseFit)
+      break;
+  }
 
-        fLikelihood->SetOptimizationMethod(BCIntegrate::kOptMinuit);
-        fLikelihood->FindMode(fLikelihood->GetBestFitParameters());
-        fMinuitStatus = fLikelihood->GetMinuitErrorFlag();
-      }
+  if (minuit) {
+    fLikelihood->SetMinuitArlist(previousarglist);
 
-      fConvergenceStatus = 0;
-      if (fMinuitStatus == 4)
-        fConvergenceStatus |= MinuitDidNotConvergeMask;
-    }
+    fConvergenceStatus = 0;
+    if (fMinuitStatus == 4)
+      fConvergenceStatus |= MinuitDidNotConvergeMask;
+    if (budgetexceeded)
+      fConvergenceStatus |= BudgetExceededMask;
+  }
 
-    // check if any parameter is at its borders->set MINUIT flag to 501
-    if (fMinuitStatus == 0) {
-      std::vector<double> BestParameters = fLikelihood->GetBestFitParameters();
-      for (unsigned int iPar = 0; iPar < fLikelihood->GetNParameters(); iPar++) {
-        if (fLikelihood->GetParameter(0)->IsAtLimit(BestParameters[iPar])) {
-          fMinuitStatus = 501;
-          fConvergenceStatus |= AtLeastOneFitParameterAtItsLimitMask;
-        }
+  // check if any parameter is at its borders->set MINUIT flag to 501
+  if (fMinuitStatus == 0) {
+    std::vector<double> BestParameters = fLikelihood->GetBestFitParameters();
+    for (unsigned int iPar = 0; iPar < fLikelihood->GetNParameters(); iPar++) {
+      if (fLikelihood->GetParameter(0)->IsAtLimit(BestParameters[iPar])) {
+        fMinuitStatus = 501;
+        fConvergenceStatus |= AtLeastOneFitParameterAtItsLimitMask;
       }
     }
-    if (fLikelihood->GetFlagIsNan()== true) {
-      fMinuitStatus = 509;
-      fConvergenceStatus |= FitAbortedDueToNaNMask;
-    } else {
-      // check if TF problem
-      if (!fLikelihood->NoTFProblem(fLikelihood->GetBestFitParameters())) {
-        fMinuitStatus = 510;
-        fConvergenceStatus |= InvalidTransferFunctionAtConvergenceMask;
-      }
+  }
+  if (fLikelihood->GetFlagIsNan()== true) {
+    fMinuitStatus = 509;
+    fConvergenceStatus |= FitAbortedDueToNaNMask;
+  } else {
+    // check if TF problem
+    if (!fLikelihood->NoTFProblem(fLikelihood->GetBestFitParameters(), &fLogLikelihoodAtMode)) {
+      fMinuitStatus = 510;
+      fConvergenceStatus |= InvalidTransferFunctionAtConvergenceMask;
     }
+  }
+
+  // calculate integral
+  if (fLikelihood->FlagIntegrate()) {
+    fLikelihood->SetIntegrationMethod(BCIntegrate::kIntCuba);
+    std::lock_guard<std::mutex> lock(BATMutex());
+    fLikelihood->Normalize();
+  }
+}
+
+// ---------------------------------------------------------
+void KLFitter::Fitter::FillResult(int index) {
+  FitResult& result = fResults.at(index);
+  result.fitted = true;
+  result.minuitStatus = fMinuitStatus;
+  result.convergenceStatus = fConvergenceStatus;
+
+  // the likelihood at the mode is taken over from the check for TF
+  // problems if possible
+  const std::vector<double> parameters = fLikelihood->GetBestFitParameters();
+  if (std::isnan(fLogLikelihoodAtMode))
+    fLogLikelihoodAtMode = fLikelihood->LogLikelihood(parameters);
+  result.logLikelihood = fLogLikelihoodAtMode;
+  result.logEventProbabilityBTag = 0;
+  if (fLikelihood->GetBTagging() != LikelihoodBase::kNotag)
+    result.logEventProbabilityBTag = fLikelihood->LogEventProbabilityBTag();
+  result.logEventProbability = fLikelihood->LogEventProbability(fLogLikelihoodAtMode);
+
+  result.parameters.clear();
+  result.parameterErrors.clear();
+  result.modelParticles.reset();
+  if (fResultDetail >= kResultParameters) {
+    result.parameters = parameters;
+    result.parameterErrors = fLikelihood->GetBestFitParameterErrors();
+  }
+  if (fResultDetail >= kResultModelParticles)
+    result.modelParticles = std::make_shared<KLFitter::Particles>(*fLikelihood->ParticlesModel());
+}
+
+// ---------------------------------------------------------
+const KLFitter::Fitter::FitResult * KLFitter::Fitter::Result(int index) const {
+  if (index < 0 || index >= static_cast<int>(fResults.size()) || !fResults[index].fitted) {
+    std::cout << "KLFitter::Fitter::Result(). Permutation " << index << " has not been fitted." << std::endl;
+    return nullptr;
+  }
+
+  return &fResults[index];
+}
+
+// ---------------------------------------------------------
+int KLFitter::Fitter::BestPermutation() const {
+  int best = -1;
+  for (int iperm = 0; iperm < static_cast<int>(fResults.size()); ++iperm) {
+    if (!fResults[iperm].fitted || (fResults[iperm].convergenceStatus & PermutationSkippedMask))
+      continue;
+    if (best < 0 || fResults[iperm].logEventProbability > fResults[best].logEventProbability)
+      best = iperm;
+  }
 
-    // calculate integral
-    if (fLikelihood->FlagIntegrate()) {
-      fLikelihood->SetIntegrationMethod(BCIntegrate::kIntCuba);
-      fLikelihood->Normalize();
+  return best;
+}
+
+// ---------------------------------------------------------
+bool KLFitter::Fitter::PrunePermutation() {
+  if (fPruningMode == kNoPruning || fMinimizationMethod == kMarkovChainMC)
+    return false;
+
+  double bound = fLikelihood->LogEventProbabilityUpperBound();
+
+  // permutations with vanishing probability are always skipped
+  if (bound <= -1e99)
+    return true;
+
+  if (fPruningMode == kPruneWorseThanBest)
+    return bound < fPruningBest;
+
+  return bound < log(fPruningFraction) + fPruningLogSum;
+}
+
+// ---------------------------------------------------------
+void KLFitter::Fitter::UpdatePruning() {
+  if (fPruningMode == kNoPruning)
+    return;
+
+  AddToPruning(fLikelihood->LogEventProbability(), &fPruningBest, &fPruningLogSum);
+}
+
+// ---------------------------------------------------------
+void KLFitter::Fitter::ResetPruning() {
+  fPruningBest = -std::numeric_limits<double>::infinity();
+  fPruningLogSum = -std::numeric_limits<double>::infinity();
+}
+
+// ---------------------------------------------------------
+std::vector<double> KLFitter::Fitter::WarmStartParameters(int index) {
+  std::vector<double> start = fLikelihood->GetInitialParameters();
+  if (!fWarmStart || fMinimizationMethod != kMinuit || fWarmStartIndices.empty())
+    return start;
+
+  const std::vector<int> energies = fLikelihood->PartonEnergyParameters();
+  if (energies.empty())
+    return start;
+
+  // find the permutation with the fewest partons in different
+  // positions; leptons and photons have to be the same
+  const std::vector<std::vector<int> >& table = *fPermutations->PermutationTable();
+  const std::vector<int>& current = table.at(index);
+  const int npartons = std::min(fParticlesPermuted->NPartons(), static_cast<int>(current.size()));
+  std::size_t nearest = fWarmStartIndices.size();
+  int mindistance = npartons + 1;
+  for (std::size_t i = 0; i < fWarmStartIndices.size(); ++i) {
+    const std::vector<int>& other = table.at(fWarmStartIndices[i]);
+    if (other.size() != current.size() || !std::equal(current.begin() + npartons, current.end(), other.begin() + npartons))
+      continue;
+    int distance = 0;
+    for (int iparton = 0; iparton < npartons; ++iparton) {
+      if (other[iparton] != current[iparton])
+        ++distance;
+    }
+    if (distance < mindistance) {
+      mindistance = distance;
+      nearest = i;
     }
+  }
+  if (nearest == fWarmStartIndices.size())
+    return start;
+
+  // take over the fitted parameters and move the parton energies
+  // with their jets
+  const std::vector<int>& other = table.at(fWarmStartIndices[nearest]);
+  const std::vector<double>& fitted = fWarmStartParameters[nearest];
+  std::vector<double> parameters = fitted;
+  const int nenergies = std::min(npartons, static_cast<int>(energies.size()));
+  for (int iparton = 0; iparton < nenergies; ++iparton) {
+    if (energies[iparton] < 0)
+      continue;
+    parameters[energies[iparton]] = start[energies[iparton]];
+    for (int jparton = 0; jparton < nenergies; ++jparton) {
+      if (other[jparton] == current[iparton] && energies[jparton] >= 0)
+        parameters[energies[iparton]] = fitted[energies[jparton]];
+    }
+  }
 
-    // caching parameters
-    fLikelihood->SetParametersToCache(index, nperms);
-    SetFitStatusToCache(index, nperms);
-  }  // end of fitting "else"
+  // the parameter ranges depend on the permutation
+  for (unsigned int ipar = 0; ipar < fLikelihood->GetNParameters(); ++ipar) {
+    const BCParameter * parameter = fLikelihood->GetParameter(ipar);
+    parameters[ipar] = std::max(parameter->GetLowerLimit(), std::min(parameter->GetUpperLimit(), parameters[ipar]));
+  }
 
-  // no error
-  return 1;
+  return parameters;
+}
+
+// ---------------------------------------------------------
+void KLFitter::Fitter::UpdateWarmStart(int index) {
+  if (!fWarmStart || fMinuitStatus != 0)
+    return;
+
+  fWarmStartIndices.push_back(index);
+  fWarmStartParameters.push_back(fLikelihood->GetBestFitParameters());
+}
+
+// ---------------------------------------------------------
+void KLFitter::Fitter::ResetWarmStart() {
+  fWarmStartIndices.clear();
+  fWarmStartParameters.clear();
 }
 
 // ---------------------------------------------------------
@@ -291,6 +799,7 @@ int KLFitter::Fitter::Fit() {
     fLikelihood->MCMCSetNIterationsRun(2000);
     fLikelihood->MCMCSetNIterationsMax(1000);
     fLikelihood->MCMCSetNIterationsUpdate(100);
+    std::lock_guard<std::mutex> lock(BATMutex());
     fLikelihood->MarginalizeAll();
     fLikelihood->FindMode(BCIntegrate::kOptMinuit, fLikelihood->GetBestFitParameters());
     fMinuitStatus = fLikelihood->GetMinuitErrorFlag();
@@ -300,6 +809,526 @@ int KLFitter::Fitter::Fit() {
   return 1;
 }
 
+// ---------------------------------------------------------
+int KLFitter::Fitter::FitCoarseToFine(unsigned int ntop, kRankingMode ranking) {
+  // check status
+  if (!Status())
+    return 0;
+
+  if (fMinimizationMethod != kMinuit) {
+    std::cout << "KLFitter::Fitter::FitCoarseToFine(). Only available if the first stage is Minuit." << std::endl;
+    return 0;
+  }
+
+  // coarse pass over all permutations; permutations with an
+  // LH-invariant partner are taken over in the fit of the partner
+  const int nperms = fPermutations->NPermutations();
+  std::vector<int> indices;
+  std::vector<int> ranked;
+  std::vector<double> rank(nperms, -std::numeric_limits<double>::infinity());
+  std::vector<CoarseToFineResult> results(nperms);
+  int dummy;
+  fCoarseFit = true;
+  for (int iperm = 0; iperm < nperms; ++iperm) {
+    int partner = fLikelihood->LHInvariantPermutationPartner(iperm, nperms, &dummy, &dummy);
+    if (partner > -1 && partner < iperm)
+      continue;
+
+    if (!Fit(iperm)) {
+      fCoarseFit = false;
+      return 0;
+    }
+
+    CoarseToFineResult& result = results[iperm];
+    result.minuitStatus = fMinuitStatus;
+    result.convergenceStatus = fConvergenceStatus | FitNotRefinedMask;
+    result.parameters = fLikelihood->GetBestFitParameters();
+    result.parameterErrors = fLikelihood->GetBestFitParameterErrors();
+    result.normalization = fLikelihood->GetIntegral();
+    indices.push_back(iperm);
+
+    // skipped permutations are never refined
+    if (fConvergenceStatus & PermutationSkippedMask)
+      continue;
+    if (ranking == kRankByLogLikelihood)
+      rank[iperm] = fResults[iperm].logLikelihood;
+    else
+      rank[iperm] = fResults[iperm].logEventProbability;
+    ranked.push_back(iperm);
+  }
+  fCoarseFit = false;
+
+  // refine the best permutations, starting from the coarse result
+  std::stable_sort(ranked.begin(), ranked.end(), [&rank](int a, int b) { return rank[a] > rank[b]; });
+  if (ranked.size() > ntop)
+    ranked.resize(ntop);
+  for (std::size_t i = 0; i < ranked.size(); ++i) {
+    // the permutations which are not refined within the budget keep
+    // the coarse result
+    if (BudgetUsed() >= 1.) {
+      ranked.resize(i);
+      break;
+    }
+    const int iperm = ranked[i];
+    if (!SetUpPermutation(iperm))
+      return 0;
+    Minimize(results[iperm].parameters);
+
+    CoarseToFineResult& result = results[iperm];
+    result.minuitStatus = fMinuitStatus;
+    result.convergenceStatus = fConvergenceStatus;
+    result.parameters = fLikelihood->GetBestFitParameters();
+    result.parameterErrors = fLikelihood->GetBestFitParameterErrors();
+    result.normalization = fLikelihood->BCIntegrate::GetIntegral();
+  }
+
+  // fill the caches in the order of the permutations, as the caches
+  // are reset with the first permutation
+  for (int iperm : indices) {
+    const CoarseToFineResult& result = results[iperm];
+    fLikelihood->SetParametersToCache(iperm, nperms, result.parameters, result.parameterErrors, result.normalization);
+    fMinuitStatus = result.minuitStatus;
+    fConvergenceStatus = result.convergenceStatus;
+    SetFitStatusToCache(iperm, nperms);
+  }
+
+  // update the results of the refined permutations and fill those of
+  // the LH-invariant partners
+  std::vector<bool> refined(nperms, false);
+  for (int iperm : ranked)
+    refined[iperm] = true;
+  for (int iperm = 0; iperm < nperms; ++iperm) {
+    int partner = fLikelihood->LHInvariantPermutationPartner(iperm, nperms, &dummy, &dummy);
+    if ((partner < 0 || partner > iperm) && !refined[iperm]) {
+      fResults[iperm].convergenceStatus |= FitNotRefinedMask;
+      continue;
+    }
+    if (!LoadPermutation(iperm))
+      return 0;
+    FillResult(iperm);
+  }
+
+  return LoadPermutation(0);
+}
+
+// ---------------------------------------------------------
+int KLFitter::Fitter::FitBatch(const std::vector<BatchEvent>& events, std::vector<EventResult>* results,
+                               const LikelihoodFactory& factory, unsigned int nthreads) {
+  if (!results) {
+    std::cout << "KLFitter::Fitter::FitBatch(). No result vector given." << std::endl;
+    return 0;
+  }
+
+  if (!factory) {
+    std::cout << "KLFitter::Fitter::FitBatch(). No likelihood factory given." << std::endl;
+    return 0;
+  }
+
+  // check detector
+  if (!fDetector) {
+    std::cout << "KLFitter::Fitter::FitBatch(). No detector defined." << std::endl;
+    return 0;
+  }
+  if (!fDetector->Status())
+    return 0;
+
+  results->clear();
+  results->resize(events.size());
+  if (events.empty())
+    return 1;
+
+  if (nthreads == 0)
+    nthreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  // set up the workers on the calling thread, the construction of
+  // BAT models is not thread safe
+  std::vector<std::unique_ptr<KLFitter::LikelihoodBase> > likelihoods;
+  std::vector<std::unique_ptr<KLFitter::Fitter> > workers;
+  for (unsigned int ithread = 0; ithread < nthreads; ++ithread) {
+    likelihoods.emplace_back(factory());
+    if (!likelihoods.back()) {
+      std::cout << "KLFitter::Fitter::FitBatch(). The likelihood factory returned no likelihood." << std::endl;
+      return 0;
+    }
+    workers.emplace_back(CreateWorker(likelihoods.back().get()));
+  }
+
+  auto run = [&workers](const std::function<void(unsigned int)>& work) {
+    std::vector<std::thread> threads;
+    for (unsigned int ithread = 1; ithread < workers.size(); ++ithread)
+      threads.emplace_back(work, ithread);
+    work(0);
+    for (auto& thread : threads)
+      thread.join();
+  };
+
+  // first pass: create the permutation tables of all events and
+  // find the permutations which need a fit, the others are taken
+  // over from their LH-invariant partner
+  std::vector<std::unique_ptr<KLFitter::Permutations> > tables(events.size());
+  std::vector<std::vector<int> > leading(events.size());
+  std::atomic<std::size_t> next_event(0);
+  run([&](unsigned int ithread) {
+    KLFitter::Fitter * worker = workers[ithread].get();
+    for (std::size_t ievent = next_event++; ievent < events.size(); ievent = next_event++) {
+      const BatchEvent& event = events[ievent];
+      if (!worker->SetParticles(event.particles, event.nPartonsInPermutations))
+        continue;
+      tables[ievent].reset(new KLFitter::Permutations(*worker->fPermutations));
+
+      const int nperms = tables[ievent]->NPermutations();
+      results->at(ievent).permutations.resize(nperms);
+      int dummy;
+      for (int iperm = 0; iperm < nperms; ++iperm) {
+        int partner = worker->fLikelihood->LHInvariantPermutationPartner(iperm, nperms, &dummy, &dummy);
+        if (partner < 0 || partner > iperm)
+          leading[ievent].push_back(iperm);
+      }
+    }
+  });
+
+  // second pass: split the events into blocks of permutations and
+  // distribute them in event order over the workers, each worker
+  // getting about the same number of fits. Idle workers steal from
+  // the back of the others' queues.
+  std::size_t nfits = 0;
+  for (const auto& indices : leading)
+    nfits += indices.size();
+  const std::size_t blocksize = std::max<std::size_t>(1, nfits / (nthreads * kBlocksPerWorker));
+
+  WorkStealingQueues queues(nthreads);
+  std::vector<BatchEventState> states(events.size());
+  std::size_t nqueued = 0;
+  for (std::size_t ievent = 0; ievent < events.size(); ++ievent) {
+    const std::vector<int>& indices = leading[ievent];
+    for (std::size_t first = 0; first < indices.size(); first += blocksize) {
+      BatchTask task;
+      task.event = ievent;
+      task.permutations.assign(indices.begin() + first, indices.begin() + std::min(first + blocksize, indices.size()));
+      queues.Push(nqueued * nthreads / nfits, task);
+      nqueued += task.permutations.size();
+      ++states[ievent].remainingTasks;
+    }
+  }
+
+  std::vector<std::atomic<bool> > failed(events.size());
+  run([&](unsigned int ithread) {
+    KLFitter::Fitter * worker = workers[ithread].get();
+    std::size_t current = events.size();
+    // the tables of the events the worker has left unfinished, so
+    // that they are copied only once per worker and event
+    std::map<std::size_t, std::unique_ptr<KLFitter::Permutations> > parked;
+    BatchTask task;
+    while (queues.Pop(ithread, &task)) {
+      const std::size_t ievent = task.event;
+      const int nperms = tables[ievent]->NPermutations();
+      BatchEventState& state = states[ievent];
+
+      // switch the worker to the event of the task
+      if (ievent != current) {
+        if (current < events.size() && states[current].remainingTasks > 0)
+          parked[current] = std::move(worker->fPermutations);
+        for (auto it = parked.begin(); it != parked.end();)
+          it = states[it->first].remainingTasks > 0 ? std::next(it) : parked.erase(it);
+        auto it = parked.find(ievent);
+        if (it != parked.end()) {
+          worker->fPermutations = std::move(it->second);
+          parked.erase(it);
+        } else {
+          worker->fPermutations.reset(new KLFitter::Permutations{&worker->fParticles, &worker->fParticlesPermuted});
+          worker->fPermutations->CopyTables(*tables[ievent]);
+        }
+        worker->fParticles = events[ievent].particles;
+        worker->fLikelihood->UpdateLHInvariantPermutationPartners();
+        worker->SetET_miss_XY_SumET(events[ievent].etmiss_x, events[ievent].etmiss_y, events[ievent].sumet);
+        worker->fLikelihood->InitCache(nperms);
+        worker->fCachedMinuitStatusVector.assign(nperms, -1);
+        worker->fCachedConvergenceStatusVector.assign(nperms, -1);
+        worker->ResetWarmStart();
+        worker->fResults.clear();
+        current = ievent;
+      }
+
+      std::vector<FitResult>& perms = results->at(ievent).permutations;
+      int dummy;
+      for (int iperm : task.permutations) {
+        // take over the budget, the pruning bounds and the warm-start
+        // points of the event
+        std::size_t nwarmstart;
+        {
+          std::lock_guard<std::mutex> lock(state.mutex);
+          if (!state.budgetStarted) {
+            state.budgetStarted = true;
+            state.budgetStart = std::chrono::steady_clock::now();
+          }
+          worker->fBudgetStarted = true;
+          worker->fBudgetStart = state.budgetStart;
+          worker->fBudgetStartEvaluations = worker->fLikelihood->NEvaluations() - state.evaluations;
+          worker->fPruningBest = state.pruningBest;
+          worker->fPruningLogSum = state.pruningLogSum;
+          for (std::size_t i = worker->fWarmStartIndices.size(); i < state.warmStartIndices.size(); ++i) {
+            worker->fWarmStartIndices.push_back(state.warmStartIndices[i]);
+            worker->fWarmStartParameters.push_back(state.warmStartParameters[i]);
+          }
+          nwarmstart = worker->fWarmStartIndices.size();
+        }
+        const long evaluations = worker->fLikelihood->NEvaluations();
+
+        // the LH-invariant partner is filled from the cache
+        int partner = worker->fLikelihood->LHInvariantPermutationPartner(iperm, nperms, &dummy, &dummy);
+        if (!worker->FitBatchPermutation(iperm, &perms.at(iperm)) ||
+            (partner > iperm && !worker->FitBatchPermutation(partner, &perms.at(partner)))) {
+          failed[ievent] = true;
+          break;
+        }
+
+        // merge the result into the state of the event
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.evaluations += worker->fLikelihood->NEvaluations() - evaluations;
+        if (worker->fPruningMode != kNoPruning && !(perms.at(iperm).convergenceStatus & PermutationSkippedMask))
+          AddToPruning(perms.at(iperm).logEventProbability, &state.pruningBest, &state.pruningLogSum);
+        for (std::size_t i = nwarmstart; i < worker->fWarmStartIndices.size(); ++i) {
+          state.warmStartIndices.push_back(worker->fWarmStartIndices[i]);
+          state.warmStartParameters.push_back(worker->fWarmStartParameters[i]);
+        }
+        worker->fWarmStartIndices.resize(nwarmstart);
+        worker->fWarmStartParameters.resize(nwarmstart);
+      }
+      --state.remainingTasks;
+    }
+  });
+
+  for (const auto& worker : workers)
+    AddStageStatistics(*worker);
+
+  for (std::size_t ievent = 0; ievent < events.size(); ++ievent) {
+    EventResult& result = results->at(ievent);
+    result.status = (tables[ievent] && !failed[ievent]) ? 1 : 0;
+    if (result.status == 0)
+      result.permutations.clear();
+  }
+
+  // no error
+  return 1;
+}
+
+// ---------------------------------------------------------
+int KLFitter::Fitter::FitBatch(const std::vector<BatchEvent>& events, std::vector<EventResult>* results,
+                               unsigned int nthreads) {
+  if (!fLikelihood) {
+    std::cout << "KLFitter::Fitter::FitBatch(). No likelihood defined." << std::endl;
+    return 0;
+  }
+
+  return FitBatch(events, results, [this]() { return fLikelihood->Clone(); }, nthreads);
+}
+
+// ---------------------------------------------------------
+int KLFitter::Fitter::FitBatchPermutation(int index, FitResult* result) {
+  if (!Fit(index))
+    return 0;
+
+  *result = fResults.at(index);
+
+  // no error
+  return 1;
+}
+
+// ---------------------------------------------------------
+int KLFitter::Fitter::FitParallel(const LikelihoodFactory& factory, unsigned int nthreads) {
+  if (!factory) {
+    std::cout << "KLFitter::Fitter::FitParallel(). No likelihood factory given." << std::endl;
+    return 0;
+  }
+
+  // check status
+  if (!Status())
+    return 0;
+
+  // collect the permutations which need a fit, the others are
+  // taken over from their LH-invariant partner
+  const int nperms = fPermutations->NPermutations();
+  std::vector<int> indices;
+  int dummy;
+  for (int iperm = 0; iperm < nperms; ++iperm) {
+    int partner = fLikelihood->LHInvariantPermutationPartner(iperm, nperms, &dummy, &dummy);
+    if (partner < 0 || partner > iperm)
+      indices.push_back(iperm);
+  }
+  if (indices.empty())
+    return 0;
+
+  if (nthreads == 0)
+    nthreads = std::max(std::thread::hardware_concurrency(), 1u);
+  nthreads = std::min(nthreads, static_cast<unsigned int>(indices.size()));
+
+  // set up the workers on the calling thread, the construction of
+  // BAT models is not thread safe
+  std::vector<std::unique_ptr<KLFitter::LikelihoodBase> > likelihoods;
+  std::vector<std::unique_ptr<KLFitter::Fitter> > workers;
+  for (unsigned int ithread = 0; ithread < nthreads; ++ithread) {
+    likelihoods.emplace_back(factory());
+    if (!likelihoods.back()) {
+      std::cout << "KLFitter::Fitter::FitParallel(). The likelihood factory returned no likelihood." << std::endl;
+      return 0;
+    }
+    workers.emplace_back(CreateWorker(likelihoods.back().get()));
+    KLFitter::Fitter * worker = workers.back().get();
+    worker->fParticles = fParticles;
+    worker->fPermutations->CopyTables(*fPermutations);
+    likelihoods.back()->UpdateLHInvariantPermutationPartners();
+    worker->SetET_miss_XY_SumET(ETmiss_x, ETmiss_y, SumET);
+    likelihoods.back()->InitCache(nperms);
+    worker->fCachedMinuitStatusVector.assign(nperms, -1);
+    worker->fCachedConvergenceStatusVector.assign(nperms, -1);
+  }
+
+  // the results are merged into the caches of this fitter; every
+  // permutation (and its partner) is written by exactly one worker
+  fLikelihood->InitCache(nperms);
+  fCachedMinuitStatusVector.assign(nperms, -1);
+  fCachedConvergenceStatusVector.assign(nperms, -1);
+  fResults.assign(nperms, FitResult());
+
+  // the workers share the budget of the event, which includes the
+  // fits of this fitter since SetParticles()
+  BatchEventState state;
+  BudgetUsed();
+  state.budgetStarted = fBudgetStarted;
+  state.budgetStart = fBudgetStart;
+  state.evaluations = fLikelihood->NEvaluations() - fBudgetStartEvaluations;
+
+  std::atomic<std::size_t> next_index(0);
+  std::atomic<int> err(1);
+  auto work = [this, &indices, &next_index, &err, &state, nperms](KLFitter::Fitter * worker) {
+    for (std::size_t i = next_index++; i < indices.size(); i = next_index++) {
+      const int iperm = indices[i];
+      long evaluations;
+      {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        worker->fBudgetStarted = state.budgetStarted;
+        worker->fBudgetStart = state.budgetStart;
+        evaluations = worker->fLikelihood->NEvaluations();
+        worker->fBudgetStartEvaluations = evaluations - state.evaluations;
+      }
+
+      // the partner is filled from the cache of the worker
+      int dummy;
+      int partner = worker->fLikelihood->LHInvariantPermutationPartner(iperm, nperms, &dummy, &dummy);
+      const bool fitted = worker->Fit(iperm) && (partner < 0 || worker->Fit(partner));
+      {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.evaluations += worker->fLikelihood->NEvaluations() - evaluations;
+      }
+      if (!fitted) {
+        err = 0;
+        continue;
+      }
+      for (int index : {iperm, partner}) {
+        if (index < 0)
+          continue;
+        fLikelihood->CopyCacheEntry(*worker->fLikelihood, index);
+        fCachedMinuitStatusVector.at(index) = worker->fCachedMinuitStatusVector.at(index);
+        fCachedConvergenceStatusVector.at(index) = worker->fCachedConvergenceStatusVector.at(index);
+        fResults.at(index) = worker->fResults.at(index);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int ithread = 1; ithread < nthreads; ++ithread)
+    threads.emplace_back(work, workers[ithread].get());
+  work(workers[0].get());
+  for (auto& thread : threads)
+    thread.join();
+
+  for (const auto& worker : workers)
+    AddStageStatistics(*worker);
+
+  // the evaluations of the workers count towards the budget of this
+  // fitter for further fits of the event
+  fBudgetStartEvaluations = fLikelihood->NEvaluations() - state.evaluations;
+
+  if (!err)
+    return 0;
+
+  return LoadPermutation(0);
+}
+
+// ---------------------------------------------------------
+int KLFitter::Fitter::FitParallel(unsigned int nthreads) {
+  if (!fLikelihood) {
+    std::cout << "KLFitter::Fitter::FitParallel(). No likelihood defined." << std::endl;
+    return 0;
+  }
+
+  return FitParallel([this]() { return fLikelihood->Clone(); }, nthreads);
+}
+
+// ---------------------------------------------------------
+int KLFitter::Fitter::LoadPermutation(int index) {
+  if (index < 0 || index >= static_cast<int>(fCachedMinuitStatusVector.size())) {
+    std::cout << "KLFitter::Fitter::LoadPermutation(). Permutation " << index << " has not been fitted." << std::endl;
+    return 0;
+  }
+
+  if (!SetUpPermutation(index))
+    return 0;
+
+  fLikelihood->GetParametersFromCache(index);
+  GetFitStatusFromCache(index);
+
+  // no error
+  return 1;
+}
+
+// ---------------------------------------------------------
+double KLFitter::Fitter::BudgetUsed() {
+  if (fBudgetTime <= 0 && fBudgetEvaluations <= 0)
+    return 0;
+
+  if (!fBudgetStarted) {
+    fBudgetStarted = true;
+    fBudgetStart = std::chrono::steady_clock::now();
+    fBudgetStartEvaluations = fLikelihood->NEvaluations();
+    return 0;
+  }
+
+  double used = 0;
+  if (fBudgetTime > 0) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - fBudgetStart;
+    used = std::max(used, elapsed.count() / fBudgetTime);
+  }
+  if (fBudgetEvaluations > 0)
+    used = std::max(used, static_cast<double>(fLikelihood->NEvaluations() - fBudgetStartEvaluations) / fBudgetEvaluations);
+
+  return used;
+}
+
+// ---------------------------------------------------------
+std::unique_ptr<KLFitter::Fitter> KLFitter::Fitter::CreateWorker(KLFitter::LikelihoodBase * likelihood) {
+  std::unique_ptr<KLFitter::Fitter> worker{new KLFitter::Fitter{}};
+  worker->SetDetector(fDetector);
+  worker->SetLikelihood(likelihood);
+  worker->fTurnOffSA = fTurnOffSA;
+  worker->fPermutationFirst = fPermutationFirst;
+  worker->fPermutationCount = fPermutationCount;
+  worker->fPermutations->SetIndexOnly(fPermutations->IndexOnly());
+  worker->fPermutationCacheSize = fPermutationCacheSize;
+  worker->SetMinimizationStages(fStages);
+  worker->fPruningMode = fPruningMode;
+  worker->fPruningFraction = fPruningFraction;
+  worker->fWarmStart = fWarmStart;
+  worker->fUseAnalyticGradient = fUseAnalyticGradient;
+  worker->fUseMinuit2 = fUseMinuit2;
+  worker->fResultDetail = fResultDetail;
+  worker->fBudgetTime = fBudgetTime;
+  worker->fBudgetEvaluations = fBudgetEvaluations;
+  worker->fCoarseMaxCalls = fCoarseMaxCalls;
+  worker->fCoarseTolerance = fCoarseTolerance;
+  return worker;
+}
+
 // ---------------------------------------------------------
 int KLFitter::Fitter::Status() {
   // check if measured particles exist
@@ -19,17 +19,99 @@
 
 #include "KLFitter/LikelihoodBase.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <string>
+#include <utility>
 
 #include "BAT/BCLog.h"
 #include "BAT/BCParameter.h"
 #include "KLFitter/DetectorBase.h"
 #include "KLFitter/Permutations.h"
 #include "KLFitter/PhysicsConstants.h"
+#include "Math/IFunction.h"
+#include "Minuit2/Minuit2Minimizer.h"
 #include "TRandom3.h"
 
+namespace {
+/**
+  * Translate the status of the Minuit2 minimizer into the MIGRAD
+  * error flag of TMinuit, which the Fitter tests: 0 if the minimum
+  * is valid, also if the covariance matrix had to be made positive
+  * definite (Minuit2 status 1), and 4 for an abnormal termination,
+  * which in TMinuit includes a failed Hesse calculation (2), an EDM
+  * above the tolerance (3), the call limit (4) and any other failure.
+  * @param status The status of the Minuit2 minimizer.
+  * @return The TMinuit error flag.
+  */
+int MinuitErrorFlag(int status) {
+  switch (status) {
+    case 0:
+    case 1:
+      return 0;
+    default:
+      return 4;
+  }
+}
+}  // namespace
+
+// ---------------------------------------------------------
+class KLFitter::LikelihoodBase::NegativeLogPosterior : public ROOT::Math::IMultiGenFunction {
+ public:
+  explicit NegativeLogPosterior(KLFitter::LikelihoodBase* likelihood) : fLikelihood(likelihood) { }
+
+  ROOT::Math::IMultiGenFunction* Clone() const override { return new NegativeLogPosterior(*this); }
+
+  unsigned int NDim() const override { return fLikelihood->GetNParameters(); }
+
+ private:
+  double DoEval(const double* x) const override {
+    const std::vector<double> parameters(x, x + NDim());
+    ++fLikelihood->fNEvaluations;
+    return -(fLikelihood->LogLikelihood(parameters) + fLikelihood->LogAPrioriProbability(parameters));
+  }
+
+  KLFitter::LikelihoodBase* fLikelihood;
+};
+
+// ---------------------------------------------------------
+class KLFitter::LikelihoodBase::NegativeLogPosteriorGradient : public ROOT::Math::IMultiGradFunction {
+ public:
+  explicit NegativeLogPosteriorGradient(KLFitter::LikelihoodBase* likelihood) : fLikelihood(likelihood) { }
+
+  ROOT::Math::IMultiGenFunction* Clone() const override { return new NegativeLogPosteriorGradient(*this); }
+
+  unsigned int NDim() const override { return fLikelihood->GetNParameters(); }
+
+  void Gradient(const double* x, double* gradient) const override {
+    const std::vector<double> parameters(x, x + NDim());
+    std::vector<double> grad;
+    ++fLikelihood->fNEvaluations;
+    fLikelihood->LogLikelihoodGradient(parameters, &grad);
+    for (std::size_t i = 0; i < grad.size(); ++i)
+      gradient[i] = -grad[i];
+  }
+
+ private:
+  double DoEval(const double* x) const override {
+    const std::vector<double> parameters(x, x + NDim());
+    ++fLikelihood->fNEvaluations;
+    return -(fLikelihood->LogLikelihood(parameters) + fLikelihood->LogAPrioriProbability(parameters));
+  }
+
+  double DoDerivative(const double* x, unsigned int icoord) const override {
+    std::vector<double> gradient(NDim());
+    Gradient(x, gradient.data());
+    return gradient[icoord];
+  }
+
+  KLFitter::LikelihoodBase* fLikelihood;
+};
+
 // ---------------------------------------------------------
 KLFitter::LikelihoodBase::LikelihoodBase(Particles** particles)
   : BCModel()
@@ -41,11 +123,37 @@ KLFitter::LikelihoodBase::LikelihoodBase(Particles** particles)
   , fFlagIsNan(false)
   , fFlagUseJetMass(false)
   , fTFgood(true)
+  , fNEvaluations(0)
   , fBTagMethod(kNotag) {
   BCLog::SetLogLevel(BCLog::nothing);
   MCMCSetRandomSeed(123456789);
 }
 
+// ---------------------------------------------------------
+KLFitter::LikelihoodBase::LikelihoodBase(const LikelihoodBase& other)
+  : BCModel()
+  , fParticlesPermuted(0)
+  , fPermutations(0)
+  , fParticlesModel(new KLFitter::Particles(*other.fParticlesModel))
+  , fDetector(0)
+  , fEventProbability(std::vector<double>(0))
+  , fFlagIntegrate(0)
+  , fFlagIsNan(false)
+  , fFlagUseJetMass(false)
+  , fTFgood(true)
+  , fNEvaluations(0)
+  , fBTagMethod(kNotag) {
+  MCMCSetRandomSeed(123456789);
+
+  // rebuild the parameters, the ranges are taken over below
+  for (unsigned int i = 0; i < other.GetNParameters(); ++i) {
+    const BCParameter * par = other.GetParameter(i);
+    AddParameter(par->GetName().c_str(), par->GetLowerLimit(), par->GetUpperLimit());
+  }
+
+  CopyConfiguration(other);
+}
+
 // ---------------------------------------------------------
 KLFitter::LikelihoodBase::~LikelihoodBase() {
   // Clear the parameters container in the BCModel to circumvent
@@ -53,6 +161,36 @@ KLFitter::LikelihoodBase::~LikelihoodBase() {
   ClearParameters(true);
 }
 
+// ---------------------------------------------------------
+std::unique_ptr<KLFitter::LikelihoodBase> KLFitter::LikelihoodBase::Clone() const {
+  std::cout << "KLFitter::LikelihoodBase::Clone(). Cloning is not supported by this likelihood." << std::endl;
+  return std::unique_ptr<KLFitter::LikelihoodBase>();
+}
+
+// ---------------------------------------------------------
+int KLFitter::LikelihoodBase::CopyConfiguration(const LikelihoodBase& other) {
+  // check number of parameters
+  if (GetNParameters() != other.GetNParameters()) {
+    std::cout << "KLFitter::LikelihoodBase::CopyConfiguration(). Number of parameters does not match." << std::endl;
+    return 0;
+  }
+
+  fPhysicsConstants = other.fPhysicsConstants;
+  fDetector = other.fDetector;
+  fFlagIntegrate = other.fFlagIntegrate;
+  fFlagUseJetMass = other.fFlagUseJetMass;
+  fBTagMethod = other.fBTagMethod;
+  fLHInvariances = other.fLHInvariances;
+
+  for (unsigned int i = 0; i < GetNParameters(); ++i) {
+    GetParameter(i)->SetLowerLimit(other.GetParameter(i)->GetLowerLimit());
+    GetParameter(i)->SetUpperLimit(other.GetParameter(i)->GetUpperLimit());
+  }
+
+  // no error
+  return 1;
+}
+
 // ---------------------------------------------------------
 int KLFitter::LikelihoodBase::SetPhysicsConstants(KLFitter::PhysicsConstants* physicsconstants) {
   fPhysicsConstants = *physicsconstants;
@@ -191,8 +329,84 @@ int KLFitter::LikelihoodBase::Initialize() {
   return err;
 }
 
+// ---------------------------------------------------------
+double KLFitter::LikelihoodBase::LogEval(const std::vector<double> & parameters) {
+  ++fNEvaluations;
+  return BCModel::LogEval(parameters);
+}
+
+// ---------------------------------------------------------
+double KLFitter::LikelihoodBase::LogLikelihoodGradient(const std::vector<double>& parameters, std::vector<double>* gradient) {
+  const double loglikelihood = LogLikelihood(parameters);
+
+  gradient->assign(parameters.size(), 0.);
+  std::vector<double> shifted(parameters);
+  for (std::size_t i = 0; i < parameters.size(); ++i) {
+    const double h = 1e-6 * std::max(std::fabs(parameters[i]), 1.);
+    shifted[i] = parameters[i] + h;
+    const double up = LogLikelihood(shifted);
+    shifted[i] = parameters[i] - h;
+    const double down = LogLikelihood(shifted);
+    shifted[i] = parameters[i];
+    (*gradient)[i] = (up - down) / (2. * h);
+  }
+
+  // restore the state of the likelihood at the parameters
+  LogLikelihood(parameters);
+
+  return loglikelihood;
+}
+
+// ---------------------------------------------------------
+int KLFitter::LikelihoodBase::FindModeMinuit2(std::vector<double> start, bool gradient) {
+  const int npar = GetNParameters();
+  if (start.empty())
+    start = GetInitialParameters();
+  if (static_cast<int>(start.size()) != npar) {
+    std::cout << "KLFitter::LikelihoodBase::FindModeMinuit2(). Number of starting values does not match the number of parameters." << std::endl;
+    return 0;
+  }
+
+  ROOT::Minuit2::Minuit2Minimizer minimizer(ROOT::Minuit2::kMigrad);
+  minimizer.SetPrintLevel(0);
+  minimizer.SetMaxFunctionCalls(static_cast<unsigned int>(fMinuitArglist[0]));
+  minimizer.SetTolerance(fMinuitArglist[1]);
+
+  // the error definition of a negative log likelihood
+  minimizer.SetErrorDef(0.5);
+
+  // the minimizer may only keep a reference to the function
+  NegativeLogPosterior function(this);
+  NegativeLogPosteriorGradient gradientfunction(this);
+  if (gradient)
+    minimizer.SetFunction(gradientfunction);
+  else
+    minimizer.SetFunction(function);
+
+  for (int i = 0; i < npar; ++i) {
+    const BCParameter* par = GetParameter(i);
+    minimizer.SetLimitedVariable(i, par->GetName(), start[i], (par->GetUpperLimit() - par->GetLowerLimit()) / 100.,
+                                 par->GetLowerLimit(), par->GetUpperLimit());
+  }
+
+  minimizer.Minimize();
+  fMinuitErrorFlag = MinuitErrorFlag(minimizer.Status());
+
+  fBestFitParameters.assign(minimizer.X(), minimizer.X() + npar);
+  fBestFitParameterErrors.assign(minimizer.Errors(), minimizer.Errors() + npar);
+
+  // no error
+  return 1;
+}
+
 // ---------------------------------------------------------
 double KLFitter::LikelihoodBase::LogEventProbability() {
+  // the likelihood at the mode is not needed with integration
+  return LogEventProbability(fFlagIntegrate ? 0. : LogLikelihood(GetBestFitParameters()));
+}
+
+// ---------------------------------------------------------
+double KLFitter::LikelihoodBase::LogEventProbability(double loglikelihood) {
   double logprob = 0;
 
   if (fBTagMethod != kNotag) {
@@ -205,7 +419,7 @@ double KLFitter::LikelihoodBase::LogEventProbability() {
   if (fFlagIntegrate) {
     logprob += log(GetIntegral());
   } else {
-    logprob += LogLikelihood(GetBestFitParameters());
+    logprob += loglikelihood;
   }
 
   return logprob;
@@ -313,6 +527,23 @@ double KLFitter::LikelihoodBase::LogEventProbabilityBTag() {
   return logprob;
 }
 
+// ---------------------------------------------------------
+double KLFitter::LikelihoodBase::LogEventProbabilityUpperBound() {
+  // the integral is not bounded by the maximum of the likelihood
+  if (fFlagIntegrate)
+    return std::numeric_limits<double>::infinity();
+
+  double logprob = 0;
+
+  if (fBTagMethod != kNotag) {
+    double logprobbtag = LogEventProbabilityBTag();
+    if (logprobbtag <= -1e99) return -1e99;
+    logprob += logprobbtag;
+  }
+
+  return logprob + LogLikelihoodUpperBound();
+}
+
 // ---------------------------------------------------------
 bool KLFitter::LikelihoodBase::NoTFProblem(std::vector<double> parameters) {
   fTFgood = true;
@@ -320,6 +551,13 @@ bool KLFitter::LikelihoodBase::NoTFProblem(std::vector<double> parameters) {
   return fTFgood;
 }
 
+// ---------------------------------------------------------
+bool KLFitter::LikelihoodBase::NoTFProblem(const std::vector<double>& parameters, double * loglikelihood) {
+  fTFgood = true;
+  *loglikelihood = this->LogLikelihood(parameters);
+  return fTFgood;
+}
+
 // ---------------------------------------------------------
 void KLFitter::LikelihoodBase::PropagateBTaggingInformation() {
   // get number of partons
@@ -360,102 +598,121 @@ std::vector <double> KLFitter::LikelihoodBase::GetBestFitParameterErrors() {
 
 // ---------------------------------------------------------
 int KLFitter::LikelihoodBase::RemoveForbiddenParticlePermutations() {
-  // error code
-  int err = 1;
-
-  // only in b-tagging type kVetoNoFit
-  if (!((fBTagMethod == kVetoNoFit) || (fBTagMethod == kVetoNoFitLight) || (fBTagMethod == kVetoNoFitBoth || (fBTagMethod == kVetoHybridNoFit))))
-    return err;
+  // only in the veto b-tagging methods
+  if (!BTaggingVetoesPermutations())
+    return 1;
 
-  // remove all permutations where a b-tagged jet is in the position of a model light quark
   KLFitter::Particles * particles = (*fPermutations)->Particles();
-  int nPartons = particles->NPartons();
-
-  // When using kVetoHybridNoFit, copy the Permutations object and try to run
-  // with the kVetoNoFit option. If all permutations are vetoed, use the backup
-  // Permutations object and run with the kVetoNoFitLight option.
-  int nPartonsModel = fParticlesModel->NPartons();
-  if (fBTagMethod == kVetoHybridNoFit) {
-    KLFitter::Permutations permutationsCopy(**fPermutations);
-    for (int iParton(0); iParton < nPartons; ++iParton) {
-      bool isBtagged = particles->IsBTagged(iParton);
-
-      for (int iPartonModel(0); iPartonModel < nPartonsModel; ++iPartonModel) {
-        KLFitter::Particles::TrueFlavorType trueFlavor = fParticlesModel->TrueFlavor(iPartonModel);
-        if ((!isBtagged)||(trueFlavor != KLFitter::Particles::kLight)) continue;
-        err *= (*fPermutations)->RemoveParticlePermutations(KLFitter::Particles::kParton, iParton, iPartonModel);
-      }
-    }
-
-    if ((*fPermutations)->NPermutations() != 0) {
-      return err;
-    } else {
-      **fPermutations = permutationsCopy;
-    }
+  const std::vector<std::vector<int> >& table = *(*fPermutations)->PermutationTable();
+  const int nPartonsModel = fParticlesModel->NPartons();
+  const int nLeptons = particles->NElectrons() + particles->NMuons() + particles->NPhotons();
+  if (nPartonsModel > 64) {
+    std::cout << "KLFitter::LikelihoodBase::RemoveForbiddenParticlePermutations(). The b-tagging vetoes are only available for up to 64 model partons, not " << nPartonsModel << "." << std::endl;
+    return 0;
   }
 
-  for (int iParton(0); iParton < nPartons; ++iParton) {
-    bool isBtagged = particles->IsBTagged(iParton);
-
-    for (int iPartonModel(0); iPartonModel < nPartonsModel; ++iPartonModel) {
-      KLFitter::Particles::TrueFlavorType trueFlavor = fParticlesModel->TrueFlavor(iPartonModel);
-      if ((fBTagMethod == kVetoHybridNoFit)&&((isBtagged) || (trueFlavor != KLFitter::Particles::kB)))
-        continue;
-      if ((fBTagMethod == kVetoNoFit)&&((!isBtagged) || (trueFlavor != KLFitter::Particles::kLight)))
-        continue;
-      if ((fBTagMethod == kVetoNoFitLight)&&((isBtagged) || (trueFlavor != KLFitter::Particles::kB)))
-        continue;
-      if ((fBTagMethod == kVetoNoFitBoth)&&(((isBtagged)&&(trueFlavor != KLFitter::Particles::kLight)) || ((!isBtagged)&&(trueFlavor != KLFitter::Particles::kB))))
-        continue;
+  // bitmasks of the positions of the model light quarks and b quarks
+  std::uint64_t lightPositions = 0;
+  std::uint64_t bPositions = 0;
+  for (int iPartonModel(0); iPartonModel < nPartonsModel; ++iPartonModel) {
+    KLFitter::Particles::TrueFlavorType trueFlavor = fParticlesModel->TrueFlavor(iPartonModel);
+    if (trueFlavor == KLFitter::Particles::kLight)
+      lightPositions |= std::uint64_t(1) << iPartonModel;
+    else if (trueFlavor == KLFitter::Particles::kB)
+      bPositions |= std::uint64_t(1) << iPartonModel;
+  }
 
-      err *= (*fPermutations)->RemoveParticlePermutations(KLFitter::Particles::kParton, iParton, iPartonModel);
+  std::vector<bool> isBtagged(particles->NPartons());
+  for (int iParton(0); iParton < particles->NPartons(); ++iParton)
+    isBtagged[iParton] = particles->IsBTagged(iParton);
+
+  // flag the permutations with a b-tagged jet in the position of a
+  // model light quark and those with an untagged jet in the position
+  // of a model b quark in a single sweep
+  std::vector<bool> btagAsLight(table.size(), false);
+  std::vector<bool> untaggedAsB(table.size(), false);
+  std::size_t nBtagAsLight = 0;
+  for (std::size_t iPerm = 0; iPerm < table.size(); ++iPerm) {
+    const std::vector<int>& permutation = table[iPerm];
+    const int nPositions = std::min(nPartonsModel, static_cast<int>(permutation.size()) - nLeptons);
+    std::uint64_t btagPositions = 0;
+    for (int iPartonModel(0); iPartonModel < nPositions; ++iPartonModel) {
+      if (isBtagged[permutation[iPartonModel]])
+        btagPositions |= std::uint64_t(1) << iPartonModel;
     }
+    std::uint64_t positions = nPositions > 0 ? (~std::uint64_t(0) >> (64 - nPositions)) : 0;
+    btagAsLight[iPerm] = (btagPositions & lightPositions) != 0;
+    untaggedAsB[iPerm] = (~btagPositions & positions & bPositions) != 0;
+    if (btagAsLight[iPerm])
+      ++nBtagAsLight;
   }
 
-  // return error code
-  return err;
+  // kVetoHybridNoFit applies the veto of kVetoNoFit, unless it
+  // removes all permutations, and the veto of kVetoNoFitLight then
+  std::vector<bool> remove(table.size(), false);
+  for (std::size_t iPerm = 0; iPerm < table.size(); ++iPerm) {
+    if (fBTagMethod == kVetoNoFit)
+      remove[iPerm] = btagAsLight[iPerm];
+    else if (fBTagMethod == kVetoNoFitLight)
+      remove[iPerm] = untaggedAsB[iPerm];
+    else if (fBTagMethod == kVetoNoFitBoth)
+      remove[iPerm] = btagAsLight[iPerm] || untaggedAsB[iPerm];
+    else if (fBTagMethod == kVetoHybridNoFit)
+      remove[iPerm] = nBtagAsLight < table.size() ? btagAsLight[iPerm] : untaggedAsB[iPerm];
+  }
+
+  return (*fPermutations)->RemovePermutations(remove);
+}
+
+// ---------------------------------------------------------
+bool KLFitter::LikelihoodBase::BTaggingVetoesPermutations() {
+  return (fBTagMethod == kVetoNoFit) || (fBTagMethod == kVetoNoFitLight) || (fBTagMethod == kVetoNoFitBoth) || (fBTagMethod == kVetoHybridNoFit);
 }
 
 // ---------------------------------------------------------
 int KLFitter::LikelihoodBase::SetParametersToCache(int iperm, int nperms) {
+  return SetParametersToCache(iperm, nperms, BCModel::GetBestFitParameters(), BCModel::GetBestFitParameterErrors(),
+                              BCIntegrate::GetIntegral());
+}
+
+// ---------------------------------------------------------
+int KLFitter::LikelihoodBase::SetParametersToCache(int iperm, int nperms, const std::vector<double>& parameters,
+                                                   const std::vector<double>& errors, double normalization) {
   // set correct size of cachevector
   if (iperm == 0) {
-    fCachedParametersVector.clear();
-    fCachedParametersVector.assign(nperms, std::vector<double>(NParameters(), 0));
-
-    fCachedParameterErrorsVector.clear();
-    fCachedParameterErrorsVector.assign(nperms, std::vector<double>(NParameters(), 0));
-
-    fCachedNormalizationVector.clear();
-    fCachedNormalizationVector.assign(nperms, 0.);
+    InitCache(nperms);
   }
 
   if ((iperm > static_cast<int>(fCachedParametersVector.size())) || (iperm > static_cast<int>(fCachedParameterErrorsVector.size()))) {
     std::cout << "KLFitter::LikelihoodBase::SetParametersToCache: iperm > size of fCachedParametersVector or fCachedParameterErrorsVector!" << std::endl;
     return 0;
   }
-  fCachedParametersVector.at(iperm) = BCModel::GetBestFitParameters();
-  fCachedParameterErrorsVector.at(iperm) = BCModel::GetBestFitParameterErrors();
-  fCachedNormalizationVector.at(iperm) = BCIntegrate::GetIntegral();
+  fCachedParametersVector.at(iperm) = parameters;
+  fCachedParameterErrorsVector.at(iperm) = errors;
+  fCachedNormalizationVector.at(iperm) = normalization;
 
   int switchpar1 = -1;
   int switchpar2 = -1;
-  double switchcache = 0;
   int partner = LHInvariantPermutationPartner(iperm, nperms, &switchpar1, &switchpar2);
 
+  // the exchanged parameters of a declared invariance, or the pair
+  // given by a likelihood which overrides LHInvariantPermutationPartner()
+  std::vector<std::pair<int, int> > switchpars;
+  if ((iperm < static_cast<int>(fLHInvariantExchanges.size())) && (fLHInvariantExchanges.at(iperm) >= 0))
+    switchpars = fLHInvariances.at(fLHInvariantExchanges.at(iperm)).parameters;
+  else
+    switchpars.emplace_back(switchpar1, switchpar2);
+
   if (partner > iperm) {
     if ((static_cast<int>(fCachedParametersVector.size()) > partner) && (static_cast<int>(fCachedParameterErrorsVector.size()) > partner)) {
-      fCachedParametersVector.at(partner) = BCModel::GetBestFitParameters();
-      switchcache = fCachedParametersVector.at(partner).at(switchpar1);
-      fCachedParametersVector.at(partner).at(switchpar1) = fCachedParametersVector.at(partner).at(switchpar2);
-      fCachedParametersVector.at(partner).at(switchpar2) = switchcache;
-
-      fCachedParameterErrorsVector.at(partner) = BCModel::GetBestFitParameterErrors();
-      switchcache = fCachedParameterErrorsVector.at(partner).at(switchpar1);
-      fCachedParameterErrorsVector.at(partner).at(switchpar1) = fCachedParameterErrorsVector.at(partner).at(switchpar2);
-      fCachedParameterErrorsVector.at(partner).at(switchpar2) = switchcache;
+      fCachedParametersVector.at(partner) = parameters;
+      fCachedParameterErrorsVector.at(partner) = errors;
+      for (const auto& switchpar : switchpars) {
+        std::swap(fCachedParametersVector.at(partner).at(switchpar.first), fCachedParametersVector.at(partner).at(switchpar.second));
+        std::swap(fCachedParameterErrorsVector.at(partner).at(switchpar.first), fCachedParameterErrorsVector.at(partner).at(switchpar.second));
+      }
 
-      fCachedNormalizationVector.at(partner) = BCIntegrate::GetIntegral();
+      fCachedNormalizationVector.at(partner) = normalization;
     } else {
       std::cout << "KLFitter::LikelihoodBase::SetParametersToCache: size of fCachedParametersVector too small!" << std::endl;
     }
@@ -465,6 +722,119 @@ int KLFitter::LikelihoodBase::SetParametersToCache(int iperm, int nperms) {
   return 1;
 }
 
+// ---------------------------------------------------------
+void KLFitter::LikelihoodBase::AddLHInvariance(KLFitter::Particles::ParticleType ptype, int position1, int position2,
+                                               const std::vector<std::pair<int, int> >& parameters) {
+  LHInvariance invariance;
+  invariance.ptype = ptype;
+  invariance.position1 = position1;
+  invariance.position2 = position2;
+  invariance.parameters = parameters;
+  fLHInvariances.push_back(invariance);
+}
+
+// ---------------------------------------------------------
+int KLFitter::LikelihoodBase::LHInvariantPermutationPartner(int iperm, int nperms, int *switchpar1, int *switchpar2) {
+  if ((nperms != static_cast<int>(fLHInvariantPartners.size())) || (iperm < 0) || (iperm >= nperms))
+    return -1;
+
+  const int partner = fLHInvariantPartners.at(iperm);
+  if (partner < 0)
+    return -1;
+
+  const std::vector<std::pair<int, int> >& parameters = fLHInvariances.at(fLHInvariantExchanges.at(iperm)).parameters;
+  *switchpar1 = parameters.empty() ? -1 : parameters.front().first;
+  *switchpar2 = parameters.empty() ? -1 : parameters.front().second;
+  return partner;
+}
+
+// ---------------------------------------------------------
+int KLFitter::LikelihoodBase::UpdateLHInvariantPermutationPartners() {
+  fLHInvariantPartners.clear();
+  fLHInvariantExchanges.clear();
+  if (fLHInvariances.empty() || !fPermutations || !(*fPermutations) || !(*fPermutations)->Particles())
+    return 1;
+
+  // find the permutations by their indices
+  const std::vector<std::vector<int> >& table = *(*fPermutations)->PermutationTable();
+  std::map<std::vector<int>, int> indices;
+  for (std::size_t iperm = 0; iperm < table.size(); ++iperm)
+    indices.emplace(table[iperm], iperm);
+
+  KLFitter::Particles* particles = (*fPermutations)->Particles();
+  const int nelectrons = particles->NElectrons();
+  const int nmuons = particles->NMuons();
+  const int nphotons = particles->NPhotons();
+
+  fLHInvariantPartners.assign(table.size(), -1);
+  fLHInvariantExchanges.assign(table.size(), -1);
+  for (std::size_t iperm = 0; iperm < table.size(); ++iperm) {
+    // the positions of each particle type in the permutation, as in
+    // Permutations::CreatePermutations()
+    const int npartons = static_cast<int>(table[iperm].size()) - nelectrons - nmuons - nphotons;
+    for (std::size_t iinv = 0; iinv < fLHInvariances.size(); ++iinv) {
+      const LHInvariance& invariance = fLHInvariances[iinv];
+      int offset = 0;
+      int size = npartons;
+      if (invariance.ptype == KLFitter::Particles::kElectron) {
+        offset = npartons;
+        size = nelectrons;
+      } else if (invariance.ptype == KLFitter::Particles::kMuon) {
+        offset = npartons + nelectrons;
+        size = nmuons;
+      } else if (invariance.ptype == KLFitter::Particles::kPhoton) {
+        offset = npartons + nelectrons + nmuons;
+        size = nphotons;
+      }
+      if ((invariance.position1 < 0) || (invariance.position1 >= size) || (invariance.position2 < 0) || (invariance.position2 >= size))
+        continue;
+
+      std::vector<int> exchanged = table[iperm];
+      std::swap(exchanged[offset + invariance.position1], exchanged[offset + invariance.position2]);
+      auto partner = indices.find(exchanged);
+      if ((partner == indices.end()) || (partner->second == static_cast<int>(iperm)))
+        continue;
+
+      fLHInvariantPartners[iperm] = partner->second;
+      fLHInvariantExchanges[iperm] = iinv;
+      break;
+    }
+  }
+
+  // no error
+  return 1;
+}
+
+// ---------------------------------------------------------
+int KLFitter::LikelihoodBase::InitCache(int nperms) {
+  // the entries are overwritten in place, so that the storage of the
+  // previous event is re-used
+  fCachedParametersVector.resize(nperms);
+  for (auto& parameters : fCachedParametersVector)
+    parameters.assign(NParameters(), 0);
+
+  fCachedParameterErrorsVector.resize(nperms);
+  for (auto& errors : fCachedParameterErrorsVector)
+    errors.assign(NParameters(), 0);
+
+  fCachedNormalizationVector.assign(nperms, 0.);
+
+  return 1;
+}
+
+// ---------------------------------------------------------
+int KLFitter::LikelihoodBase::CopyCacheEntry(const KLFitter::LikelihoodBase& other, int iperm) {
+  if ((iperm >= static_cast<int>(fCachedParametersVector.size())) || (iperm >= static_cast<int>(other.fCachedParametersVector.size()))) {
+    std::cout << "KLFitter::LikelihoodBase::CopyCacheEntry: iperm >= size of fCachedParametersVector!" << std::endl;
+    return 0;
+  }
+  fCachedParametersVector.at(iperm) = other.fCachedParametersVector.at(iperm);
+  fCachedParameterErrorsVector.at(iperm) = other.fCachedParameterErrorsVector.at(iperm);
+  fCachedNormalizationVector.at(iperm) = other.fCachedNormalizationVector.at(iperm);
+
+  return 1;
+}
+
 // ---------------------------------------------------------
 int KLFitter::LikelihoodBase::GetParametersFromCache(int iperm) {
   if ((static_cast<int>(fCachedParametersVector.size()) > iperm) && (static_cast<int>(fCachedParameterErrorsVector.size()) > iperm)) {
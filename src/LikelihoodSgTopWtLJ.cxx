@@ -22,9 +22,9 @@
 #include <cmath>
 #include <iostream>
 
-#include "BAT/BCMath.h"
 #include "BAT/BCParameter.h"
 #include "KLFitter/DetectorBase.h"
+#include "KLFitter/Dual.h"
 #include "KLFitter/Particles.h"
 #include "KLFitter/Permutations.h"
 #include "KLFitter/PhysicsConstants.h"
@@ -143,90 +143,157 @@ void KLFitter::LikelihoodSgTopWtLJ::DefineParameters() {
 }
 
 // ---------------------------------------------------------
-int KLFitter::LikelihoodSgTopWtLJ::CalculateLorentzVectors(const std::vector <double>& parameters) {
-  // variables
-  static double scale;
-
-  static double whad_fit_e;
-  static double whad_fit_px;
-  static double whad_fit_py;
-  static double whad_fit_pz;
-  static double wlep_fit_e;
-  static double wlep_fit_px;
-  static double wlep_fit_py;
-  static double wlep_fit_pz;
-  static double thad_fit_e;
-  static double thad_fit_px;
-  static double thad_fit_py;
-  static double thad_fit_pz;
-  static double tlep_fit_e;
-  static double tlep_fit_px;
-  static double tlep_fit_py;
-  static double tlep_fit_pz;
+template <typename T>
+struct KLFitter::LikelihoodSgTopWtLJ::Kinematics {
+  T b_e;
+  T b_px;
+  T b_py;
+  T b_pz;
+
+  T lq1_e;
+  T lq1_px;
+  T lq1_py;
+  T lq1_pz;
+
+  T lq2_e;
+  T lq2_px;
+  T lq2_py;
+  T lq2_pz;
+
+  T lep_e;
+  T lep_px;
+  T lep_py;
+  T lep_pz;
+
+  T nu_e;
+  T nu_px;
+  T nu_py;
+  T nu_pz;
+
+  T whad_m;
+  T wlep_m;
+  T thad_m;
+  T tlep_m;
+};
+
+// ---------------------------------------------------------
+template <typename T>
+void KLFitter::LikelihoodSgTopWtLJ::CalculateKinematics(const std::vector<T>& parameters, Kinematics<T>* fit) const {
+  T scale;
+  T whad_e;
+  T whad_px;
+  T whad_py;
+  T whad_pz;
+  T wlep_e;
+  T wlep_px;
+  T wlep_py;
+  T wlep_pz;
+  T thad_e;
+  T thad_px;
+  T thad_py;
+  T thad_pz;
+  T tlep_e;
+  T tlep_px;
+  T tlep_py;
+  T tlep_pz;
 
   // b quark
-  b_fit_e = parameters[parBE];
-  scale = sqrt(b_fit_e*b_fit_e - b_meas_m*b_meas_m) / b_meas_p;
-  b_fit_px = scale * b_meas_px;
-  b_fit_py = scale * b_meas_py;
-  b_fit_pz = scale * b_meas_pz;
+  fit->b_e = parameters[parBE];
+  scale = sqrt(fit->b_e*fit->b_e - b_meas_m*b_meas_m) / b_meas_p;
+  fit->b_px = scale * b_meas_px;
+  fit->b_py = scale * b_meas_py;
+  fit->b_pz = scale * b_meas_pz;
 
   // light quark 1
-  lq1_fit_e = parameters[parLQ1E];
-  scale = sqrt(lq1_fit_e*lq1_fit_e - lq1_meas_m*lq1_meas_m) / lq1_meas_p;
-  lq1_fit_px = scale * lq1_meas_px;
-  lq1_fit_py = scale * lq1_meas_py;
-  lq1_fit_pz = scale * lq1_meas_pz;
+  fit->lq1_e = parameters[parLQ1E];
+  scale = sqrt(fit->lq1_e*fit->lq1_e - lq1_meas_m*lq1_meas_m) / lq1_meas_p;
+  fit->lq1_px = scale * lq1_meas_px;
+  fit->lq1_py = scale * lq1_meas_py;
+  fit->lq1_pz = scale * lq1_meas_pz;
 
   // light quark 2
-  lq2_fit_e = parameters[parLQ2E];
-  scale = sqrt(lq2_fit_e*lq2_fit_e - lq2_meas_m*lq2_meas_m) / lq2_meas_p;
-  lq2_fit_px  = scale * lq2_meas_px;
-  lq2_fit_py  = scale * lq2_meas_py;
-  lq2_fit_pz  = scale * lq2_meas_pz;
+  fit->lq2_e = parameters[parLQ2E];
+  scale = sqrt(fit->lq2_e*fit->lq2_e - lq2_meas_m*lq2_meas_m) / lq2_meas_p;
+  fit->lq2_px = scale * lq2_meas_px;
+  fit->lq2_py = scale * lq2_meas_py;
+  fit->lq2_pz = scale * lq2_meas_pz;
 
   // lepton
-  lep_fit_e = parameters[parLepE];
-  scale = lep_fit_e / lep_meas_e;
-  lep_fit_px = scale * lep_meas_px;
-  lep_fit_py = scale * lep_meas_py;
-  lep_fit_pz = scale * lep_meas_pz;
+  fit->lep_e = parameters[parLepE];
+  scale = fit->lep_e / lep_meas_e;
+  fit->lep_px = scale * lep_meas_px;
+  fit->lep_py = scale * lep_meas_py;
+  fit->lep_pz = scale * lep_meas_pz;
 
   // neutrino
-  nu_fit_px = parameters[parNuPx];
-  nu_fit_py = parameters[parNuPy];
-  nu_fit_pz = parameters[parNuPz];
-  nu_fit_e  = sqrt(nu_fit_px*nu_fit_px + nu_fit_py*nu_fit_py + nu_fit_pz*nu_fit_pz);
-
-  // composite particles
+  fit->nu_px = parameters[parNuPx];
+  fit->nu_py = parameters[parNuPy];
+  fit->nu_pz = parameters[parNuPz];
+  fit->nu_e  = sqrt(fit->nu_px*fit->nu_px + fit->nu_py*fit->nu_py + fit->nu_pz*fit->nu_pz);
 
   // hadronic W
-  whad_fit_e  = lq1_fit_e +lq2_fit_e;
-  whad_fit_px = lq1_fit_px+lq2_fit_px;
-  whad_fit_py = lq1_fit_py+lq2_fit_py;
-  whad_fit_pz = lq1_fit_pz+lq2_fit_pz;
-  whad_fit_m = sqrt(whad_fit_e*whad_fit_e - (whad_fit_px*whad_fit_px + whad_fit_py*whad_fit_py + whad_fit_pz*whad_fit_pz));
+  whad_e = fit->lq1_e + fit->lq2_e;
+  whad_px = fit->lq1_px + fit->lq2_px;
+  whad_py = fit->lq1_py + fit->lq2_py;
+  whad_pz = fit->lq1_pz + fit->lq2_pz;
+  fit->whad_m = sqrt(whad_e*whad_e - (whad_px*whad_px + whad_py*whad_py + whad_pz*whad_pz));
 
   // leptonic W
-  wlep_fit_e  = lep_fit_e +nu_fit_e;
-  wlep_fit_px = lep_fit_px+nu_fit_px;
-  wlep_fit_py = lep_fit_py+nu_fit_py;
-  wlep_fit_pz = lep_fit_pz+nu_fit_pz;
-  wlep_fit_m = sqrt(wlep_fit_e*wlep_fit_e - (wlep_fit_px*wlep_fit_px + wlep_fit_py*wlep_fit_py + wlep_fit_pz*wlep_fit_pz));
+  wlep_e = fit->lep_e + fit->nu_e;
+  wlep_px = fit->lep_px + fit->nu_px;
+  wlep_py = fit->lep_py + fit->nu_py;
+  wlep_pz = fit->lep_pz + fit->nu_pz;
+  fit->wlep_m = sqrt(wlep_e*wlep_e - (wlep_px*wlep_px + wlep_py*wlep_py + wlep_pz*wlep_pz));
 
   // hadronic top
-  thad_fit_e  = whad_fit_e+b_fit_e;
-  thad_fit_px = whad_fit_px+b_fit_px;
-  thad_fit_py = whad_fit_py+b_fit_py;
-  thad_fit_pz = whad_fit_pz+b_fit_pz;
-  thad_fit_m = sqrt(thad_fit_e*thad_fit_e - (thad_fit_px*thad_fit_px + thad_fit_py*thad_fit_py + thad_fit_pz*thad_fit_pz));
+  thad_e = whad_e + fit->b_e;
+  thad_px = whad_px + fit->b_px;
+  thad_py = whad_py + fit->b_py;
+  thad_pz = whad_pz + fit->b_pz;
+  fit->thad_m = sqrt(thad_e*thad_e - (thad_px*thad_px + thad_py*thad_py + thad_pz*thad_pz));
 
   // leptonic top
-  tlep_fit_e = wlep_fit_e+b_fit_e;
-  tlep_fit_px = wlep_fit_px+b_fit_px;
-  tlep_fit_py = wlep_fit_py+b_fit_py;
-  tlep_fit_pz = wlep_fit_pz+b_fit_pz;
-  tlep_fit_m = sqrt(tlep_fit_e*tlep_fit_e - (tlep_fit_px*tlep_fit_px + tlep_fit_py*tlep_fit_py + tlep_fit_pz*tlep_fit_pz));
+  tlep_e = wlep_e + fit->b_e;
+  tlep_px = wlep_px + fit->b_px;
+  tlep_py = wlep_py + fit->b_py;
+  tlep_pz = wlep_pz + fit->b_pz;
+  fit->tlep_m = sqrt(tlep_e*tlep_e - (tlep_px*tlep_px + tlep_py*tlep_py + tlep_pz*tlep_pz));
+}
+
+// ---------------------------------------------------------
+int KLFitter::LikelihoodSgTopWtLJ::CalculateLorentzVectors(const std::vector <double>& parameters) {
+  Kinematics<double> fit;
+  CalculateKinematics(parameters, &fit);
+
+  b_fit_e = fit.b_e;
+  b_fit_px = fit.b_px;
+  b_fit_py = fit.b_py;
+  b_fit_pz = fit.b_pz;
+
+  lq1_fit_e = fit.lq1_e;
+  lq1_fit_px = fit.lq1_px;
+  lq1_fit_py = fit.lq1_py;
+  lq1_fit_pz = fit.lq1_pz;
+
+  lq2_fit_e = fit.lq2_e;
+  lq2_fit_px = fit.lq2_px;
+  lq2_fit_py = fit.lq2_py;
+  lq2_fit_pz = fit.lq2_pz;
+
+  lep_fit_e = fit.lep_e;
+  lep_fit_px = fit.lep_px;
+  lep_fit_py = fit.lep_py;
+  lep_fit_pz = fit.lep_pz;
+
+  nu_fit_e = fit.nu_e;
+  nu_fit_px = fit.nu_px;
+  nu_fit_py = fit.nu_py;
+  nu_fit_pz = fit.nu_pz;
+
+  whad_fit_m = fit.whad_m;
+  wlep_fit_m = fit.wlep_m;
+  thad_fit_m = fit.thad_m;
+  tlep_fit_m = fit.tlep_m;
 
   // no error
   return 1;
@@ -338,36 +405,38 @@ int KLFitter::LikelihoodSgTopWtLJ::AdjustParameterRanges() {
 }
 
 // ---------------------------------------------------------
-double KLFitter::LikelihoodSgTopWtLJ::LogLikelihood(const std::vector<double> & parameters) {
+template <typename T>
+T KLFitter::LikelihoodSgTopWtLJ::LogLikelihoodTemplate(const std::vector<T>& parameters) {
   // calculate 4-vectors
-  this->CalculateLorentzVectors(parameters);
+  Kinematics<T> fit;
+  CalculateKinematics(parameters, &fit);
 
   // define log of likelihood
-  double logprob(0.);
+  T logprob(0.);
 
   // temporary flag for a safe use of the transfer functions
   bool TFgoodTmp(true);
 
   // jet energy resolution terms
-  logprob += log(fResEnergyB->p(b_fit_e, b_meas_e, &TFgoodTmp));
+  logprob += fResEnergyB->LogP(fit.b_e, b_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
-  logprob += log(fResEnergyLQ1->p(lq1_fit_e, lq1_meas_e, &TFgoodTmp));
+  logprob += fResEnergyLQ1->LogP(fit.lq1_e, lq1_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
-  logprob += log(fResEnergyLQ2->p(lq2_fit_e, lq2_meas_e, &TFgoodTmp));
+  logprob += fResEnergyLQ2->LogP(fit.lq2_e, lq2_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
   // lepton energy resolution terms
   if (fTypeLepton == kElectron) {
-    logprob += log(fResLepton->p(lep_fit_e, lep_meas_e, &TFgoodTmp));
+    logprob += fResLepton->LogP(fit.lep_e, lep_meas_e, &TFgoodTmp);
   } else if (fTypeLepton == kMuon) {
-    logprob += log(fResLepton->p(lep_fit_e* lep_meas_sintheta, lep_meas_pt, &TFgoodTmp));
+    logprob += fResLepton->LogP(fit.lep_e* lep_meas_sintheta, lep_meas_pt, &TFgoodTmp);
   }
   if (!TFgoodTmp) fTFgood = false;
 
   // neutrino px and py
-  logprob += log(fResMET->p(nu_fit_px, ETmiss_x, &TFgoodTmp, SumET));
+  logprob += fResMET->LogP(fit.nu_px, ETmiss_x, &TFgoodTmp, SumET);
   if (!TFgoodTmp) fTFgood = false;
-  logprob += log(fResMET->p(nu_fit_py, ETmiss_y, &TFgoodTmp, SumET));
+  logprob += fResMET->LogP(fit.nu_py, ETmiss_y, &TFgoodTmp, SumET);
   if (!TFgoodTmp) fTFgood = false;
 
   // physics constants
@@ -377,21 +446,39 @@ double KLFitter::LikelihoodSgTopWtLJ::LogLikelihood(const std::vector<double> &
   double gammaTop = fPhysicsConstants.GammaTop();
 
   // Breit-Wigner of hadronically decaying W-boson
-  logprob += BCMath::LogBreitWignerRel(whad_fit_m, massW, gammaW);
+  logprob += LogBreitWignerRel<T>(fit.whad_m, massW, gammaW);
 
   // Breit-Wigner of leptonically decaying W-boson
-  logprob += BCMath::LogBreitWignerRel(wlep_fit_m, massW, gammaW);
+  logprob += LogBreitWignerRel<T>(fit.wlep_m, massW, gammaW);
 
   if (fHadronicTop) {
-    logprob += BCMath::LogBreitWignerRel(thad_fit_m, massTop, gammaTop);
+    logprob += LogBreitWignerRel<T>(fit.thad_m, massTop, gammaTop);
   } else {
-    logprob += BCMath::LogBreitWignerRel(tlep_fit_m, massTop, gammaTop);
+    logprob += LogBreitWignerRel<T>(fit.tlep_m, massTop, gammaTop);
   }
 
   // return log of likelihood
   return logprob;
 }
 
+// ---------------------------------------------------------
+double KLFitter::LikelihoodSgTopWtLJ::LogLikelihood(const std::vector<double> & parameters) {
+  return LogLikelihoodTemplate(parameters);
+}
+
+// ---------------------------------------------------------
+double KLFitter::LikelihoodSgTopWtLJ::LogLikelihoodGradient(const std::vector<double> & parameters, std::vector<double>* gradient) {
+  // the dual numbers have a component for each parameter
+  if (parameters.size() > parNuPz + 1) {
+    std::cout << "KLFitter::LikelihoodSgTopWtLJ::LogLikelihoodGradient(). More parameters than dual number components." << std::endl;
+    return LikelihoodBase::LogLikelihoodGradient(parameters, gradient);
+  }
+
+  return EvaluateGradient<parNuPz + 1>([this](const std::vector<Dual<parNuPz + 1> >& dual) {
+    return LogLikelihoodTemplate(dual);
+  }, parameters, gradient);
+}
+
 // ---------------------------------------------------------
 std::vector<double> KLFitter::LikelihoodSgTopWtLJ::GetInitialParameters() {
   std::vector<double> values(GetNParameters());
@@ -25,6 +25,7 @@
 #include "BAT/BCMath.h"
 #include "BAT/BCParameter.h"
 #include "KLFitter/DetectorBase.h"
+#include "KLFitter/Dual.h"
 #include "KLFitter/Particles.h"
 #include "KLFitter/Permutations.h"
 #include "KLFitter/PhysicsConstants.h"
@@ -50,6 +51,11 @@ KLFitter::LikelihoodTTHLeptonJets::LikelihoodTTHLeptonJets()
 // ---------------------------------------------------------
 KLFitter::LikelihoodTTHLeptonJets::~LikelihoodTTHLeptonJets() = default;
 
+// ---------------------------------------------------------
+std::unique_ptr<KLFitter::LikelihoodBase> KLFitter::LikelihoodTTHLeptonJets::Clone() const {
+  return std::unique_ptr<KLFitter::LikelihoodBase>(new KLFitter::LikelihoodTTHLeptonJets(*this));
+}
+
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTTHLeptonJets::SetET_miss_XY_SumET(double etx, double ety, double sumet) {
   // set missing ET x and y component and the SumET
@@ -188,118 +194,221 @@ void KLFitter::LikelihoodTTHLeptonJets::DefineParameters() {
 }
 
 // ---------------------------------------------------------
-int KLFitter::LikelihoodTTHLeptonJets::CalculateLorentzVectors(std::vector <double> const& parameters) {
-  static double scale;
-  static double whad_fit_e;
-  static double whad_fit_px;
-  static double whad_fit_py;
-  static double whad_fit_pz;
-  static double wlep_fit_e;
-  static double wlep_fit_px;
-  static double wlep_fit_py;
-  static double wlep_fit_pz;
-  static double thad_fit_e;
-  static double thad_fit_px;
-  static double thad_fit_py;
-  static double thad_fit_pz;
-  static double tlep_fit_e;
-  static double tlep_fit_px;
-  static double tlep_fit_py;
-  static double tlep_fit_pz;
-  static double Higgs_fit_e;
-  static double Higgs_fit_px;
-  static double Higgs_fit_py;
-  static double Higgs_fit_pz;
+template <typename T>
+struct KLFitter::LikelihoodTTHLeptonJets::Kinematics {
+  T bhad_e;
+  T bhad_px;
+  T bhad_py;
+  T bhad_pz;
+
+  T blep_e;
+  T blep_px;
+  T blep_py;
+  T blep_pz;
+
+  T lq1_e;
+  T lq1_px;
+  T lq1_py;
+  T lq1_pz;
+
+  T lq2_e;
+  T lq2_px;
+  T lq2_py;
+  T lq2_pz;
+
+  T BHiggs1_e;
+  T BHiggs1_px;
+  T BHiggs1_py;
+  T BHiggs1_pz;
+
+  T BHiggs2_e;
+  T BHiggs2_px;
+  T BHiggs2_py;
+  T BHiggs2_pz;
+
+  T lep_e;
+  T lep_px;
+  T lep_py;
+  T lep_pz;
+
+  T nu_e;
+  T nu_px;
+  T nu_py;
+  T nu_pz;
+
+  T whad_m;
+  T wlep_m;
+  T thad_m;
+  T tlep_m;
+  T Higgs_m;
+};
+
+// ---------------------------------------------------------
+template <typename T>
+void KLFitter::LikelihoodTTHLeptonJets::CalculateKinematics(const std::vector<T>& parameters, Kinematics<T>* fit) const {
+  T scale;
+  T whad_e;
+  T whad_px;
+  T whad_py;
+  T whad_pz;
+  T wlep_e;
+  T wlep_px;
+  T wlep_py;
+  T wlep_pz;
+  T thad_e;
+  T thad_px;
+  T thad_py;
+  T thad_pz;
+  T tlep_e;
+  T tlep_px;
+  T tlep_py;
+  T tlep_pz;
+  T Higgs_e;
+  T Higgs_px;
+  T Higgs_py;
+  T Higgs_pz;
 
   // hadronic b quark
-  bhad_fit_e = parameters[parBhadE];
-  scale = sqrt(bhad_fit_e*bhad_fit_e - bhad_meas_m*bhad_meas_m) / bhad_meas_p;
-  bhad_fit_px = scale * bhad_meas_px;
-  bhad_fit_py = scale * bhad_meas_py;
-  bhad_fit_pz = scale * bhad_meas_pz;
+  fit->bhad_e = parameters[parBhadE];
+  scale = sqrt(fit->bhad_e*fit->bhad_e - bhad_meas_m*bhad_meas_m) / bhad_meas_p;
+  fit->bhad_px = scale * bhad_meas_px;
+  fit->bhad_py = scale * bhad_meas_py;
+  fit->bhad_pz = scale * bhad_meas_pz;
 
   // leptonic b quark
-  blep_fit_e = parameters[parBlepE];
-  scale = sqrt(blep_fit_e*blep_fit_e - blep_meas_m*blep_meas_m) / blep_meas_p;
-  blep_fit_px = scale * blep_meas_px;
-  blep_fit_py = scale * blep_meas_py;
-  blep_fit_pz = scale * blep_meas_pz;
+  fit->blep_e = parameters[parBlepE];
+  scale = sqrt(fit->blep_e*fit->blep_e - blep_meas_m*blep_meas_m) / blep_meas_p;
+  fit->blep_px = scale * blep_meas_px;
+  fit->blep_py = scale * blep_meas_py;
+  fit->blep_pz = scale * blep_meas_pz;
 
   // light quark 1
-  lq1_fit_e = parameters[parLQ1E];
-  scale = sqrt(lq1_fit_e*lq1_fit_e - lq1_meas_m*lq1_meas_m) / lq1_meas_p;
-  lq1_fit_px = scale * lq1_meas_px;
-  lq1_fit_py = scale * lq1_meas_py;
-  lq1_fit_pz = scale * lq1_meas_pz;
+  fit->lq1_e = parameters[parLQ1E];
+  scale = sqrt(fit->lq1_e*fit->lq1_e - lq1_meas_m*lq1_meas_m) / lq1_meas_p;
+  fit->lq1_px = scale * lq1_meas_px;
+  fit->lq1_py = scale * lq1_meas_py;
+  fit->lq1_pz = scale * lq1_meas_pz;
 
   // light quark 2
-  lq2_fit_e = parameters[parLQ2E];
-  scale = sqrt(lq2_fit_e*lq2_fit_e - lq2_meas_m*lq2_meas_m) / lq2_meas_p;
-  lq2_fit_px  = scale * lq2_meas_px;
-  lq2_fit_py  = scale * lq2_meas_py;
-  lq2_fit_pz  = scale * lq2_meas_pz;
+  fit->lq2_e = parameters[parLQ2E];
+  scale = sqrt(fit->lq2_e*fit->lq2_e - lq2_meas_m*lq2_meas_m) / lq2_meas_p;
+  fit->lq2_px = scale * lq2_meas_px;
+  fit->lq2_py = scale * lq2_meas_py;
+  fit->lq2_pz = scale * lq2_meas_pz;
 
   // Higgs b quark 1
-  BHiggs1_fit_e = parameters[parBHiggs1E];
-  scale = sqrt(BHiggs1_fit_e*BHiggs1_fit_e - BHiggs1_meas_m*BHiggs1_meas_m) / BHiggs1_meas_p;
-  BHiggs1_fit_px = scale * BHiggs1_meas_px;
-  BHiggs1_fit_py = scale * BHiggs1_meas_py;
-  BHiggs1_fit_pz = scale * BHiggs1_meas_pz;
+  fit->BHiggs1_e = parameters[parBHiggs1E];
+  scale = sqrt(fit->BHiggs1_e*fit->BHiggs1_e - BHiggs1_meas_m*BHiggs1_meas_m) / BHiggs1_meas_p;
+  fit->BHiggs1_px = scale * BHiggs1_meas_px;
+  fit->BHiggs1_py = scale * BHiggs1_meas_py;
+  fit->BHiggs1_pz = scale * BHiggs1_meas_pz;
 
   // Higgs b quark 2
-  BHiggs2_fit_e = parameters[parBHiggs2E];
-  scale = sqrt(BHiggs2_fit_e*BHiggs2_fit_e - BHiggs2_meas_m*BHiggs2_meas_m) / BHiggs2_meas_p;
-  BHiggs2_fit_px = scale * BHiggs2_meas_px;
-  BHiggs2_fit_py = scale * BHiggs2_meas_py;
-  BHiggs2_fit_pz = scale * BHiggs2_meas_pz;
+  fit->BHiggs2_e = parameters[parBHiggs2E];
+  scale = sqrt(fit->BHiggs2_e*fit->BHiggs2_e - BHiggs2_meas_m*BHiggs2_meas_m) / BHiggs2_meas_p;
+  fit->BHiggs2_px = scale * BHiggs2_meas_px;
+  fit->BHiggs2_py = scale * BHiggs2_meas_py;
+  fit->BHiggs2_pz = scale * BHiggs2_meas_pz;
 
   // lepton
-  lep_fit_e = parameters[parLepE];
-  scale = lep_fit_e / lep_meas_e;
-  lep_fit_px = scale * lep_meas_px;
-  lep_fit_py = scale * lep_meas_py;
-  lep_fit_pz = scale * lep_meas_pz;
+  fit->lep_e = parameters[parLepE];
+  scale = fit->lep_e / lep_meas_e;
+  fit->lep_px = scale * lep_meas_px;
+  fit->lep_py = scale * lep_meas_py;
+  fit->lep_pz = scale * lep_meas_pz;
 
   // neutrino
-  nu_fit_px = parameters[parNuPx];
-  nu_fit_py = parameters[parNuPy];
-  nu_fit_pz = parameters[parNuPz];
-  nu_fit_e  = sqrt(nu_fit_px*nu_fit_px + nu_fit_py*nu_fit_py + nu_fit_pz*nu_fit_pz);
+  fit->nu_px = parameters[parNuPx];
+  fit->nu_py = parameters[parNuPy];
+  fit->nu_pz = parameters[parNuPz];
+  fit->nu_e  = sqrt(fit->nu_px*fit->nu_px + fit->nu_py*fit->nu_py + fit->nu_pz*fit->nu_pz);
 
   // hadronic W
-  whad_fit_e  = lq1_fit_e +lq2_fit_e;
-  whad_fit_px = lq1_fit_px+lq2_fit_px;
-  whad_fit_py = lq1_fit_py+lq2_fit_py;
-  whad_fit_pz = lq1_fit_pz+lq2_fit_pz;
-  whad_fit_m = sqrt(whad_fit_e*whad_fit_e - (whad_fit_px*whad_fit_px + whad_fit_py*whad_fit_py + whad_fit_pz*whad_fit_pz));
+  whad_e = fit->lq1_e + fit->lq2_e;
+  whad_px = fit->lq1_px + fit->lq2_px;
+  whad_py = fit->lq1_py + fit->lq2_py;
+  whad_pz = fit->lq1_pz + fit->lq2_pz;
+  fit->whad_m = sqrt(whad_e*whad_e - (whad_px*whad_px + whad_py*whad_py + whad_pz*whad_pz));
 
   // leptonic W
-  wlep_fit_e  = lep_fit_e +nu_fit_e;
-  wlep_fit_px = lep_fit_px+nu_fit_px;
-  wlep_fit_py = lep_fit_py+nu_fit_py;
-  wlep_fit_pz = lep_fit_pz+nu_fit_pz;
-  wlep_fit_m = sqrt(wlep_fit_e*wlep_fit_e - (wlep_fit_px*wlep_fit_px + wlep_fit_py*wlep_fit_py + wlep_fit_pz*wlep_fit_pz));
+  wlep_e = fit->lep_e + fit->nu_e;
+  wlep_px = fit->lep_px + fit->nu_px;
+  wlep_py = fit->lep_py + fit->nu_py;
+  wlep_pz = fit->lep_pz + fit->nu_pz;
+  fit->wlep_m = sqrt(wlep_e*wlep_e - (wlep_px*wlep_px + wlep_py*wlep_py + wlep_pz*wlep_pz));
 
   // hadronic top
-  thad_fit_e = whad_fit_e+bhad_fit_e;
-  thad_fit_px = whad_fit_px+bhad_fit_px;
-  thad_fit_py = whad_fit_py+bhad_fit_py;
-  thad_fit_pz = whad_fit_pz+bhad_fit_pz;
-  thad_fit_m = sqrt(thad_fit_e*thad_fit_e - (thad_fit_px*thad_fit_px + thad_fit_py*thad_fit_py + thad_fit_pz*thad_fit_pz));
+  thad_e = whad_e + fit->bhad_e;
+  thad_px = whad_px + fit->bhad_px;
+  thad_py = whad_py + fit->bhad_py;
+  thad_pz = whad_pz + fit->bhad_pz;
+  fit->thad_m = sqrt(thad_e*thad_e - (thad_px*thad_px + thad_py*thad_py + thad_pz*thad_pz));
 
   // leptonic top
-  tlep_fit_e = wlep_fit_e+blep_fit_e;
-  tlep_fit_px = wlep_fit_px+blep_fit_px;
-  tlep_fit_py = wlep_fit_py+blep_fit_py;
-  tlep_fit_pz = wlep_fit_pz+blep_fit_pz;
-  tlep_fit_m = sqrt(tlep_fit_e*tlep_fit_e - (tlep_fit_px*tlep_fit_px + tlep_fit_py*tlep_fit_py + tlep_fit_pz*tlep_fit_pz));
+  tlep_e = wlep_e + fit->blep_e;
+  tlep_px = wlep_px + fit->blep_px;
+  tlep_py = wlep_py + fit->blep_py;
+  tlep_pz = wlep_pz + fit->blep_pz;
+  fit->tlep_m = sqrt(tlep_e*tlep_e - (tlep_px*tlep_px + tlep_py*tlep_py + tlep_pz*tlep_pz));
 
   // Higgs
-  Higgs_fit_e  = BHiggs1_fit_e  + BHiggs2_fit_e;
-  Higgs_fit_px = BHiggs1_fit_px + BHiggs2_fit_px;
-  Higgs_fit_py = BHiggs1_fit_py + BHiggs2_fit_py;
-  Higgs_fit_pz = BHiggs1_fit_pz + BHiggs2_fit_pz;
-  Higgs_fit_m  = sqrt(Higgs_fit_e*Higgs_fit_e - (Higgs_fit_px*Higgs_fit_px + Higgs_fit_py*Higgs_fit_py + Higgs_fit_pz*Higgs_fit_pz));
+  Higgs_e = fit->BHiggs1_e + fit->BHiggs2_e;
+  Higgs_px = fit->BHiggs1_px + fit->BHiggs2_px;
+  Higgs_py = fit->BHiggs1_py + fit->BHiggs2_py;
+  Higgs_pz = fit->BHiggs1_pz + fit->BHiggs2_pz;
+  fit->Higgs_m = sqrt(Higgs_e*Higgs_e - (Higgs_px*Higgs_px + Higgs_py*Higgs_py + Higgs_pz*Higgs_pz));
+}
+
+// ---------------------------------------------------------
+int KLFitter::LikelihoodTTHLeptonJets::CalculateLorentzVectors(std::vector <double> const& parameters) {
+  Kinematics<double> fit;
+  CalculateKinematics(parameters, &fit);
+
+  bhad_fit_e = fit.bhad_e;
+  bhad_fit_px = fit.bhad_px;
+  bhad_fit_py = fit.bhad_py;
+  bhad_fit_pz = fit.bhad_pz;
+
+  blep_fit_e = fit.blep_e;
+  blep_fit_px = fit.blep_px;
+  blep_fit_py = fit.blep_py;
+  blep_fit_pz = fit.blep_pz;
+
+  lq1_fit_e = fit.lq1_e;
+  lq1_fit_px = fit.lq1_px;
+  lq1_fit_py = fit.lq1_py;
+  lq1_fit_pz = fit.lq1_pz;
+
+  lq2_fit_e = fit.lq2_e;
+  lq2_fit_px = fit.lq2_px;
+  lq2_fit_py = fit.lq2_py;
+  lq2_fit_pz = fit.lq2_pz;
+
+  BHiggs1_fit_e = fit.BHiggs1_e;
+  BHiggs1_fit_px = fit.BHiggs1_px;
+  BHiggs1_fit_py = fit.BHiggs1_py;
+  BHiggs1_fit_pz = fit.BHiggs1_pz;
+
+  BHiggs2_fit_e = fit.BHiggs2_e;
+  BHiggs2_fit_px = fit.BHiggs2_px;
+  BHiggs2_fit_py = fit.BHiggs2_py;
+  BHiggs2_fit_pz = fit.BHiggs2_pz;
+
+  lep_fit_e = fit.lep_e;
+  lep_fit_px = fit.lep_px;
+  lep_fit_py = fit.lep_py;
+  lep_fit_pz = fit.lep_pz;
+
+  nu_fit_e = fit.nu_e;
+  nu_fit_px = fit.nu_px;
+  nu_fit_py = fit.nu_py;
+  nu_fit_pz = fit.nu_pz;
+
+  whad_fit_m = fit.whad_m;
+  wlep_fit_m = fit.wlep_m;
+  thad_fit_m = fit.thad_m;
+  tlep_fit_m = fit.tlep_m;
+  Higgs_fit_m = fit.Higgs_m;
 
   // no error
   return 1;
@@ -436,48 +545,50 @@ int KLFitter::LikelihoodTTHLeptonJets::AdjustParameterRanges() {
 }
 
 // ---------------------------------------------------------
-double KLFitter::LikelihoodTTHLeptonJets::LogLikelihood(const std::vector<double> & parameters) {
+template <typename T>
+T KLFitter::LikelihoodTTHLeptonJets::LogLikelihoodTemplate(const std::vector<T>& parameters) {
   // calculate 4-vectors
-  CalculateLorentzVectors(parameters);
+  Kinematics<T> fit;
+  CalculateKinematics(parameters, &fit);
 
   // define log of likelihood
-  double logprob(0.);
+  T logprob(0.);
 
   // temporary flag for a safe use of the transfer functions
   bool TFgoodTmp(true);
 
   // jet energy resolution terms
-  logprob += log(fResEnergyBhad->p(bhad_fit_e, bhad_meas_e, &TFgoodTmp));
+  logprob += fResEnergyBhad->LogP(fit.bhad_e, bhad_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyBlep->p(blep_fit_e, blep_meas_e, &TFgoodTmp));
+  logprob += fResEnergyBlep->LogP(fit.blep_e, blep_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyLQ1->p(lq1_fit_e, lq1_meas_e, &TFgoodTmp));
+  logprob += fResEnergyLQ1->LogP(fit.lq1_e, lq1_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyLQ2->p(lq2_fit_e, lq2_meas_e, &TFgoodTmp));
+  logprob += fResEnergyLQ2->LogP(fit.lq2_e, lq2_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyBHiggs1->p(BHiggs1_fit_e, BHiggs1_meas_e, &TFgoodTmp));
+  logprob += fResEnergyBHiggs1->LogP(fit.BHiggs1_e, BHiggs1_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyBHiggs2->p(BHiggs2_fit_e, BHiggs2_meas_e, &TFgoodTmp));
+  logprob += fResEnergyBHiggs2->LogP(fit.BHiggs2_e, BHiggs2_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
   // lepton energy resolution terms
   if (fTypeLepton == kElectron) {
-    logprob += log(fResLepton->p(lep_fit_e, lep_meas_e, &TFgoodTmp));
+    logprob += fResLepton->LogP(fit.lep_e, lep_meas_e, &TFgoodTmp);
   } else if (fTypeLepton == kMuon) {
-    logprob += log(fResLepton->p(lep_fit_e* lep_meas_sintheta, lep_meas_pt, &TFgoodTmp));
+    logprob += fResLepton->LogP(fit.lep_e* lep_meas_sintheta, lep_meas_pt, &TFgoodTmp);
   }
   if (!TFgoodTmp) fTFgood = false;
 
   // neutrino px and py
-  logprob += log(fResMET->p(nu_fit_px, ETmiss_x, &TFgoodTmp, SumET));
+  logprob += fResMET->LogP(fit.nu_px, ETmiss_x, &TFgoodTmp, SumET);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResMET->p(nu_fit_py, ETmiss_y, &TFgoodTmp, SumET));
+  logprob += fResMET->LogP(fit.nu_py, ETmiss_y, &TFgoodTmp, SumET);
   if (!TFgoodTmp) fTFgood = false;
 
   // physics constants
@@ -487,24 +598,42 @@ double KLFitter::LikelihoodTTHLeptonJets::LogLikelihood(const std::vector<double
   double gammaHiggs = fPhysicsConstants.GammaHiggs();
 
   // Breit-Wigner of hadronically decaying W-boson
-  logprob += BCMath::LogBreitWignerRel(whad_fit_m, massW, gammaW);
+  logprob += LogBreitWignerRel<T>(fit.whad_m, massW, gammaW);
 
   // Breit-Wigner of leptonically decaying W-boson
-  logprob += BCMath::LogBreitWignerRel(wlep_fit_m, massW, gammaW);
+  logprob += LogBreitWignerRel<T>(fit.wlep_m, massW, gammaW);
 
   // Breit-Wigner of hadronically decaying top quark
-  logprob += BCMath::LogBreitWignerRel(thad_fit_m, parameters[parTopM], gammaTop);
+  logprob += LogBreitWignerRel<T>(fit.thad_m, parameters[parTopM], gammaTop);
 
   // Breit-Wigner of leptonically decaying top quark
-  logprob += BCMath::LogBreitWignerRel(tlep_fit_m, parameters[parTopM], gammaTop);
+  logprob += LogBreitWignerRel<T>(fit.tlep_m, parameters[parTopM], gammaTop);
 
   // Breit-Wigner of Higgs decaying into 2 b-quark
-  if (fFlagHiggsMassFixed) logprob += BCMath::LogBreitWignerRel(Higgs_fit_m, parameters[parHiggsM], gammaHiggs);
+  if (fFlagHiggsMassFixed) logprob += LogBreitWignerRel<T>(fit.Higgs_m, parameters[parHiggsM], gammaHiggs);
 
   // return log of likelihood
   return logprob;
 }
 
+// ---------------------------------------------------------
+double KLFitter::LikelihoodTTHLeptonJets::LogLikelihood(const std::vector<double> & parameters) {
+  return LogLikelihoodTemplate(parameters);
+}
+
+// ---------------------------------------------------------
+double KLFitter::LikelihoodTTHLeptonJets::LogLikelihoodGradient(const std::vector<double> & parameters, std::vector<double>* gradient) {
+  // the dual numbers have a component for each parameter
+  if (parameters.size() > parHiggsM + 1) {
+    std::cout << "KLFitter::LikelihoodTTHLeptonJets::LogLikelihoodGradient(). More parameters than dual number components." << std::endl;
+    return LikelihoodBase::LogLikelihoodGradient(parameters, gradient);
+  }
+
+  return EvaluateGradient<parHiggsM + 1>([this](const std::vector<Dual<parHiggsM + 1> >& dual) {
+    return LogLikelihoodTemplate(dual);
+  }, parameters, gradient);
+}
+
 // ---------------------------------------------------------
 std::vector<double> KLFitter::LikelihoodTTHLeptonJets::GetInitialParameters() {
   std::vector<double> values(GetInitialParametersWoNeutrinoPz());
@@ -25,6 +25,7 @@
 #include "BAT/BCMath.h"
 #include "BAT/BCParameter.h"
 #include "KLFitter/DetectorBase.h"
+#include "KLFitter/Dual.h"
 #include "KLFitter/Particles.h"
 #include "KLFitter/Permutations.h"
 #include "KLFitter/PhysicsConstants.h"
@@ -52,6 +53,11 @@ KLFitter::LikelihoodTTZTrilepton::LikelihoodTTZTrilepton()
 // ---------------------------------------------------------
 KLFitter::LikelihoodTTZTrilepton::~LikelihoodTTZTrilepton() = default;
 
+// ---------------------------------------------------------
+std::unique_ptr<KLFitter::LikelihoodBase> KLFitter::LikelihoodTTZTrilepton::Clone() const {
+  return std::unique_ptr<KLFitter::LikelihoodBase>(new KLFitter::LikelihoodTTZTrilepton(*this));
+}
+
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTTZTrilepton::SetET_miss_XY_SumET(double etx, double ety, double sumet) {
   // set missing ET x and y component and the SumET
@@ -190,15 +196,24 @@ void KLFitter::LikelihoodTTZTrilepton::DefineParameters() {
 }
 
 // ---------------------------------------------------------
-double KLFitter::LikelihoodTTZTrilepton::LogBreitWignerRelNorm(const double& x, const double& mean, const double& gamma) {
-  double g = std::sqrt(pow(mean, 2) * (pow(mean, 2) + pow(gamma, 2)));
-  double k = (2 * std::sqrt(2) * mean * gamma * g) / (M_PI * std::sqrt(pow(mean, 2) + g));
-  double f = k / (pow(pow(x, 2) - pow(mean, 2), 2) + pow(mean * gamma, 2));
+template <typename T>
+T KLFitter::LikelihoodTTZTrilepton::LogBreitWignerRelNorm(const T& x, const T& mean, double gamma) {
+  using std::log;
+  using std::pow;
+  using std::sqrt;
+  T g = sqrt(pow(mean, 2) * (pow(mean, 2) + pow(gamma, 2)));
+  T k = (2 * std::sqrt(2) * mean * gamma * g) / (M_PI * sqrt(pow(mean, 2) + g));
+  T f = k / (pow(pow(x, 2) - pow(mean, 2), 2) + pow(mean * gamma, 2));
   return log(f);
 }
 
 // ---------------------------------------------------------
-double KLFitter::LikelihoodTTZTrilepton::LogZCombinedDistribution(const double& x, const double& mean, const double& gamma) {
+template <typename T>
+T KLFitter::LikelihoodTTZTrilepton::LogZCombinedDistribution(const T& x, const T& mean, double gamma) {
+  using std::log;
+  using std::pow;
+  using std::sqrt;
+
   // note: This catches exceptions when the variables are set to non-sensible
   // values. If there is any common way to handle exceptions, it should be
   // implemented here.
@@ -206,127 +221,229 @@ double KLFitter::LikelihoodTTZTrilepton::LogZCombinedDistribution(const double&
   if (fraction < 0 || fraction > 1) throw;
   if (fInvMassCutoff < 0) throw;
 
-  double g = std::sqrt(pow(mean, 2) * (pow(mean, 2) + pow(gamma, 2)));
-  double k = (2 * std::sqrt(2) * mean * gamma * g) / (M_PI * std::sqrt(pow(mean, 2) + g));
-  double on_shell = k / (pow(pow(x, 2) - pow(mean, 2), 2) + pow(mean * gamma, 2));
-  double off_shell = fInvMassCutoff / x / x;
+  T g = sqrt(pow(mean, 2) * (pow(mean, 2) + pow(gamma, 2)));
+  T k = (2 * std::sqrt(2) * mean * gamma * g) / (M_PI * sqrt(pow(mean, 2) + g));
+  T on_shell = k / (pow(pow(x, 2) - pow(mean, 2), 2) + pow(mean * gamma, 2));
+  T off_shell = fInvMassCutoff / x / x;
   return log(on_shell * fraction + off_shell * (1 - fraction));
 }
 
 // ---------------------------------------------------------
-int KLFitter::LikelihoodTTZTrilepton::CalculateLorentzVectors(std::vector <double> const& parameters) {
-  static double scale;
-  static double whad_fit_e;
-  static double whad_fit_px;
-  static double whad_fit_py;
-  static double whad_fit_pz;
-  static double wlep_fit_e;
-  static double wlep_fit_px;
-  static double wlep_fit_py;
-  static double wlep_fit_pz;
-  static double thad_fit_e;
-  static double thad_fit_px;
-  static double thad_fit_py;
-  static double thad_fit_pz;
-  static double tlep_fit_e;
-  static double tlep_fit_px;
-  static double tlep_fit_py;
-  static double tlep_fit_pz;
-
-  static double Z_fit_e;
-  static double Z_fit_px;
-  static double Z_fit_py;
-  static double Z_fit_pz;
+template <typename T>
+struct KLFitter::LikelihoodTTZTrilepton::Kinematics {
+  T bhad_e;
+  T bhad_px;
+  T bhad_py;
+  T bhad_pz;
+
+  T blep_e;
+  T blep_px;
+  T blep_py;
+  T blep_pz;
+
+  T lq1_e;
+  T lq1_px;
+  T lq1_py;
+  T lq1_pz;
+
+  T lq2_e;
+  T lq2_px;
+  T lq2_py;
+  T lq2_pz;
+
+  T lepZ1_e;
+  T lepZ1_px;
+  T lepZ1_py;
+  T lepZ1_pz;
+
+  T lepZ2_e;
+  T lepZ2_px;
+  T lepZ2_py;
+  T lepZ2_pz;
+
+  T lep_e;
+  T lep_px;
+  T lep_py;
+  T lep_pz;
+
+  T nu_e;
+  T nu_px;
+  T nu_py;
+  T nu_pz;
+
+  T whad_m;
+  T wlep_m;
+  T thad_m;
+  T tlep_m;
+  T Z_m;
+};
+
+// ---------------------------------------------------------
+template <typename T>
+void KLFitter::LikelihoodTTZTrilepton::CalculateKinematics(const std::vector<T>& parameters, Kinematics<T>* fit) const {
+  T scale;
+  T whad_e;
+  T whad_px;
+  T whad_py;
+  T whad_pz;
+  T wlep_e;
+  T wlep_px;
+  T wlep_py;
+  T wlep_pz;
+  T thad_e;
+  T thad_px;
+  T thad_py;
+  T thad_pz;
+  T tlep_e;
+  T tlep_px;
+  T tlep_py;
+  T tlep_pz;
+  T Z_e;
+  T Z_px;
+  T Z_py;
+  T Z_pz;
 
   // hadronic b quark
-  bhad_fit_e = parameters[parBhadE];
-  scale = sqrt(bhad_fit_e*bhad_fit_e - bhad_meas_m*bhad_meas_m) / bhad_meas_p;
-  bhad_fit_px = scale * bhad_meas_px;
-  bhad_fit_py = scale * bhad_meas_py;
-  bhad_fit_pz = scale * bhad_meas_pz;
+  fit->bhad_e = parameters[parBhadE];
+  scale = sqrt(fit->bhad_e*fit->bhad_e - bhad_meas_m*bhad_meas_m) / bhad_meas_p;
+  fit->bhad_px = scale * bhad_meas_px;
+  fit->bhad_py = scale * bhad_meas_py;
+  fit->bhad_pz = scale * bhad_meas_pz;
 
   // leptonic b quark
-  blep_fit_e = parameters[parBlepE];
-  scale = sqrt(blep_fit_e*blep_fit_e - blep_meas_m*blep_meas_m) / blep_meas_p;
-  blep_fit_px = scale * blep_meas_px;
-  blep_fit_py = scale * blep_meas_py;
-  blep_fit_pz = scale * blep_meas_pz;
+  fit->blep_e = parameters[parBlepE];
+  scale = sqrt(fit->blep_e*fit->blep_e - blep_meas_m*blep_meas_m) / blep_meas_p;
+  fit->blep_px = scale * blep_meas_px;
+  fit->blep_py = scale * blep_meas_py;
+  fit->blep_pz = scale * blep_meas_pz;
 
   // light quark 1
-  lq1_fit_e = parameters[parLQ1E];
-  scale = sqrt(lq1_fit_e*lq1_fit_e - lq1_meas_m*lq1_meas_m) / lq1_meas_p;
-  lq1_fit_px = scale * lq1_meas_px;
-  lq1_fit_py = scale * lq1_meas_py;
-  lq1_fit_pz = scale * lq1_meas_pz;
+  fit->lq1_e = parameters[parLQ1E];
+  scale = sqrt(fit->lq1_e*fit->lq1_e - lq1_meas_m*lq1_meas_m) / lq1_meas_p;
+  fit->lq1_px = scale * lq1_meas_px;
+  fit->lq1_py = scale * lq1_meas_py;
+  fit->lq1_pz = scale * lq1_meas_pz;
 
   // light quark 2
-  lq2_fit_e = parameters[parLQ2E];
-  scale = sqrt(lq2_fit_e*lq2_fit_e - lq2_meas_m*lq2_meas_m) / lq2_meas_p;
-  lq2_fit_px  = scale * lq2_meas_px;
-  lq2_fit_py  = scale * lq2_meas_py;
-  lq2_fit_pz  = scale * lq2_meas_pz;
+  fit->lq2_e = parameters[parLQ2E];
+  scale = sqrt(fit->lq2_e*fit->lq2_e - lq2_meas_m*lq2_meas_m) / lq2_meas_p;
+  fit->lq2_px = scale * lq2_meas_px;
+  fit->lq2_py = scale * lq2_meas_py;
+  fit->lq2_pz = scale * lq2_meas_pz;
 
   // Z lepton 1
-  lepZ1_fit_e = parameters[parLepZ1E];
-  scale = lepZ1_fit_e / lepZ1_meas_e;
-  lepZ1_fit_px = scale * lepZ1_meas_px;
-  lepZ1_fit_py = scale * lepZ1_meas_py;
-  lepZ1_fit_pz = scale * lepZ1_meas_pz;
+  fit->lepZ1_e = parameters[parLepZ1E];
+  scale = fit->lepZ1_e / lepZ1_meas_e;
+  fit->lepZ1_px = scale * lepZ1_meas_px;
+  fit->lepZ1_py = scale * lepZ1_meas_py;
+  fit->lepZ1_pz = scale * lepZ1_meas_pz;
 
   // Z lepton 2
-  lepZ2_fit_e = parameters[parLepZ2E];
-  scale = lepZ2_fit_e / lepZ2_meas_e;
-  lepZ2_fit_px = scale * lepZ2_meas_px;
-  lepZ2_fit_py = scale * lepZ2_meas_py;
-  lepZ2_fit_pz = scale * lepZ2_meas_pz;
+  fit->lepZ2_e = parameters[parLepZ2E];
+  scale = fit->lepZ2_e / lepZ2_meas_e;
+  fit->lepZ2_px = scale * lepZ2_meas_px;
+  fit->lepZ2_py = scale * lepZ2_meas_py;
+  fit->lepZ2_pz = scale * lepZ2_meas_pz;
 
   // lepton
-  lep_fit_e = parameters[parLepE];
-  scale = lep_fit_e / lep_meas_e;
-  lep_fit_px = scale * lep_meas_px;
-  lep_fit_py = scale * lep_meas_py;
-  lep_fit_pz = scale * lep_meas_pz;
+  fit->lep_e = parameters[parLepE];
+  scale = fit->lep_e / lep_meas_e;
+  fit->lep_px = scale * lep_meas_px;
+  fit->lep_py = scale * lep_meas_py;
+  fit->lep_pz = scale * lep_meas_pz;
 
   // neutrino
-  nu_fit_px = parameters[parNuPx];
-  nu_fit_py = parameters[parNuPy];
-  nu_fit_pz = parameters[parNuPz];
-  nu_fit_e  = sqrt(nu_fit_px*nu_fit_px + nu_fit_py*nu_fit_py + nu_fit_pz*nu_fit_pz);
+  fit->nu_px = parameters[parNuPx];
+  fit->nu_py = parameters[parNuPy];
+  fit->nu_pz = parameters[parNuPz];
+  fit->nu_e  = sqrt(fit->nu_px*fit->nu_px + fit->nu_py*fit->nu_py + fit->nu_pz*fit->nu_pz);
 
   // hadronic W
-  whad_fit_e  = lq1_fit_e +lq2_fit_e;
-  whad_fit_px = lq1_fit_px+lq2_fit_px;
-  whad_fit_py = lq1_fit_py+lq2_fit_py;
-  whad_fit_pz = lq1_fit_pz+lq2_fit_pz;
-  whad_fit_m = sqrt(whad_fit_e*whad_fit_e - (whad_fit_px*whad_fit_px + whad_fit_py*whad_fit_py + whad_fit_pz*whad_fit_pz));
+  whad_e = fit->lq1_e + fit->lq2_e;
+  whad_px = fit->lq1_px + fit->lq2_px;
+  whad_py = fit->lq1_py + fit->lq2_py;
+  whad_pz = fit->lq1_pz + fit->lq2_pz;
+  fit->whad_m = sqrt(whad_e*whad_e - (whad_px*whad_px + whad_py*whad_py + whad_pz*whad_pz));
 
   // leptonic W
-  wlep_fit_e  = lep_fit_e +nu_fit_e;
-  wlep_fit_px = lep_fit_px+nu_fit_px;
-  wlep_fit_py = lep_fit_py+nu_fit_py;
-  wlep_fit_pz = lep_fit_pz+nu_fit_pz;
-  wlep_fit_m = sqrt(wlep_fit_e*wlep_fit_e - (wlep_fit_px*wlep_fit_px + wlep_fit_py*wlep_fit_py + wlep_fit_pz*wlep_fit_pz));
+  wlep_e = fit->lep_e + fit->nu_e;
+  wlep_px = fit->lep_px + fit->nu_px;
+  wlep_py = fit->lep_py + fit->nu_py;
+  wlep_pz = fit->lep_pz + fit->nu_pz;
+  fit->wlep_m = sqrt(wlep_e*wlep_e - (wlep_px*wlep_px + wlep_py*wlep_py + wlep_pz*wlep_pz));
 
   // hadronic top
-  thad_fit_e = whad_fit_e+bhad_fit_e;
-  thad_fit_px = whad_fit_px+bhad_fit_px;
-  thad_fit_py = whad_fit_py+bhad_fit_py;
-  thad_fit_pz = whad_fit_pz+bhad_fit_pz;
-  thad_fit_m = sqrt(thad_fit_e*thad_fit_e - (thad_fit_px*thad_fit_px + thad_fit_py*thad_fit_py + thad_fit_pz*thad_fit_pz));
+  thad_e = whad_e + fit->bhad_e;
+  thad_px = whad_px + fit->bhad_px;
+  thad_py = whad_py + fit->bhad_py;
+  thad_pz = whad_pz + fit->bhad_pz;
+  fit->thad_m = sqrt(thad_e*thad_e - (thad_px*thad_px + thad_py*thad_py + thad_pz*thad_pz));
 
   // leptonic top
-  tlep_fit_e = wlep_fit_e+blep_fit_e;
-  tlep_fit_px = wlep_fit_px+blep_fit_px;
-  tlep_fit_py = wlep_fit_py+blep_fit_py;
-  tlep_fit_pz = wlep_fit_pz+blep_fit_pz;
-  tlep_fit_m = sqrt(tlep_fit_e*tlep_fit_e - (tlep_fit_px*tlep_fit_px + tlep_fit_py*tlep_fit_py + tlep_fit_pz*tlep_fit_pz));
+  tlep_e = wlep_e + fit->blep_e;
+  tlep_px = wlep_px + fit->blep_px;
+  tlep_py = wlep_py + fit->blep_py;
+  tlep_pz = wlep_pz + fit->blep_pz;
+  fit->tlep_m = sqrt(tlep_e*tlep_e - (tlep_px*tlep_px + tlep_py*tlep_py + tlep_pz*tlep_pz));
 
   // Z boson
-  Z_fit_e  = lepZ1_fit_e  + lepZ2_fit_e;
-  Z_fit_px = lepZ1_fit_px + lepZ2_fit_px;
-  Z_fit_py = lepZ1_fit_py + lepZ2_fit_py;
-  Z_fit_pz = lepZ1_fit_pz + lepZ2_fit_pz;
-  Z_fit_m  = sqrt(Z_fit_e*Z_fit_e - (Z_fit_px*Z_fit_px + Z_fit_py*Z_fit_py + Z_fit_pz*Z_fit_pz));
+  Z_e = fit->lepZ1_e + fit->lepZ2_e;
+  Z_px = fit->lepZ1_px + fit->lepZ2_px;
+  Z_py = fit->lepZ1_py + fit->lepZ2_py;
+  Z_pz = fit->lepZ1_pz + fit->lepZ2_pz;
+  fit->Z_m = sqrt(Z_e*Z_e - (Z_px*Z_px + Z_py*Z_py + Z_pz*Z_pz));
+}
+
+// ---------------------------------------------------------
+int KLFitter::LikelihoodTTZTrilepton::CalculateLorentzVectors(std::vector <double> const& parameters) {
+  Kinematics<double> fit;
+  CalculateKinematics(parameters, &fit);
+
+  bhad_fit_e = fit.bhad_e;
+  bhad_fit_px = fit.bhad_px;
+  bhad_fit_py = fit.bhad_py;
+  bhad_fit_pz = fit.bhad_pz;
+
+  blep_fit_e = fit.blep_e;
+  blep_fit_px = fit.blep_px;
+  blep_fit_py = fit.blep_py;
+  blep_fit_pz = fit.blep_pz;
+
+  lq1_fit_e = fit.lq1_e;
+  lq1_fit_px = fit.lq1_px;
+  lq1_fit_py = fit.lq1_py;
+  lq1_fit_pz = fit.lq1_pz;
+
+  lq2_fit_e = fit.lq2_e;
+  lq2_fit_px = fit.lq2_px;
+  lq2_fit_py = fit.lq2_py;
+  lq2_fit_pz = fit.lq2_pz;
+
+  lepZ1_fit_e = fit.lepZ1_e;
+  lepZ1_fit_px = fit.lepZ1_px;
+  lepZ1_fit_py = fit.lepZ1_py;
+  lepZ1_fit_pz = fit.lepZ1_pz;
+
+  lepZ2_fit_e = fit.lepZ2_e;
+  lepZ2_fit_px = fit.lepZ2_px;
+  lepZ2_fit_py = fit.lepZ2_py;
+  lepZ2_fit_pz = fit.lepZ2_pz;
+
+  lep_fit_e = fit.lep_e;
+  lep_fit_px = fit.lep_px;
+  lep_fit_py = fit.lep_py;
+  lep_fit_pz = fit.lep_pz;
+
+  nu_fit_e = fit.nu_e;
+  nu_fit_px = fit.nu_px;
+  nu_fit_py = fit.nu_py;
+  nu_fit_pz = fit.nu_pz;
+
+  whad_fit_m = fit.whad_m;
+  wlep_fit_m = fit.wlep_m;
+  thad_fit_m = fit.thad_m;
+  tlep_fit_m = fit.tlep_m;
+  Z_fit_m = fit.Z_m;
 
   // no error
   return 1;
@@ -491,56 +608,58 @@ int KLFitter::LikelihoodTTZTrilepton::AdjustParameterRanges() {
 }
 
 // ---------------------------------------------------------
-double KLFitter::LikelihoodTTZTrilepton::LogLikelihood(const std::vector<double> & parameters) {
+template <typename T>
+T KLFitter::LikelihoodTTZTrilepton::LogLikelihoodTemplate(const std::vector<T>& parameters) {
   // calculate 4-vectors
-  CalculateLorentzVectors(parameters);
+  Kinematics<T> fit;
+  CalculateKinematics(parameters, &fit);
 
   // define log of likelihood
-  double logprob(0.);
+  T logprob(0.);
 
   // temporary flag for a safe use of the transfer functions
   bool TFgoodTmp(true);
 
   // jet energy resolution terms
-  logprob += log(fResEnergyBhad->p(bhad_fit_e, bhad_meas_e, &TFgoodTmp));
+  logprob += fResEnergyBhad->LogP(fit.bhad_e, bhad_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyBlep->p(blep_fit_e, blep_meas_e, &TFgoodTmp));
+  logprob += fResEnergyBlep->LogP(fit.blep_e, blep_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyLQ1->p(lq1_fit_e, lq1_meas_e, &TFgoodTmp));
+  logprob += fResEnergyLQ1->LogP(fit.lq1_e, lq1_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyLQ2->p(lq2_fit_e, lq2_meas_e, &TFgoodTmp));
+  logprob += fResEnergyLQ2->LogP(fit.lq2_e, lq2_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
   // lepton energy resolution terms
   if (fTypeLepton == kElectron) {
-    logprob += log(fResLepton->p(lep_fit_e, lep_meas_e, &TFgoodTmp));
+    logprob += fResLepton->LogP(fit.lep_e, lep_meas_e, &TFgoodTmp);
   } else if (fTypeLepton == kMuon) {
-    logprob += log(fResLepton->p(lep_fit_e* lep_meas_sintheta, lep_meas_pt, &TFgoodTmp));
+    logprob += fResLepton->LogP(fit.lep_e* lep_meas_sintheta, lep_meas_pt, &TFgoodTmp);
   }
   if (!TFgoodTmp) fTFgood = false;
 
   if (fTypeLepton == kElectron) {
-    logprob += log(fResLeptonZ1->p(lepZ1_fit_e, lepZ1_meas_e, &TFgoodTmp));
+    logprob += fResLeptonZ1->LogP(fit.lepZ1_e, lepZ1_meas_e, &TFgoodTmp);
   } else if (fTypeLepton == kMuon) {
-    logprob += log(fResLeptonZ1->p(lepZ1_fit_e* lepZ1_meas_sintheta, lepZ1_meas_pt, &TFgoodTmp));
+    logprob += fResLeptonZ1->LogP(fit.lepZ1_e* lepZ1_meas_sintheta, lepZ1_meas_pt, &TFgoodTmp);
   }
   if (!TFgoodTmp) fTFgood = false;
 
   if (fTypeLepton == kElectron) {
-    logprob += log(fResLeptonZ2->p(lepZ2_fit_e, lepZ2_meas_e, &TFgoodTmp));
+    logprob += fResLeptonZ2->LogP(fit.lepZ2_e, lepZ2_meas_e, &TFgoodTmp);
   } else if (fTypeLepton == kMuon) {
-    logprob += log(fResLeptonZ2->p(lepZ2_fit_e* lepZ2_meas_sintheta, lepZ2_meas_pt, &TFgoodTmp));
+    logprob += fResLeptonZ2->LogP(fit.lepZ2_e* lepZ2_meas_sintheta, lepZ2_meas_pt, &TFgoodTmp);
   }
   if (!TFgoodTmp) fTFgood = false;
 
   // neutrino px and py
-  logprob += log(fResMET->p(nu_fit_px, ETmiss_x, &TFgoodTmp, SumET));
+  logprob += fResMET->LogP(fit.nu_px, ETmiss_x, &TFgoodTmp, SumET);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResMET->p(nu_fit_py, ETmiss_y, &TFgoodTmp, SumET));
+  logprob += fResMET->LogP(fit.nu_py, ETmiss_y, &TFgoodTmp, SumET);
   if (!TFgoodTmp) fTFgood = false;
 
   // physics constants
@@ -558,24 +677,42 @@ double KLFitter::LikelihoodTTZTrilepton::LogLikelihood(const std::vector<double>
   // functions are handled correctly.
 
   // Breit-Wigner of hadronically decaying W-boson
-  logprob += LogBreitWignerRelNorm(whad_fit_m, massW, gammaW);
+  logprob += LogBreitWignerRelNorm<T>(fit.whad_m, massW, gammaW);
 
   // Breit-Wigner of leptonically decaying W-boson
-  logprob += LogBreitWignerRelNorm(wlep_fit_m, massW, gammaW);
+  logprob += LogBreitWignerRelNorm<T>(fit.wlep_m, massW, gammaW);
 
   // Breit-Wigner of hadronically decaying top quark
-  logprob += LogBreitWignerRelNorm(thad_fit_m, parameters[parTopM], gammaTop);
+  logprob += LogBreitWignerRelNorm<T>(fit.thad_m, parameters[parTopM], gammaTop);
 
   // Breit-Wigner of leptonically decaying top quark
-  logprob += LogBreitWignerRelNorm(tlep_fit_m, parameters[parTopM], gammaTop);
+  logprob += LogBreitWignerRelNorm<T>(fit.tlep_m, parameters[parTopM], gammaTop);
 
   // Breit-Wigner of Z boson decaying into two leptons
-  logprob += LogZCombinedDistribution(Z_fit_m, parameters[parZM], gammaZ);
+  logprob += LogZCombinedDistribution<T>(fit.Z_m, parameters[parZM], gammaZ);
 
   // return log of likelihood
   return logprob;
 }
 
+// ---------------------------------------------------------
+double KLFitter::LikelihoodTTZTrilepton::LogLikelihood(const std::vector<double> & parameters) {
+  return LogLikelihoodTemplate(parameters);
+}
+
+// ---------------------------------------------------------
+double KLFitter::LikelihoodTTZTrilepton::LogLikelihoodGradient(const std::vector<double> & parameters, std::vector<double>* gradient) {
+  // the dual numbers have a component for each parameter
+  if (parameters.size() > parZM + 1) {
+    std::cout << "KLFitter::LikelihoodTTZTrilepton::LogLikelihoodGradient(). More parameters than dual number components." << std::endl;
+    return LikelihoodBase::LogLikelihoodGradient(parameters, gradient);
+  }
+
+  return EvaluateGradient<parZM + 1>([this](const std::vector<Dual<parZM + 1> >& dual) {
+    return LogLikelihoodTemplate(dual);
+  }, parameters, gradient);
+}
+
 // ---------------------------------------------------------
 std::vector<double> KLFitter::LikelihoodTTZTrilepton::GetInitialParameters() {
   std::vector<double> values(GetInitialParametersWoNeutrinoPz());
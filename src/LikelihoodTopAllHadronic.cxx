@@ -26,6 +26,7 @@
 #include "BAT/BCMath.h"
 #include "BAT/BCParameter.h"
 #include "KLFitter/DetectorBase.h"
+#include "KLFitter/Dual.h"
 #include "KLFitter/Particles.h"
 #include "KLFitter/Permutations.h"
 #include "KLFitter/PhysicsConstants.h"
@@ -47,6 +48,11 @@ KLFitter::LikelihoodTopAllHadronic::LikelihoodTopAllHadronic()
 // ---------------------------------------------------------
 KLFitter::LikelihoodTopAllHadronic::~LikelihoodTopAllHadronic() = default;
 
+// ---------------------------------------------------------
+std::unique_ptr<KLFitter::LikelihoodBase> KLFitter::LikelihoodTopAllHadronic::Clone() const {
+  return std::unique_ptr<KLFitter::LikelihoodBase>(new KLFitter::LikelihoodTopAllHadronic(*this));
+}
+
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTopAllHadronic::DefineModelParticles() {
   // create the particles of the model
@@ -124,94 +130,175 @@ void KLFitter::LikelihoodTopAllHadronic::DefineParameters() {
 }
 
 // ---------------------------------------------------------
-int KLFitter::LikelihoodTopAllHadronic::CalculateLorentzVectors(std::vector <double> const& parameters) {
-  static double scale;
-  static double whad1_fit_e;
-  static double whad1_fit_px;
-  static double whad1_fit_py;
-  static double whad1_fit_pz;
-  static double whad2_fit_e;
-  static double whad2_fit_px;
-  static double whad2_fit_py;
-  static double whad2_fit_pz;
-  static double thad1_fit_e;
-  static double thad1_fit_px;
-  static double thad1_fit_py;
-  static double thad1_fit_pz;
-  static double thad2_fit_e;
-  static double thad2_fit_px;
-  static double thad2_fit_py;
-  static double thad2_fit_pz;
+template <typename T>
+struct KLFitter::LikelihoodTopAllHadronic::Kinematics {
+  T bhad1_e;
+  T bhad1_px;
+  T bhad1_py;
+  T bhad1_pz;
+
+  T bhad2_e;
+  T bhad2_px;
+  T bhad2_py;
+  T bhad2_pz;
+
+  T lq1_e;
+  T lq1_px;
+  T lq1_py;
+  T lq1_pz;
+
+  T lq2_e;
+  T lq2_px;
+  T lq2_py;
+  T lq2_pz;
+
+  T lq3_e;
+  T lq3_px;
+  T lq3_py;
+  T lq3_pz;
+
+  T lq4_e;
+  T lq4_px;
+  T lq4_py;
+  T lq4_pz;
+
+  T whad1_m;
+  T whad2_m;
+  T thad1_m;
+  T thad2_m;
+};
+
+// ---------------------------------------------------------
+template <typename T>
+void KLFitter::LikelihoodTopAllHadronic::CalculateKinematics(const std::vector<T>& parameters, Kinematics<T>* fit) const {
+  T scale;
+  T whad1_e;
+  T whad1_px;
+  T whad1_py;
+  T whad1_pz;
+  T whad2_e;
+  T whad2_px;
+  T whad2_py;
+  T whad2_pz;
+  T thad1_e;
+  T thad1_px;
+  T thad1_py;
+  T thad1_pz;
+  T thad2_e;
+  T thad2_px;
+  T thad2_py;
+  T thad2_pz;
 
   // hadronic b quark 1
-  bhad1_fit_e = parameters[parBhad1E];
-  scale = sqrt(bhad1_fit_e*bhad1_fit_e - bhad1_meas_m*bhad1_meas_m) / bhad1_meas_p;
-  bhad1_fit_px = scale * bhad1_meas_px;
-  bhad1_fit_py = scale * bhad1_meas_py;
-  bhad1_fit_pz = scale * bhad1_meas_pz;
+  fit->bhad1_e = parameters[parBhad1E];
+  scale = sqrt(fit->bhad1_e*fit->bhad1_e - bhad1_meas_m*bhad1_meas_m) / bhad1_meas_p;
+  fit->bhad1_px = scale * bhad1_meas_px;
+  fit->bhad1_py = scale * bhad1_meas_py;
+  fit->bhad1_pz = scale * bhad1_meas_pz;
 
   // hadronic b quark 2
-  bhad2_fit_e = parameters[parBhad2E];
-  scale = sqrt(bhad2_fit_e*bhad2_fit_e - bhad2_meas_m*bhad2_meas_m) / bhad2_meas_p;
-  bhad2_fit_px = scale * bhad2_meas_px;
-  bhad2_fit_py = scale * bhad2_meas_py;
-  bhad2_fit_pz = scale * bhad2_meas_pz;
+  fit->bhad2_e = parameters[parBhad2E];
+  scale = sqrt(fit->bhad2_e*fit->bhad2_e - bhad2_meas_m*bhad2_meas_m) / bhad2_meas_p;
+  fit->bhad2_px = scale * bhad2_meas_px;
+  fit->bhad2_py = scale * bhad2_meas_py;
+  fit->bhad2_pz = scale * bhad2_meas_pz;
 
   // light quark 1
-  lq1_fit_e = parameters[parLQ1E];
-  scale = sqrt(lq1_fit_e*lq1_fit_e - lq1_meas_m*lq1_meas_m) / lq1_meas_p;
-  lq1_fit_px = scale * lq1_meas_px;
-  lq1_fit_py = scale * lq1_meas_py;
-  lq1_fit_pz = scale * lq1_meas_pz;
+  fit->lq1_e = parameters[parLQ1E];
+  scale = sqrt(fit->lq1_e*fit->lq1_e - lq1_meas_m*lq1_meas_m) / lq1_meas_p;
+  fit->lq1_px = scale * lq1_meas_px;
+  fit->lq1_py = scale * lq1_meas_py;
+  fit->lq1_pz = scale * lq1_meas_pz;
 
   // light quark 2
-  lq2_fit_e = parameters[parLQ2E];
-  scale = sqrt(lq2_fit_e*lq2_fit_e - lq2_meas_m*lq2_meas_m) / lq2_meas_p;
-  lq2_fit_px  = scale * lq2_meas_px;
-  lq2_fit_py  = scale * lq2_meas_py;
-  lq2_fit_pz  = scale * lq2_meas_pz;
+  fit->lq2_e = parameters[parLQ2E];
+  scale = sqrt(fit->lq2_e*fit->lq2_e - lq2_meas_m*lq2_meas_m) / lq2_meas_p;
+  fit->lq2_px = scale * lq2_meas_px;
+  fit->lq2_py = scale * lq2_meas_py;
+  fit->lq2_pz = scale * lq2_meas_pz;
 
   // light quark 3
-  lq3_fit_e = parameters[parLQ3E];
-  scale = sqrt(lq3_fit_e*lq3_fit_e - lq3_meas_m*lq3_meas_m) / lq3_meas_p;
-  lq3_fit_px = scale * lq3_meas_px;
-  lq3_fit_py = scale * lq3_meas_py;
-  lq3_fit_pz = scale * lq3_meas_pz;
+  fit->lq3_e = parameters[parLQ3E];
+  scale = sqrt(fit->lq3_e*fit->lq3_e - lq3_meas_m*lq3_meas_m) / lq3_meas_p;
+  fit->lq3_px = scale * lq3_meas_px;
+  fit->lq3_py = scale * lq3_meas_py;
+  fit->lq3_pz = scale * lq3_meas_pz;
 
   // light quark 4
-  lq4_fit_e = parameters[parLQ4E];
-  scale = sqrt(lq4_fit_e*lq4_fit_e - lq4_meas_m*lq4_meas_m) / lq4_meas_p;
-  lq4_fit_px = scale * lq4_meas_px;
-  lq4_fit_py = scale * lq4_meas_py;
-  lq4_fit_pz = scale * lq4_meas_pz;
+  fit->lq4_e = parameters[parLQ4E];
+  scale = sqrt(fit->lq4_e*fit->lq4_e - lq4_meas_m*lq4_meas_m) / lq4_meas_p;
+  fit->lq4_px = scale * lq4_meas_px;
+  fit->lq4_py = scale * lq4_meas_py;
+  fit->lq4_pz = scale * lq4_meas_pz;
 
   // hadronic W 1
-  whad1_fit_e  = lq1_fit_e +lq2_fit_e;
-  whad1_fit_px = lq1_fit_px+lq2_fit_px;
-  whad1_fit_py = lq1_fit_py+lq2_fit_py;
-  whad1_fit_pz = lq1_fit_pz+lq2_fit_pz;
-  whad1_fit_m = sqrt(whad1_fit_e*whad1_fit_e - (whad1_fit_px*whad1_fit_px + whad1_fit_py*whad1_fit_py + whad1_fit_pz*whad1_fit_pz));
+  whad1_e = fit->lq1_e + fit->lq2_e;
+  whad1_px = fit->lq1_px + fit->lq2_px;
+  whad1_py = fit->lq1_py + fit->lq2_py;
+  whad1_pz = fit->lq1_pz + fit->lq2_pz;
+  fit->whad1_m = sqrt(whad1_e*whad1_e - (whad1_px*whad1_px + whad1_py*whad1_py + whad1_pz*whad1_pz));
 
   // hadronic W 2
-  whad2_fit_e  = lq3_fit_e +lq4_fit_e;
-  whad2_fit_px = lq3_fit_px+lq4_fit_px;
-  whad2_fit_py = lq3_fit_py+lq4_fit_py;
-  whad2_fit_pz = lq3_fit_pz+lq4_fit_pz;
-  whad2_fit_m = sqrt(whad2_fit_e*whad2_fit_e - (whad2_fit_px*whad2_fit_px + whad2_fit_py*whad2_fit_py + whad2_fit_pz*whad2_fit_pz));
+  whad2_e = fit->lq3_e + fit->lq4_e;
+  whad2_px = fit->lq3_px + fit->lq4_px;
+  whad2_py = fit->lq3_py + fit->lq4_py;
+  whad2_pz = fit->lq3_pz + fit->lq4_pz;
+  fit->whad2_m = sqrt(whad2_e*whad2_e - (whad2_px*whad2_px + whad2_py*whad2_py + whad2_pz*whad2_pz));
 
   // hadronic top 1
-  thad1_fit_e = whad1_fit_e+bhad1_fit_e;
-  thad1_fit_px = whad1_fit_px+bhad1_fit_px;
-  thad1_fit_py = whad1_fit_py+bhad1_fit_py;
-  thad1_fit_pz = whad1_fit_pz+bhad1_fit_pz;
-  thad1_fit_m = sqrt(thad1_fit_e*thad1_fit_e - (thad1_fit_px*thad1_fit_px + thad1_fit_py*thad1_fit_py + thad1_fit_pz*thad1_fit_pz));
+  thad1_e = whad1_e + fit->bhad1_e;
+  thad1_px = whad1_px + fit->bhad1_px;
+  thad1_py = whad1_py + fit->bhad1_py;
+  thad1_pz = whad1_pz + fit->bhad1_pz;
+  fit->thad1_m = sqrt(thad1_e*thad1_e - (thad1_px*thad1_px + thad1_py*thad1_py + thad1_pz*thad1_pz));
 
   // hadronic top 2
-  thad2_fit_e = whad2_fit_e+bhad2_fit_e;
-  thad2_fit_px = whad2_fit_px+bhad2_fit_px;
-  thad2_fit_py = whad2_fit_py+bhad2_fit_py;
-  thad2_fit_pz = whad2_fit_pz+bhad2_fit_pz;
-  thad2_fit_m = sqrt(thad2_fit_e*thad2_fit_e - (thad2_fit_px*thad2_fit_px + thad2_fit_py*thad2_fit_py + thad2_fit_pz*thad2_fit_pz));
+  thad2_e = whad2_e + fit->bhad2_e;
+  thad2_px = whad2_px + fit->bhad2_px;
+  thad2_py = whad2_py + fit->bhad2_py;
+  thad2_pz = whad2_pz + fit->bhad2_pz;
+  fit->thad2_m = sqrt(thad2_e*thad2_e - (thad2_px*thad2_px + thad2_py*thad2_py + thad2_pz*thad2_pz));
+}
+
+// ---------------------------------------------------------
+int KLFitter::LikelihoodTopAllHadronic::CalculateLorentzVectors(std::vector <double> const& parameters) {
+  Kinematics<double> fit;
+  CalculateKinematics(parameters, &fit);
+
+  bhad1_fit_e = fit.bhad1_e;
+  bhad1_fit_px = fit.bhad1_px;
+  bhad1_fit_py = fit.bhad1_py;
+  bhad1_fit_pz = fit.bhad1_pz;
+
+  bhad2_fit_e = fit.bhad2_e;
+  bhad2_fit_px = fit.bhad2_px;
+  bhad2_fit_py = fit.bhad2_py;
+  bhad2_fit_pz = fit.bhad2_pz;
+
+  lq1_fit_e = fit.lq1_e;
+  lq1_fit_px = fit.lq1_px;
+  lq1_fit_py = fit.lq1_py;
+  lq1_fit_pz = fit.lq1_pz;
+
+  lq2_fit_e = fit.lq2_e;
+  lq2_fit_px = fit.lq2_px;
+  lq2_fit_py = fit.lq2_py;
+  lq2_fit_pz = fit.lq2_pz;
+
+  lq3_fit_e = fit.lq3_e;
+  lq3_fit_px = fit.lq3_px;
+  lq3_fit_py = fit.lq3_py;
+  lq3_fit_pz = fit.lq3_pz;
+
+  lq4_fit_e = fit.lq4_e;
+  lq4_fit_px = fit.lq4_px;
+  lq4_fit_py = fit.lq4_py;
+  lq4_fit_pz = fit.lq4_pz;
+
+  whad1_fit_m = fit.whad1_m;
+  whad2_fit_m = fit.whad2_m;
+  thad1_fit_m = fit.thad1_m;
+  thad2_fit_m = fit.thad2_m;
 
   // no error
   return 1;
@@ -324,33 +411,35 @@ int KLFitter::LikelihoodTopAllHadronic::AdjustParameterRanges() {
 }
 
 // ---------------------------------------------------------
-double KLFitter::LikelihoodTopAllHadronic::LogLikelihood(const std::vector<double> & parameters) {
+template <typename T>
+T KLFitter::LikelihoodTopAllHadronic::LogLikelihoodTemplate(const std::vector<T>& parameters) {
   // calculate 4-vectors
-  CalculateLorentzVectors(parameters);
+  Kinematics<T> fit;
+  CalculateKinematics(parameters, &fit);
 
   // define log of likelihood
-  double logprob(0.);
+  T logprob(0.);
 
   // temporary flag for a safe use of the transfer functions
   bool TFgoodTmp(true);
 
   // jet energy resolution terms
-  logprob += log(fResEnergyBhad1->p(bhad1_fit_e, bhad1_meas_e, &TFgoodTmp));
+  logprob += fResEnergyBhad1->LogP(fit.bhad1_e, bhad1_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyBhad2->p(bhad2_fit_e, bhad2_meas_e, &TFgoodTmp));
+  logprob += fResEnergyBhad2->LogP(fit.bhad2_e, bhad2_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyLQ1->p(lq1_fit_e, lq1_meas_e, &TFgoodTmp));
+  logprob += fResEnergyLQ1->LogP(fit.lq1_e, lq1_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyLQ2->p(lq2_fit_e, lq2_meas_e, &TFgoodTmp));
+  logprob += fResEnergyLQ2->LogP(fit.lq2_e, lq2_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyLQ3->p(lq3_fit_e, lq3_meas_e, &TFgoodTmp));
+  logprob += fResEnergyLQ3->LogP(fit.lq3_e, lq3_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
-  logprob += log(fResEnergyLQ4->p(lq4_fit_e, lq4_meas_e, &TFgoodTmp));
+  logprob += fResEnergyLQ4->LogP(fit.lq4_e, lq4_meas_e, &TFgoodTmp);
   if (!TFgoodTmp) fTFgood = false;
 
   // physics constants
@@ -362,21 +451,39 @@ double KLFitter::LikelihoodTopAllHadronic::LogLikelihood(const std::vector<doubl
   double gammaTop = fPhysicsConstants.GammaTop();
 
   // Breit-Wigner of hadronically decaying W-boson
-  logprob += BCMath::LogBreitWignerRel(whad1_fit_m, massW, gammaW);
+  logprob += LogBreitWignerRel<T>(fit.whad1_m, massW, gammaW);
 
   // Breit-Wigner of hadronically decaying W-boson
-  logprob += BCMath::LogBreitWignerRel(whad2_fit_m, massW, gammaW);
+  logprob += LogBreitWignerRel<T>(fit.whad2_m, massW, gammaW);
 
   // Breit-Wigner of first hadronically decaying top quark
-  logprob += BCMath::LogBreitWignerRel(thad1_fit_m, parameters[parTopM], gammaTop);
+  logprob += LogBreitWignerRel<T>(fit.thad1_m, parameters[parTopM], gammaTop);
 
   // Breit-Wigner of second hadronically decaying top quark
-  logprob += BCMath::LogBreitWignerRel(thad2_fit_m, parameters[parTopM], gammaTop);
+  logprob += LogBreitWignerRel<T>(fit.thad2_m, parameters[parTopM], gammaTop);
 
   // return log of likelihood
   return logprob;
 }
 
+// ---------------------------------------------------------
+double KLFitter::LikelihoodTopAllHadronic::LogLikelihood(const std::vector<double> & parameters) {
+  return LogLikelihoodTemplate(parameters);
+}
+
+// ---------------------------------------------------------
+double KLFitter::LikelihoodTopAllHadronic::LogLikelihoodGradient(const std::vector<double> & parameters, std::vector<double>* gradient) {
+  // the dual numbers have a component for each parameter
+  if (parameters.size() > parTopM + 1) {
+    std::cout << "KLFitter::LikelihoodTopAllHadronic::LogLikelihoodGradient(). More parameters than dual number components." << std::endl;
+    return LikelihoodBase::LogLikelihoodGradient(parameters, gradient);
+  }
+
+  return EvaluateGradient<parTopM + 1>([this](const std::vector<Dual<parTopM + 1> >& dual) {
+    return LogLikelihoodTemplate(dual);
+  }, parameters, gradient);
+}
+
 // ---------------------------------------------------------
 std::vector<double> KLFitter::LikelihoodTopAllHadronic::GetInitialParameters() {
   std::vector<double> values(GetNParameters());
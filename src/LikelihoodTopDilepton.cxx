@@ -29,6 +29,7 @@
 #include "BAT/BCMath.h"
 #include "BAT/BCModel.h"
 #include "KLFitter/DetectorBase.h"
+#include "KLFitter/FourVector.h"
 #include "KLFitter/Particles.h"
 #include "KLFitter/Permutations.h"
 #include "KLFitter/PhysicsConstants.h"
@@ -38,7 +39,7 @@
 //! Neutrino Solution Set
 class KLFitter::NuSolutions {
 public:
-  TLorentzVector nu1, nu2;
+  KLFitter::FourVector nu1, nu2;
   int NSolutions;
   NuSolutions():NSolutions(0) {}
   ~NuSolutions() {}
@@ -72,6 +73,21 @@ KLFitter::LikelihoodTopDilepton::LikelihoodTopDilepton()
 // ---------------------------------------------------------
 KLFitter::LikelihoodTopDilepton::~LikelihoodTopDilepton() = default;
 
+// ---------------------------------------------------------
+std::unique_ptr<KLFitter::LikelihoodBase> KLFitter::LikelihoodTopDilepton::Clone() const {
+  // the histograms filled during the marginalisation belong to the
+  // likelihood, so the clone is set up from scratch and only the
+  // configuration is taken over
+  std::unique_ptr<KLFitter::LikelihoodTopDilepton> clone{new KLFitter::LikelihoodTopDilepton{}};
+  clone->SetLeptonType(fTypeLepton_1, fTypeLepton_2);
+  clone->CopyConfiguration(*this);
+  clone->fFlagTopMassFixed = fFlagTopMassFixed;
+  clone->nueta_params = nueta_params;
+  clone->doSumloglik = doSumloglik;
+  clone->DefinePrior();
+  return std::unique_ptr<KLFitter::LikelihoodBase>(clone.release());
+}
+
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTopDilepton::SetET_miss_XY_SumET(double etx, double ety, double sumet) {
   // set missing ET x and y component and the SumET
@@ -211,7 +227,7 @@ void KLFitter::LikelihoodTopDilepton::DefineHistograms() {
 
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTopDilepton::CalculateLorentzVectors(std::vector <double> const& parameters) {
-  static double scale;
+  double scale;
 
   // b1 quark
   b1_fit_e = parameters[parB1E];
@@ -545,16 +561,16 @@ double KLFitter::LikelihoodTopDilepton::CalculateMLepJet(const std::vector<doubl
   double alpha =-2.;
 
   // charged leptons
-  TLorentzVector l1(0., 0., 0., 0.);
-  TLorentzVector l2(0., 0., 0., 0.);
+  KLFitter::FourVector l1(0., 0., 0., 0.);
+  KLFitter::FourVector l2(0., 0., 0., 0.);
 
   // include parLep1E, parLep2E
   l1.SetPxPyPzE(lep1_fit_px,  lep1_fit_py,  lep1_fit_pz,  lep1_fit_e);
   l2.SetPxPyPzE(lep2_fit_px,  lep2_fit_py,  lep2_fit_pz,  lep2_fit_e);
 
   // jet1 and jet2:
-  TLorentzVector j1(0., 0., 0., 0.);
-  TLorentzVector j2(0., 0., 0., 0.);
+  KLFitter::FourVector j1(0., 0., 0., 0.);
+  KLFitter::FourVector j2(0., 0., 0., 0.);
 
   // include parB1E, parB2E
   j1.SetPxPyPzE(b1_fit_px, b1_fit_py, b1_fit_pz, b1_fit_e);
@@ -584,16 +600,16 @@ double KLFitter::LikelihoodTopDilepton::CalculateWeight(const std::vector<double
   double Weight = 0.;
 
   // charged leptons
-  TLorentzVector l1{};
-  TLorentzVector l2{};
+  KLFitter::FourVector l1{};
+  KLFitter::FourVector l2{};
 
   // include parLep1E, parLep2E
   l1.SetPxPyPzE(lep1_fit_px,  lep1_fit_py,  lep1_fit_pz,  lep1_fit_e);
   l2.SetPxPyPzE(lep2_fit_px,  lep2_fit_py,  lep2_fit_pz,  lep2_fit_e);
 
   // jet1 and jet2:
-  TLorentzVector j1{};
-  TLorentzVector j2{};
+  KLFitter::FourVector j1{};
+  KLFitter::FourVector j2{};
 
   // include parB1E, parB2E
   j1.SetPxPyPzE(b1_fit_px, b1_fit_py, b1_fit_pz, b1_fit_e);
@@ -609,7 +625,7 @@ double KLFitter::LikelihoodTopDilepton::CalculateWeight(const std::vector<double
 }
 
 // ---------------------------------------------------------
-double KLFitter::LikelihoodTopDilepton::CalculateWeightPerm(TLorentzVector * l1, TLorentzVector * l2, TLorentzVector * j1, TLorentzVector * j2, const std::vector<double> & parameters) {
+double KLFitter::LikelihoodTopDilepton::CalculateWeightPerm(const KLFitter::FourVector * l1, const KLFitter::FourVector * l2, const KLFitter::FourVector * j1, const KLFitter::FourVector * j2, const std::vector<double> & parameters) {
   double weight = 0.;
   int NSolutions = 0;
 
@@ -693,7 +709,7 @@ double KLFitter::LikelihoodTopDilepton::GaussAntiNuEta(std::vector<double> param
 }
 
 // ---------------------------------------------------------
-KLFitter::NuSolutions KLFitter::LikelihoodTopDilepton::SolveForNuMom(TLorentzVector * l, TLorentzVector * b, double mtop, double nueta) {
+KLFitter::NuSolutions KLFitter::LikelihoodTopDilepton::SolveForNuMom(const KLFitter::FourVector * l, const KLFitter::FourVector * b, double mtop, double nueta) {
   NuSolutions ret;
   double Wmass = fPhysicsConstants.MassW();
   double Wmass2 = Wmass*Wmass;
@@ -775,11 +791,11 @@ KLFitter::NuSolutions KLFitter::LikelihoodTopDilepton::SolveForNuMom(TLorentzVec
 }
 
 // ---------------------------------------------------------
-double KLFitter::LikelihoodTopDilepton::neutrino_weight(TLorentzVector nu, TLorentzVector nubar) {
-  static double sigmaX;
-  static double sigmaY;
-  static double dx;
-  static double dy;
+double KLFitter::LikelihoodTopDilepton::neutrino_weight(const KLFitter::FourVector & nu, const KLFitter::FourVector & nubar) {
+  double sigmaX;
+  double sigmaY;
+  double dx;
+  double dy;
 
   // MET resolution in terms of SumET
   sigmaX = fResMET->GetSigma(SumET);
@@ -1037,15 +1053,15 @@ std::vector<double> KLFitter::LikelihoodTopDilepton::LogLikelihoodComponents(std
 
 // ---------------------------------------------------------
 void KLFitter::LikelihoodTopDilepton::MCMCIterationInterface() {
-  TLorentzVector  MCMC_b1(0., 0., 0., 0.);
-  TLorentzVector  MCMC_b2(0., 0., 0., 0.);
-  TLorentzVector  MCMC_lep1(0., 0., 0., 0.);
-  TLorentzVector  MCMC_lep2(0., 0., 0., 0.);
-  TLorentzVector  MCMC_nu1(0., 0., 0., 0.);
-  TLorentzVector  MCMC_nu2(0., 0., 0., 0.);
+  KLFitter::FourVector  MCMC_b1(0., 0., 0., 0.);
+  KLFitter::FourVector  MCMC_b2(0., 0., 0., 0.);
+  KLFitter::FourVector  MCMC_lep1(0., 0., 0., 0.);
+  KLFitter::FourVector  MCMC_lep2(0., 0., 0., 0.);
+  KLFitter::FourVector  MCMC_nu1(0., 0., 0., 0.);
+  KLFitter::FourVector  MCMC_nu2(0., 0., 0., 0.);
 
-  TLorentzVector  MCMC_lep(0., 0., 0., 0.);
-  TLorentzVector  MCMC_antilep(0., 0., 0., 0.);
+  KLFitter::FourVector  MCMC_lep(0., 0., 0., 0.);
+  KLFitter::FourVector  MCMC_antilep(0., 0., 0., 0.);
 
   double scale_b1(0.);
   double scale_b2(0.);
@@ -1114,12 +1130,12 @@ void KLFitter::LikelihoodTopDilepton::MCMCIterationInterface() {
         fHistMttbar->GetHistogram()->Fill(mttbar);
         // costheta
         help_ParticleVector->clear();
-        help_ParticleVector -> push_back(MCMC_lep);
-        help_ParticleVector -> push_back(MCMC_antilep);
-        help_ParticleVector -> push_back(nus.nu1);
-        help_ParticleVector -> push_back(nubars.nu1);
-        help_ParticleVector -> push_back(MCMC_b1);
-        help_ParticleVector -> push_back(MCMC_b2);
+        help_ParticleVector -> push_back(MCMC_lep.To<TLorentzVector>());
+        help_ParticleVector -> push_back(MCMC_antilep.To<TLorentzVector>());
+        help_ParticleVector -> push_back(nus.nu1.To<TLorentzVector>());
+        help_ParticleVector -> push_back(nubars.nu1.To<TLorentzVector>());
+        help_ParticleVector -> push_back(MCMC_b1.To<TLorentzVector>());
+        help_ParticleVector -> push_back(MCMC_b2.To<TLorentzVector>());
         costheta = CalculateCosTheta(help_ParticleVector.get());
         fHistCosTheta->GetHistogram()->Fill(costheta.first);
         fHistCosTheta->GetHistogram()->Fill(costheta.second);
@@ -1132,12 +1148,12 @@ void KLFitter::LikelihoodTopDilepton::MCMCIterationInterface() {
           fHistMttbar->GetHistogram()->Fill(mttbar);
           // costheta
           help_ParticleVector->clear();
-          help_ParticleVector -> push_back(MCMC_lep);
-          help_ParticleVector -> push_back(MCMC_antilep);
-          help_ParticleVector -> push_back(nus.nu1);
-          help_ParticleVector -> push_back(nubars.nu2);
-          help_ParticleVector -> push_back(MCMC_b1);
-          help_ParticleVector -> push_back(MCMC_b2);
+          help_ParticleVector -> push_back(MCMC_lep.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_antilep.To<TLorentzVector>());
+          help_ParticleVector -> push_back(nus.nu1.To<TLorentzVector>());
+          help_ParticleVector -> push_back(nubars.nu2.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_b1.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_b2.To<TLorentzVector>());
           costheta = CalculateCosTheta(help_ParticleVector.get());
           fHistCosTheta->GetHistogram()->Fill(costheta.first);
           fHistCosTheta->GetHistogram()->Fill(costheta.second);
@@ -1149,12 +1165,12 @@ void KLFitter::LikelihoodTopDilepton::MCMCIterationInterface() {
           fHistMttbar->GetHistogram()->Fill(mttbar);
           // costheta
           help_ParticleVector->clear();
-          help_ParticleVector -> push_back(MCMC_lep);
-          help_ParticleVector -> push_back(MCMC_antilep);
-          help_ParticleVector -> push_back(nus.nu2);
-          help_ParticleVector -> push_back(nubars.nu1);
-          help_ParticleVector -> push_back(MCMC_b1);
-          help_ParticleVector -> push_back(MCMC_b2);
+          help_ParticleVector -> push_back(MCMC_lep.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_antilep.To<TLorentzVector>());
+          help_ParticleVector -> push_back(nus.nu2.To<TLorentzVector>());
+          help_ParticleVector -> push_back(nubars.nu1.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_b1.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_b2.To<TLorentzVector>());
           costheta = CalculateCosTheta(help_ParticleVector.get());
           fHistCosTheta->GetHistogram()->Fill(costheta.first);
           fHistCosTheta->GetHistogram()->Fill(costheta.second);
@@ -1166,12 +1182,12 @@ void KLFitter::LikelihoodTopDilepton::MCMCIterationInterface() {
           fHistMttbar->GetHistogram()->Fill(mttbar);
           // costheta
           help_ParticleVector->clear();
-          help_ParticleVector -> push_back(MCMC_lep);
-          help_ParticleVector -> push_back(MCMC_antilep);
-          help_ParticleVector -> push_back(nus.nu1);
-          help_ParticleVector -> push_back(nubars.nu2);
-          help_ParticleVector -> push_back(MCMC_b1);
-          help_ParticleVector -> push_back(MCMC_b2);
+          help_ParticleVector -> push_back(MCMC_lep.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_antilep.To<TLorentzVector>());
+          help_ParticleVector -> push_back(nus.nu1.To<TLorentzVector>());
+          help_ParticleVector -> push_back(nubars.nu2.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_b1.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_b2.To<TLorentzVector>());
           costheta = CalculateCosTheta(help_ParticleVector.get());
           fHistCosTheta->GetHistogram()->Fill(costheta.first);
           fHistCosTheta->GetHistogram()->Fill(costheta.second);
@@ -1183,12 +1199,12 @@ void KLFitter::LikelihoodTopDilepton::MCMCIterationInterface() {
           fHistMttbar->GetHistogram()->Fill(mttbar);
           // costheta
           help_ParticleVector->clear();
-          help_ParticleVector -> push_back(MCMC_lep);
-          help_ParticleVector -> push_back(MCMC_antilep);
-          help_ParticleVector -> push_back(nus.nu2);
-          help_ParticleVector -> push_back(nubars.nu1);
-          help_ParticleVector -> push_back(MCMC_b1);
-          help_ParticleVector -> push_back(MCMC_b2);
+          help_ParticleVector -> push_back(MCMC_lep.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_antilep.To<TLorentzVector>());
+          help_ParticleVector -> push_back(nus.nu2.To<TLorentzVector>());
+          help_ParticleVector -> push_back(nubars.nu1.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_b1.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_b2.To<TLorentzVector>());
           costheta = CalculateCosTheta(help_ParticleVector.get());
           fHistCosTheta->GetHistogram()->Fill(costheta.first);
           fHistCosTheta->GetHistogram()->Fill(costheta.second);
@@ -1200,12 +1216,12 @@ void KLFitter::LikelihoodTopDilepton::MCMCIterationInterface() {
           fHistMttbar->GetHistogram()->Fill(mttbar);
           // costheta
           help_ParticleVector->clear();
-          help_ParticleVector -> push_back(MCMC_lep);
-          help_ParticleVector -> push_back(MCMC_antilep);
-          help_ParticleVector -> push_back(nus.nu2);
-          help_ParticleVector -> push_back(nubars.nu2);
-          help_ParticleVector -> push_back(MCMC_b1);
-          help_ParticleVector -> push_back(MCMC_b2);
+          help_ParticleVector -> push_back(MCMC_lep.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_antilep.To<TLorentzVector>());
+          help_ParticleVector -> push_back(nus.nu2.To<TLorentzVector>());
+          help_ParticleVector -> push_back(nubars.nu2.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_b1.To<TLorentzVector>());
+          help_ParticleVector -> push_back(MCMC_b2.To<TLorentzVector>());
           costheta = CalculateCosTheta(help_ParticleVector.get());
           fHistCosTheta->GetHistogram()->Fill(costheta.first);
           fHistCosTheta->GetHistogram()->Fill(costheta.second);
@@ -25,6 +25,7 @@
 #include "BAT/BCMath.h"
 #include "BAT/BCParameter.h"
 #include "KLFitter/DetectorBase.h"
+#include "KLFitter/FourVector.h"
 #include "KLFitter/Particles.h"
 #include "KLFitter/Permutations.h"
 #include "KLFitter/PhysicsConstants.h"
@@ -50,6 +51,11 @@ KLFitter::LikelihoodTopLeptonJets::LikelihoodTopLeptonJets()
 // ---------------------------------------------------------
 KLFitter::LikelihoodTopLeptonJets::~LikelihoodTopLeptonJets() = default;
 
+// ---------------------------------------------------------
+std::unique_ptr<KLFitter::LikelihoodBase> KLFitter::LikelihoodTopLeptonJets::Clone() const {
+  return std::unique_ptr<KLFitter::LikelihoodBase>(new KLFitter::LikelihoodTopLeptonJets(*this));
+}
+
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTopLeptonJets::SetET_miss_XY_SumET(double etx, double ety, double sumet) {
   // set missing ET x and y component and the SumET
@@ -170,23 +176,23 @@ void KLFitter::LikelihoodTopLeptonJets::DefineParameters() {
 
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTopLeptonJets::CalculateLorentzVectors(std::vector <double> const& parameters) {
-  static double scale;
-  static double whad_fit_e;
-  static double whad_fit_px;
-  static double whad_fit_py;
-  static double whad_fit_pz;
-  static double wlep_fit_e;
-  static double wlep_fit_px;
-  static double wlep_fit_py;
-  static double wlep_fit_pz;
-  static double thad_fit_e;
-  static double thad_fit_px;
-  static double thad_fit_py;
-  static double thad_fit_pz;
-  static double tlep_fit_e;
-  static double tlep_fit_px;
-  static double tlep_fit_py;
-  static double tlep_fit_pz;
+  double scale;
+  double whad_fit_e;
+  double whad_fit_px;
+  double whad_fit_py;
+  double whad_fit_pz;
+  double wlep_fit_e;
+  double wlep_fit_px;
+  double wlep_fit_py;
+  double wlep_fit_pz;
+  double thad_fit_e;
+  double thad_fit_px;
+  double thad_fit_py;
+  double thad_fit_pz;
+  double tlep_fit_e;
+  double tlep_fit_px;
+  double tlep_fit_py;
+  double tlep_fit_pz;
 
   // hadronic b quark
   bhad_fit_e = parameters[parBhadE];
@@ -437,6 +443,151 @@ double KLFitter::LikelihoodTopLeptonJets::LogLikelihood(const std::vector<double
   return logprob;
 }
 
+// ---------------------------------------------------------
+double KLFitter::LikelihoodTopLeptonJets::LogLikelihoodGradient(const std::vector<double> & parameters, std::vector<double>* gradient) {
+  // the likelihood also calculates the 4-vectors
+  double logprob = LogLikelihood(parameters);
+
+  gradient->assign(parameters.size(), 0.);
+  std::vector<double>& grad = *gradient;
+
+  // the TF terms only depend on their own parameter
+  bool TFgoodTmp(true);
+  grad[parBhadE] = fResEnergyBhad->LogPDerivative(bhad_fit_e, bhad_meas_e, &TFgoodTmp);
+  grad[parBlepE] = fResEnergyBlep->LogPDerivative(blep_fit_e, blep_meas_e, &TFgoodTmp);
+  grad[parLQ1E] = fResEnergyLQ1->LogPDerivative(lq1_fit_e, lq1_meas_e, &TFgoodTmp);
+  grad[parLQ2E] = fResEnergyLQ2->LogPDerivative(lq2_fit_e, lq2_meas_e, &TFgoodTmp);
+  if (fTypeLepton == kElectron) {
+    grad[parLepE] = fResLepton->LogPDerivative(lep_fit_e, lep_meas_e, &TFgoodTmp);
+  } else if (fTypeLepton == kMuon) {
+    grad[parLepE] = fResLepton->LogPDerivative(lep_fit_e* lep_meas_sintheta, lep_meas_pt, &TFgoodTmp) * lep_meas_sintheta;
+  }
+  grad[parNuPx] = fResMET->LogPDerivative(nu_fit_px, ETmiss_x, &TFgoodTmp, SumET);
+  grad[parNuPy] = fResMET->LogPDerivative(nu_fit_py, ETmiss_y, &TFgoodTmp, SumET);
+
+  // derivatives of the 4-vectors of the final state particles with
+  // respect to their parameters (the directions of the measured
+  // particles are fixed)
+  const KLFitter::FourVector bhad(bhad_fit_px, bhad_fit_py, bhad_fit_pz, bhad_fit_e);
+  const KLFitter::FourVector blep(blep_fit_px, blep_fit_py, blep_fit_pz, blep_fit_e);
+  const KLFitter::FourVector lq1(lq1_fit_px, lq1_fit_py, lq1_fit_pz, lq1_fit_e);
+  const KLFitter::FourVector lq2(lq2_fit_px, lq2_fit_py, lq2_fit_pz, lq2_fit_e);
+  const KLFitter::FourVector lep(lep_fit_px, lep_fit_py, lep_fit_pz, lep_fit_e);
+  const KLFitter::FourVector nu(nu_fit_px, nu_fit_py, nu_fit_pz, nu_fit_e);
+  auto dQuark = [](const KLFitter::FourVector& fit, double px, double py, double pz, double p) {
+    const double scale = fit.E() / (fit.P() * p);
+    return KLFitter::FourVector(scale * px, scale * py, scale * pz, 1.);
+  };
+  const KLFitter::FourVector dbhad = dQuark(bhad, bhad_meas_px, bhad_meas_py, bhad_meas_pz, bhad_meas_p);
+  const KLFitter::FourVector dblep = dQuark(blep, blep_meas_px, blep_meas_py, blep_meas_pz, blep_meas_p);
+  const KLFitter::FourVector dlq1 = dQuark(lq1, lq1_meas_px, lq1_meas_py, lq1_meas_pz, lq1_meas_p);
+  const KLFitter::FourVector dlq2 = dQuark(lq2, lq2_meas_px, lq2_meas_py, lq2_meas_pz, lq2_meas_p);
+  const KLFitter::FourVector dlep = KLFitter::FourVector(lep_meas_px, lep_meas_py, lep_meas_pz, lep_meas_e) * (1. / lep_meas_e);
+  const KLFitter::FourVector dnupx(1., 0., 0., nu_fit_px / nu_fit_e);
+  const KLFitter::FourVector dnupy(0., 1., 0., nu_fit_py / nu_fit_e);
+  const KLFitter::FourVector dnupz(0., 0., 1., nu_fit_pz / nu_fit_e);
+
+  // the derivative of the invariant mass of a system v is v*dv/m
+  const KLFitter::FourVector whad = lq1 + lq2;
+  const KLFitter::FourVector wlep = lep + nu;
+  const KLFitter::FourVector thad = whad + bhad;
+  const KLFitter::FourVector tlep = wlep + blep;
+
+  // physics constants
+  double massW = fPhysicsConstants.MassW();
+  double gammaW = fPhysicsConstants.GammaW();
+  double gammaTop = fPhysicsConstants.GammaTop();
+  double massTop = parameters[parTopM];
+
+  // derivatives of log BW(m) = -log((m^2-M^2)^2 + M^2*Gamma^2)
+  // with respect to m, divided by m, and with respect to M
+  auto dLogBW = [](double m, double mass, double gamma) {
+    double d = (m*m - mass*mass) * (m*m - mass*mass) + mass*mass*gamma*gamma;
+    return -4. * (m*m - mass*mass) / d;
+  };
+  auto dLogBWMass = [](double m, double mass, double gamma) {
+    double d = (m*m - mass*mass) * (m*m - mass*mass) + mass*mass*gamma*gamma;
+    return (4. * mass * (m*m - mass*mass) - 2. * mass * gamma*gamma) / d;
+  };
+
+  // with dm = v*dv/m, the factor m cancels
+  const KLFitter::FourVector bwhad = whad * dLogBW(whad_fit_m, massW, gammaW);
+  const KLFitter::FourVector bwlep = wlep * dLogBW(wlep_fit_m, massW, gammaW);
+  const KLFitter::FourVector bthad = thad * dLogBW(thad_fit_m, massTop, gammaTop);
+  const KLFitter::FourVector btlep = tlep * dLogBW(tlep_fit_m, massTop, gammaTop);
+
+  grad[parBhadE] += bthad * dbhad;
+  grad[parBlepE] += btlep * dblep;
+  grad[parLQ1E] += (bwhad + bthad) * dlq1;
+  grad[parLQ2E] += (bwhad + bthad) * dlq2;
+  grad[parLepE] += (bwlep + btlep) * dlep;
+  grad[parNuPx] += (bwlep + btlep) * dnupx;
+  grad[parNuPy] += (bwlep + btlep) * dnupy;
+  grad[parNuPz] += (bwlep + btlep) * dnupz;
+  grad[parTopM] = dLogBWMass(thad_fit_m, massTop, gammaTop) + dLogBWMass(tlep_fit_m, massTop, gammaTop);
+
+  // return log of likelihood
+  return logprob;
+}
+
+// ---------------------------------------------------------
+double KLFitter::LikelihoodTopLeptonJets::LogLikelihoodUpperBound() {
+  double logprob(0.);
+
+  // jet energy resolution terms
+  logprob += log(fResEnergyBhad->GetPMax(ParMin(parBhadE), ParMax(parBhadE)));
+  logprob += log(fResEnergyBlep->GetPMax(ParMin(parBlepE), ParMax(parBlepE)));
+  logprob += log(fResEnergyLQ1->GetPMax(ParMin(parLQ1E), ParMax(parLQ1E)));
+  logprob += log(fResEnergyLQ2->GetPMax(ParMin(parLQ2E), ParMax(parLQ2E)));
+
+  // lepton energy resolution terms
+  if (fTypeLepton == kElectron) {
+    logprob += log(fResLepton->GetPMax(ParMin(parLepE), ParMax(parLepE)));
+  } else if (fTypeLepton == kMuon) {
+    logprob += log(fResLepton->GetPMax(ParMin(parLepE) * lep_meas_sintheta, ParMax(parLepE) * lep_meas_sintheta));
+  }
+
+  // neutrino px and py
+  logprob += 2. * log(fResMET->GetPMax(ParMin(parNuPx), ParMax(parNuPx), SumET));
+
+  // Breit-Wigner of the hadronic W: the dijet mass is monotonic in
+  // both light quark energies if E1/p1 * cos(angle) <= 1 at the lower
+  // limits (and likewise for the second quark). Its range then follows
+  // from the parameter limits and the Breit-Wigner is bounded by its
+  // value at the reachable mass closest to the W mass.
+  double massW = fPhysicsConstants.MassW();
+  double gammaW = fPhysicsConstants.GammaW();
+  double mwhad = massW;
+  double cosangle = (lq1_meas_px * lq2_meas_px + lq1_meas_py * lq2_meas_py + lq1_meas_pz * lq2_meas_pz) / (lq1_meas_p * lq2_meas_p);
+  auto momentum = [](double e, double m) { return sqrt(std::max(0., e * e - m * m)); };
+  auto dijetmass = [&](double e1, double e2) {
+    return sqrt(std::max(0., lq1_meas_m * lq1_meas_m + lq2_meas_m * lq2_meas_m
+                         + 2. * (e1 * e2 - momentum(e1, lq1_meas_m) * momentum(e2, lq2_meas_m) * cosangle)));
+  };
+  double p1min = momentum(ParMin(parLQ1E), lq1_meas_m);
+  double p2min = momentum(ParMin(parLQ2E), lq2_meas_m);
+  if (cosangle <= 0 || (cosangle * ParMin(parLQ1E) <= p1min && cosangle * ParMin(parLQ2E) <= p2min)) {
+    double mmin = dijetmass(ParMin(parLQ1E), ParMin(parLQ2E));
+    double mmax = dijetmass(ParMax(parLQ1E), ParMax(parLQ2E));
+    mwhad = std::min(std::max(massW, mmin), mmax);
+  }
+  logprob += BCMath::LogBreitWignerRel(mwhad, massW, gammaW);
+
+  // Breit-Wigner peak of the leptonic W
+  logprob += BCMath::LogBreitWignerRel(massW, massW, gammaW);
+
+  // Breit-Wigner peaks of the top quarks, the peak value decreases
+  // with the top mass
+  double gammaTop = fPhysicsConstants.GammaTop();
+  double mtopmin = ParMin(parTopM);
+  double mtopmax = ParMax(parTopM);
+  logprob += 2. * std::max(BCMath::LogBreitWignerRel(mtopmin, mtopmin, gammaTop),
+                           BCMath::LogBreitWignerRel(mtopmax, mtopmax, gammaTop));
+
+  // return upper bound of log of likelihood
+  return logprob;
+}
+
 // ---------------------------------------------------------
 std::vector<double> KLFitter::LikelihoodTopLeptonJets::GetInitialParameters() {
   std::vector<double> values(GetInitialParametersWoNeutrinoPz());
@@ -42,11 +42,20 @@ KLFitter::LikelihoodTopLeptonJetsUDSep::LikelihoodTopLeptonJetsUDSep()
 
   // define parameters
   this->DefineParameters();
+
+  // the kinematic likelihood is invariant under the exchange of the
+  // light quarks, which differ only in the up/down-type separation
+  AddLHInvariance(KLFitter::Particles::kParton, 2, 3, {{parLQ1E, parLQ2E}});
   }
 
 // ---------------------------------------------------------
 KLFitter::LikelihoodTopLeptonJetsUDSep::~LikelihoodTopLeptonJetsUDSep() = default;
 
+// ---------------------------------------------------------
+std::unique_ptr<KLFitter::LikelihoodBase> KLFitter::LikelihoodTopLeptonJetsUDSep::Clone() const {
+  return std::unique_ptr<KLFitter::LikelihoodBase>(new KLFitter::LikelihoodTopLeptonJetsUDSep(*this));
+}
+
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTopLeptonJetsUDSep::DefineModelParticles() {
   // create the particles of the model
@@ -157,7 +166,7 @@ int KLFitter::LikelihoodTopLeptonJetsUDSep::RemoveInvariantParticlePermutations(
 }
 
 // ---------------------------------------------------------
-double KLFitter::LikelihoodTopLeptonJetsUDSep::LogEventProbability() {
+double KLFitter::LikelihoodTopLeptonJetsUDSep::LogEventProbability(double loglikelihood) {
   double logprob = 0;
   if (fBTagMethod != kNotag) {
     double logprobbtag = LogEventProbabilityBTag();
@@ -174,7 +183,19 @@ double KLFitter::LikelihoodTopLeptonJetsUDSep::LogEventProbability() {
   if (fFlagIntegrate) {
     logprob += log(GetIntegral());
   } else {
-    logprob += LogLikelihood(GetBestFitParameters());
+    logprob += loglikelihood;
+  }
+  return logprob;
+}
+
+// ---------------------------------------------------------
+double KLFitter::LikelihoodTopLeptonJetsUDSep::LogEventProbabilityUpperBound() {
+  double logprob = KLFitter::LikelihoodTopLeptonJets::LogEventProbabilityUpperBound();
+  if (logprob <= -1e99) return -1e99;
+  if (fLJetSeparationMethod != kNone) {
+    double logprobljetweight = LogEventProbabilityLJetReweight();
+    if (logprobljetweight <= -1e99) return -1e99;
+    logprob += logprobljetweight;
   }
   return logprob;
 }
@@ -361,31 +382,3 @@ double KLFitter::LikelihoodTopLeptonJetsUDSep::DownJetProb(double tagweight, dou
 double KLFitter::LikelihoodTopLeptonJetsUDSep::BJetProb(double tagweight, double pt) {
   return fBJet2DWeightHisto->GetBinContent(fBJet2DWeightHisto->GetXaxis()->FindBin(tagweight), fBJet2DWeightHisto->GetYaxis()->FindBin(pt));
 }
-
-// ---------------------------------------------------------
-int KLFitter::LikelihoodTopLeptonJetsUDSep::LHInvariantPermutationPartner(int iperm, int nperms, int *switchpar1, int *switchpar2) {
-  int partnerid = -1;
-  int cache = iperm%6;
-  switch (nperms) {
-  case 24:
-    if ((iperm)%2) {
-      partnerid = (iperm -1);
-    } else {
-      partnerid = (iperm+1);
-    }
-    break;
-
-  case 120:
-    if (cache > 2) {
-      partnerid = (iperm -3);
-    } else {
-      partnerid = (iperm+3);
-    }
-    break;
-
-  default: partnerid = -1;
-  }
-  *switchpar1 = 2;
-  *switchpar2 = 3;
-  return partnerid;
-}
@@ -25,6 +25,7 @@
 #include "BAT/BCMath.h"
 #include "BAT/BCParameter.h"
 #include "KLFitter/DetectorBase.h"
+#include "KLFitter/FourVector.h"
 #include "KLFitter/Particles.h"
 #include "KLFitter/Permutations.h"
 #include "KLFitter/PhysicsConstants.h"
@@ -49,6 +50,11 @@ KLFitter::LikelihoodTopLeptonJets_Angular::LikelihoodTopLeptonJets_Angular()
 // ---------------------------------------------------------
 KLFitter::LikelihoodTopLeptonJets_Angular::~LikelihoodTopLeptonJets_Angular() = default;
 
+// ---------------------------------------------------------
+std::unique_ptr<KLFitter::LikelihoodBase> KLFitter::LikelihoodTopLeptonJets_Angular::Clone() const {
+  return std::unique_ptr<KLFitter::LikelihoodBase>(new KLFitter::LikelihoodTopLeptonJets_Angular(*this));
+}
+
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTopLeptonJets_Angular::SetET_miss_XY_SumET(double etx, double ety, double sumet) {
   // set missing ET x and y component and the SumET
@@ -169,15 +175,15 @@ void KLFitter::LikelihoodTopLeptonJets_Angular::DefineParameters() {
 
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTopLeptonJets_Angular::CalculateLorentzVectors(std::vector <double> const& parameters) {
-  static double scale;
-  static double thad_fit_e;
-  static double thad_fit_px;
-  static double thad_fit_py;
-  static double thad_fit_pz;
-  static double tlep_fit_e;
-  static double tlep_fit_px;
-  static double tlep_fit_py;
-  static double tlep_fit_pz;
+  double scale;
+  double thad_fit_e;
+  double thad_fit_px;
+  double thad_fit_py;
+  double thad_fit_pz;
+  double tlep_fit_e;
+  double tlep_fit_px;
+  double tlep_fit_py;
+  double tlep_fit_pz;
 
   // hadronic b quark
   bhad_fit_e = parameters[parBhadE];
@@ -418,45 +424,23 @@ double KLFitter::LikelihoodTopLeptonJets_Angular::LogLikelihood(const std::vecto
   // angular information of leptonic decay
 
   // create 4-vector for leptonically decaying W boson, charge lepton and corresponding b quark
-  TLorentzVector Wlep(wlep_fit_px, wlep_fit_py, wlep_fit_pz, wlep_fit_e);
-  TLorentzVector Whad(whad_fit_px, whad_fit_py, whad_fit_pz, whad_fit_e);
-  TLorentzVector lep(lep_fit_px,  lep_fit_py,  lep_fit_pz,  lep_fit_e);
-  TLorentzVector blep(blep_fit_px, blep_fit_py, blep_fit_pz, blep_fit_e);
-  TLorentzVector bhad(bhad_fit_px, bhad_fit_py, bhad_fit_pz, bhad_fit_e);
-  TLorentzVector lq1(lq1_fit_px, lq1_fit_py, lq1_fit_pz, lq1_fit_e);
-  TLorentzVector lq2(lq2_fit_px, lq2_fit_py, lq2_fit_pz, lq2_fit_e);
-
-  // get boost vectors
-  TVector3  Wlep_bo(0.0, 0.0, 0.0);
-  Wlep_bo = Wlep.BoostVector();
-
-  TVector3  Whad_bo(0.0, 0.0, 0.0);
-  Whad_bo = Whad.BoostVector();
+  KLFitter::FourVector Wlep(wlep_fit_px, wlep_fit_py, wlep_fit_pz, wlep_fit_e);
+  KLFitter::FourVector Whad(whad_fit_px, whad_fit_py, whad_fit_pz, whad_fit_e);
+  KLFitter::FourVector lep(lep_fit_px,  lep_fit_py,  lep_fit_pz,  lep_fit_e);
+  KLFitter::FourVector blep(blep_fit_px, blep_fit_py, blep_fit_pz, blep_fit_e);
+  KLFitter::FourVector bhad(bhad_fit_px, bhad_fit_py, bhad_fit_pz, bhad_fit_e);
+  KLFitter::FourVector lq2(lq2_fit_px, lq2_fit_py, lq2_fit_pz, lq2_fit_e);
 
   // boost everything into W rest frames
-  blep.Boost(-Wlep_bo);
-  lep.Boost(-Wlep_bo);
-
-  bhad.Boost(-Whad_bo);
-  lq1.Boost(-Whad_bo);
-  lq2.Boost(-Whad_bo);
-
-  // calculate 3-vectors
-  TVector3 lep3(0.0, 0.0, 0.0);
-  TVector3 blep3(0.0, 0.0, 0.0);
-  TVector3 bhad3(0.0, 0.0, 0.0);
-  TVector3 lq13(0.0, 0.0, 0.0);
-  TVector3 lq23(0.0, 0.0, 0.0);
-
-  lep3.SetXYZ(lep.Px(),  lep.Py(),  lep.Pz());
-  blep3.SetXYZ(blep.Px(), blep.Py(), blep.Pz());
-  bhad3.SetXYZ(bhad.Px(), bhad.Py(), bhad.Pz());
-  lq13.SetXYZ(lq1.Px(), lq1.Py(), lq1.Pz());
-  lq23.SetXYZ(lq2.Px(), lq2.Py(), lq2.Pz());
+  blep.BoostToRestFrame(Wlep);
+  lep.BoostToRestFrame(Wlep);
+
+  bhad.BoostToRestFrame(Whad);
+  lq2.BoostToRestFrame(Whad);
 
   // calculate cos theta *
-  double cos_theta     = cos(lep3.Angle(-blep3));
-  double cos_theta_had = cos(lq23.Angle(-bhad3));
+  double cos_theta     = cos(lep.Angle(-blep));
+  double cos_theta_had = cos(lq2.Angle(-bhad));
 
   // fix helicity fractions
   double F0 = 0.687;
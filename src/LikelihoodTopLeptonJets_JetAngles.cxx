@@ -24,6 +24,7 @@
 
 #include "BAT/BCMath.h"
 #include "BAT/BCParameter.h"
+#include "KLFitter/FourVector.h"
 #include "KLFitter/ResolutionBase.h"
 #include "KLFitter/Particles.h"
 #include "KLFitter/Permutations.h"
@@ -51,6 +52,11 @@ KLFitter::LikelihoodTopLeptonJets_JetAngles::LikelihoodTopLeptonJets_JetAngles()
 // ---------------------------------------------------------
 KLFitter::LikelihoodTopLeptonJets_JetAngles::~LikelihoodTopLeptonJets_JetAngles() = default;
 
+// ---------------------------------------------------------
+std::unique_ptr<KLFitter::LikelihoodBase> KLFitter::LikelihoodTopLeptonJets_JetAngles::Clone() const {
+  return std::unique_ptr<KLFitter::LikelihoodBase>(new KLFitter::LikelihoodTopLeptonJets_JetAngles(*this));
+}
+
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTopLeptonJets_JetAngles::SetET_miss_XY_SumET(double etx, double ety, double sumet) {
   // set missing ET x and y component and the SumET
@@ -179,25 +185,25 @@ void KLFitter::LikelihoodTopLeptonJets_JetAngles::DefineParameters() {
 
 // ---------------------------------------------------------
 int KLFitter::LikelihoodTopLeptonJets_JetAngles::CalculateLorentzVectors(std::vector <double> const& parameters) {
-  static double scale;
-  static double whad_fit_e;
-  static double whad_fit_px;
-  static double whad_fit_py;
-  static double whad_fit_pz;
-  static double wlep_fit_e;
-  static double wlep_fit_px;
-  static double wlep_fit_py;
-  static double wlep_fit_pz;
-  static double thad_fit_e;
-  static double thad_fit_px;
-  static double thad_fit_py;
-  static double thad_fit_pz;
-  static double tlep_fit_e;
-  static double tlep_fit_px;
-  static double tlep_fit_py;
-  static double tlep_fit_pz;
-
-  static TLorentzVector v;
+  double scale;
+  double whad_fit_e;
+  double whad_fit_px;
+  double whad_fit_py;
+  double whad_fit_pz;
+  double wlep_fit_e;
+  double wlep_fit_px;
+  double wlep_fit_py;
+  double wlep_fit_pz;
+  double thad_fit_e;
+  double thad_fit_px;
+  double thad_fit_py;
+  double thad_fit_pz;
+  double tlep_fit_e;
+  double tlep_fit_px;
+  double tlep_fit_py;
+  double tlep_fit_pz;
+
+  KLFitter::FourVector v;
 
   // hadronic b quark
   v.SetPtEtaPhiE(sqrt(parameters[parBhadE]*parameters[parBhadE]-bhad_meas_m*bhad_meas_m)/cosh(parameters[parBhadEta]), parameters[parBhadEta], parameters[parBhadPhi], parameters[parBhadE]);
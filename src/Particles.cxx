@@ -19,151 +19,35 @@
 
 #include "KLFitter/Particles.h"
 
+#include <deque>
 #include <iostream>
+#include <unordered_map>
 
 #include "TLorentzVector.h"
 
-// ---------------------------------------------------------
-KLFitter::Particles::Particles() = default;
-
-// ---------------------------------------------------------
-KLFitter::Particles::Particles(const KLFitter::Particles& o) :
-    fNamePartons(std::vector<std::string>{o.fNamePartons}),
-    fNameElectrons(std::vector<std::string>{o.fNameElectrons}),
-    fNameMuons(std::vector<std::string>{o.fNameMuons}),
-    fNameTaus(std::vector<std::string>{o.fNameTaus}),
-    fNameNeutrinos(std::vector<std::string>{o.fNameNeutrinos}),
-    fNameBosons(std::vector<std::string>{o.fNameBosons}),
-    fNamePhotons(std::vector<std::string>{o.fNamePhotons}),
-    fJetIndex(std::vector<int>{o.fJetIndex}),
-    fElectronIndex(std::vector<int>{o.fElectronIndex}),
-    fMuonIndex(std::vector<int>{o.fMuonIndex}),
-    fPhotonIndex(std::vector<int>{o.fPhotonIndex}),
-    fTrueFlavor(std::vector<TrueFlavorType>{o.fTrueFlavor}),
-    fIsBTagged(std::vector<bool>{o.fIsBTagged}),
-    fBTaggingEfficiency(std::vector<double>{o.fBTaggingEfficiency}),
-    fBTaggingRejection(std::vector<double>{o.fBTaggingRejection}),
-    fBTagWeight(std::vector<double>{o.fBTagWeight}),
-    fBTagWeightSet(std::vector<bool>{o.fBTagWeightSet}),
-    fElectronDetEta(std::vector<double>{o.fElectronDetEta}),
-    fMuonDetEta(std::vector<double>{o.fMuonDetEta}),
-    fJetDetEta(std::vector<double>{o.fJetDetEta}),
-    fPhotonDetEta(std::vector<double>{o.fPhotonDetEta}),
-    fElectronCharge(std::vector<float>{o.fElectronCharge}),
-    fMuonCharge(std::vector<float>{o.fMuonCharge}) {
-
-  // Make deep copies of the vectors of unique pointers.
-  fPartons.reserve(o.fPartons.size());
-  for (const auto& i : o.fPartons) {
-    fPartons.emplace_back(new TLorentzVector{*i});
-  }
-
-  fElectrons.reserve(o.fElectrons.size());
-  for (const auto& i : o.fElectrons) {
-    fElectrons.emplace_back(new TLorentzVector{*i});
-  }
-
-  fMuons.reserve(o.fMuons.size());
-  for (const auto& i : o.fMuons) {
-    fMuons.emplace_back(new TLorentzVector{*i});
-  }
+//! The interned names of the particles
+struct KLFitter::Particles::NameTable {
+  std::deque<std::string> names;
+  std::unordered_map<std::string, int> handles;
+};
 
-  fTaus.reserve(o.fTaus.size());
-  for (const auto& i : o.fTaus) {
-    fTaus.emplace_back(new TLorentzVector{*i});
-  }
-
-  fNeutrinos.reserve(o.fNeutrinos.size());
-  for (const auto& i : o.fNeutrinos) {
-    fNeutrinos.emplace_back(new TLorentzVector{*i});
-  }
+// ---------------------------------------------------------
+KLFitter::Particles::Particles() : fNameLocationsValid(true) { }
 
-  fBosons.reserve(o.fBosons.size());
-  for (const auto& i : o.fBosons) {
-    fBosons.emplace_back(new TLorentzVector{*i});
-  }
+// ---------------------------------------------------------
+KLFitter::Particles::Particles(const KLFitter::Particles& o) = default;
 
-  fPhotons.reserve(o.fPhotons.size());
-  for (const auto& i : o.fPhotons) {
-    fPhotons.emplace_back(new TLorentzVector{*i});
-  }
-}
+// ---------------------------------------------------------
+KLFitter::Particles::Particles(KLFitter::Particles&& o) noexcept = default;
 
 // ---------------------------------------------------------
 KLFitter::Particles::~Particles() = default;
 
 // ---------------------------------------------------------
-KLFitter::Particles& KLFitter::Particles::operator=(const KLFitter::Particles& o) {
-  fNamePartons = o.fNamePartons;
-  fNameElectrons = o.fNameElectrons;
-  fNameMuons = o.fNameMuons;
-  fNameTaus = o.fNameTaus;
-  fNameNeutrinos = o.fNameNeutrinos;
-  fNameBosons = o.fNameBosons;
-  fNamePhotons = o.fNamePhotons;
-
-  fJetIndex = o.fJetIndex;
-  fElectronIndex = o.fElectronIndex;
-  fMuonIndex = o.fMuonIndex;
-  fPhotonIndex = o.fPhotonIndex;
-  fTrueFlavor = o.fTrueFlavor;
-  fIsBTagged = o.fIsBTagged;
-  fBTaggingEfficiency = o.fBTaggingEfficiency;
-  fBTaggingRejection = o.fBTaggingRejection;
-  fBTagWeight = o.fBTagWeight;
-  fBTagWeightSet = o.fBTagWeightSet;
-  fElectronDetEta = o.fElectronDetEta;
-  fMuonDetEta = o.fMuonDetEta;
-  fJetDetEta = o.fJetDetEta;
-  fPhotonDetEta = o.fPhotonDetEta;
-  fElectronCharge = o.fElectronCharge;
-  fMuonCharge = o.fMuonCharge;
-
-  // Make deep copies of the vectors of unique pointers.
-  fPartons = std::vector<std::unique_ptr<TLorentzVector> >{};
-  fPartons.reserve(o.fPartons.size());
-  for (const auto& i : o.fPartons) {
-    fPartons.emplace_back(new TLorentzVector{*i});
-  }
-
-  fElectrons = std::vector<std::unique_ptr<TLorentzVector> >{};
-  fElectrons.reserve(o.fElectrons.size());
-  for (const auto& i : o.fElectrons) {
-    fElectrons.emplace_back(new TLorentzVector{*i});
-  }
-
-  fMuons = std::vector<std::unique_ptr<TLorentzVector> >{};
-  fMuons.reserve(o.fMuons.size());
-  for (const auto& i : o.fMuons) {
-    fMuons.emplace_back(new TLorentzVector{*i});
-  }
-
-  fTaus = std::vector<std::unique_ptr<TLorentzVector> >{};
-  fTaus.reserve(o.fTaus.size());
-  for (const auto& i : o.fTaus) {
-    fTaus.emplace_back(new TLorentzVector{*i});
-  }
+KLFitter::Particles& KLFitter::Particles::operator=(const KLFitter::Particles& o) = default;
 
-  fNeutrinos = std::vector<std::unique_ptr<TLorentzVector> >{};
-  fNeutrinos.reserve(o.fNeutrinos.size());
-  for (const auto& i : o.fNeutrinos) {
-    fNeutrinos.emplace_back(new TLorentzVector{*i});
-  }
-
-  fBosons = std::vector<std::unique_ptr<TLorentzVector> >{};
-  fBosons.reserve(o.fBosons.size());
-  for (const auto& i : o.fBosons) {
-    fBosons.emplace_back(new TLorentzVector{*i});
-  }
-
-  fPhotons = std::vector<std::unique_ptr<TLorentzVector> >{};
-  fPhotons.reserve(o.fPhotons.size());
-  for (const auto& i : o.fPhotons) {
-    fPhotons.emplace_back(new TLorentzVector{*i});
-  }
-
-  return *this;
-}
+// ---------------------------------------------------------
+KLFitter::Particles& KLFitter::Particles::operator=(KLFitter::Particles&& o) noexcept = default;
 
 // ---------------------------------------------------------
 int KLFitter::Particles::AddParticle(TLorentzVector * particle, double DetEta, float LepCharge, KLFitter::Particles::ParticleType ptype, std::string name, int measuredindex) {
@@ -188,10 +72,15 @@ int KLFitter::Particles::AddParticle(TLorentzVector * particle, double DetEta, f
   // check if particle with name exists already
   if (!FindParticle(name, vect, &index, &temptype)) {
     // add particle
-    // create pointer copy of particle content which is owend by Particles
-    std::unique_ptr<TLorentzVector> cparticle{new TLorentzVector{particle->Px(), particle->Py(), particle->Pz(), particle->E()}};
-    container->emplace_back(std::move(cparticle));
-    ParticleNameContainer(ptype)->push_back(name);
+    // copy the particle content, which is owned by Particles
+    container->emplace_back(particle->Px(), particle->Py(), particle->Pz(), particle->E());
+    int handle = InternName(name);
+    ParticleNameContainer(ptype)->push_back(handle);
+    if (fNameLocationsValid) {
+      if (handle >= static_cast<int>(fNameLocations.size()))
+        fNameLocations.resize(handle + 1, std::make_pair(-1, -1));
+      fNameLocations[handle] = std::make_pair(static_cast<int>(ptype), static_cast<int>(container->size()) - 1);
+    }
     if (ptype == KLFitter::Particles::kElectron) {
       fElectronIndex.push_back(measuredindex);
       fElectronDetEta.push_back(DetEta);
@@ -241,10 +130,15 @@ int KLFitter::Particles::AddParticle(TLorentzVector * particle, double DetEta, K
   // check if particle with name exists already
   if (!FindParticle(name, vect, &index, &temptype)) {
     // add particle
-    // create pointer copy of particle content which is owend by Particles
-    std::unique_ptr<TLorentzVector> cparticle{new TLorentzVector{particle->Px(), particle->Py(), particle->Pz(), particle->E()}};
-    container->emplace_back(std::move(cparticle));
-    ParticleNameContainer(ptype)->push_back(name);
+    // copy the particle content, which is owned by Particles
+    container->emplace_back(particle->Px(), particle->Py(), particle->Pz(), particle->E());
+    int handle = InternName(name);
+    ParticleNameContainer(ptype)->push_back(handle);
+    if (fNameLocationsValid) {
+      if (handle >= static_cast<int>(fNameLocations.size()))
+        fNameLocations.resize(handle + 1, std::make_pair(-1, -1));
+      fNameLocations[handle] = std::make_pair(static_cast<int>(ptype), static_cast<int>(container->size()) - 1);
+    }
     if (ptype == KLFitter::Particles::kParton) {
       fTrueFlavor.push_back(trueflav);
       fIsBTagged.push_back(isBtagged);
@@ -310,9 +204,33 @@ int KLFitter::Particles::RemoveParticle(int index, KLFitter::Particles::Particle
   if (!CheckIndex(ParticleContainer(ptype), index))
     return 0;
 
-  // remove particle
+  // remove particle and its properties
   ParticleContainer(ptype)->erase(ParticleContainer(ptype)->begin() + index);
   ParticleNameContainer(ptype)->erase(ParticleNameContainer(ptype)->begin() + index);
+  fNameLocationsValid = false;
+  if (ptype == KLFitter::Particles::kParton) {
+    fTrueFlavor.erase(fTrueFlavor.begin() + index);
+    fIsBTagged.erase(fIsBTagged.begin() + index);
+    fBTaggingEfficiency.erase(fBTaggingEfficiency.begin() + index);
+    fBTaggingRejection.erase(fBTaggingRejection.begin() + index);
+    fJetIndex.erase(fJetIndex.begin() + index);
+    fJetDetEta.erase(fJetDetEta.begin() + index);
+    fBTagWeight.erase(fBTagWeight.begin() + index);
+    fBTagWeightSet.erase(fBTagWeightSet.begin() + index);
+  } else if (ptype == KLFitter::Particles::kElectron) {
+    fElectronIndex.erase(fElectronIndex.begin() + index);
+    fElectronDetEta.erase(fElectronDetEta.begin() + index);
+    if (index < static_cast<int>(fElectronCharge.size()))
+      fElectronCharge.erase(fElectronCharge.begin() + index);
+  } else if (ptype == KLFitter::Particles::kMuon) {
+    fMuonIndex.erase(fMuonIndex.begin() + index);
+    fMuonDetEta.erase(fMuonDetEta.begin() + index);
+    if (index < static_cast<int>(fMuonCharge.size()))
+      fMuonCharge.erase(fMuonCharge.begin() + index);
+  } else if (ptype == KLFitter::Particles::kPhoton) {
+    fPhotonIndex.erase(fPhotonIndex.begin() + index);
+    fPhotonDetEta.erase(fPhotonDetEta.begin() + index);
+  }
 
   // no error
   return 1;
@@ -334,6 +252,76 @@ int KLFitter::Particles::RemoveParticle(std::string name) {
   }
 }
 
+// ---------------------------------------------------------
+void KLFitter::Particles::Clear() {
+  for (KLFitter::Particles::ParticleType ptype = kParton; ptype <= kPhoton; ++ptype) {
+    ParticleContainer(ptype)->clear();
+    ParticleNameContainer(ptype)->clear();
+  }
+  fJetIndex.clear();
+  fElectronIndex.clear();
+  fMuonIndex.clear();
+  fPhotonIndex.clear();
+  fTrueFlavor.clear();
+  fIsBTagged.clear();
+  fBTaggingEfficiency.clear();
+  fBTaggingRejection.clear();
+  fBTagWeight.clear();
+  fBTagWeightSet.clear();
+  fElectronDetEta.clear();
+  fMuonDetEta.clear();
+  fJetDetEta.clear();
+  fPhotonDetEta.clear();
+  fElectronCharge.clear();
+  fMuonCharge.clear();
+
+  // the name table is released, as it may be shared
+  fNameTable.reset();
+  fNameLocations.clear();
+  fNameLocationsValid = true;
+}
+
+// ---------------------------------------------------------
+int KLFitter::Particles::CopyParticle(int index, KLFitter::Particles::ParticleType ptype, KLFitter::Particles* source, int sourceindex) {
+  // check containers and indices
+  if (!source || !CheckIndex(ParticleContainer(ptype), index) || !source->CheckIndex(source->ParticleContainer(ptype), sourceindex))
+    return 0;
+
+  // copy particle
+  (*ParticleContainer(ptype))[index] = (*source->ParticleContainer(ptype))[sourceindex];
+  int handle = (*source->ParticleNameContainer(ptype))[sourceindex];
+  if (source->fNameTable != fNameTable)
+    handle = InternName(source->fNameTable->names[handle]);
+  (*ParticleNameContainer(ptype))[index] = handle;
+  fNameLocationsValid = false;
+  if (ptype == KLFitter::Particles::kParton) {
+    fTrueFlavor[index] = source->fTrueFlavor[sourceindex];
+    fIsBTagged[index] = source->fIsBTagged[sourceindex];
+    fBTaggingEfficiency[index] = source->fBTaggingEfficiency[sourceindex];
+    fBTaggingRejection[index] = source->fBTaggingRejection[sourceindex];
+    fJetIndex[index] = source->fJetIndex[sourceindex];
+    fJetDetEta[index] = source->fJetDetEta[sourceindex];
+    fBTagWeight[index] = source->fBTagWeight[sourceindex];
+    fBTagWeightSet[index] = fBTagWeight[index] != 999;
+  } else if (ptype == KLFitter::Particles::kElectron) {
+    fElectronIndex[index] = source->fElectronIndex[sourceindex];
+    fElectronDetEta[index] = source->fElectronDetEta[sourceindex];
+    if (index < static_cast<int>(fElectronCharge.size()) && sourceindex < static_cast<int>(source->fElectronCharge.size()))
+      fElectronCharge[index] = source->fElectronCharge[sourceindex];
+  } else if (ptype == KLFitter::Particles::kMuon) {
+    fMuonIndex[index] = source->fMuonIndex[sourceindex];
+    fMuonDetEta[index] = source->fMuonDetEta[sourceindex];
+    if (index < static_cast<int>(fMuonCharge.size()) && sourceindex < static_cast<int>(source->fMuonCharge.size()))
+      fMuonCharge[index] = source->fMuonCharge[sourceindex];
+  } else if (ptype == KLFitter::Particles::kPhoton) {
+    fPhotonIndex[index] = source->fPhotonIndex[sourceindex];
+    fPhotonDetEta[index] = source->fPhotonDetEta[sourceindex];
+  }
+
+  // no error
+  return 1;
+}
+
 // ---------------------------------------------------------
 TLorentzVector* KLFitter::Particles::Particle(std::string name) {
   TLorentzVector* particle = 0;
@@ -361,130 +349,130 @@ TLorentzVector* KLFitter::Particles::Particle(int index, KLFitter::Particles::Pa
   }
 
   // return pointer
-  return (*container)[index].get();
+  return &(*container)[index];
 }
 
 // ---------------------------------------------------------
 int KLFitter::Particles::FindParticle(std::string name, TLorentzVector* &particle, int *index, KLFitter::Particles::ParticleType *ptype) {
-  // loop over all partons
-  unsigned int npartons = fNamePartons.size();
-  for (unsigned int i = 0; i < npartons; ++i)
-    if (name == fNamePartons[i]) {
-      particle = fPartons[i].get();
-      *index = i;
-      *ptype = KLFitter::Particles::kParton;
-      return 1;
-    }
+  if (!fNameTable)
+    return 0;
 
-  // loop over all electrons
-  unsigned int nelectrons = fNameElectrons.size();
-  for (unsigned int i = 0; i < nelectrons; ++i)
-    if (name == fNameElectrons[i]) {
-      particle = fElectrons[i].get();
-      *index = i;
-      *ptype = KLFitter::Particles::kElectron;
-      return 1;
-    }
+  // get the handle of the name
+  auto it = fNameTable->handles.find(name);
+  if (it == fNameTable->handles.end())
+    return 0;
 
-  // loop over all muons
-  unsigned int nmuons = fNameMuons.size();
-  for (unsigned int i = 0; i < nmuons; ++i)
-    if (name == fNameMuons[i]) {
-      particle = fMuons[i].get();
-      *index = i;
-      *ptype = KLFitter::Particles::kMuon;
-      return 1;
-    }
+  if (!fNameLocationsValid)
+    UpdateNameLocations();
 
-  // loop over all taus
-  unsigned int ntaus = fNameTaus.size();
-  for (unsigned int i = 0; i < ntaus; ++i)
-    if (name == fNameTaus[i]) {
-      particle = fTaus[i].get();
-      *index = i;
-      *ptype = KLFitter::Particles::kTau;
-      return 1;
-    }
+  // check if a particle of this set has the name
+  int handle = it->second;
+  if (handle >= static_cast<int>(fNameLocations.size()) || fNameLocations[handle].first < 0)
+    return 0;
 
-  // loop over all neutrinos
-  unsigned int nneutrinos = fNameNeutrinos.size();
-  for (unsigned int i = 0; i < nneutrinos; ++i)
-    if (name == fNameNeutrinos[i]) {
-      particle = fNeutrinos[i].get();
-      *index = i;
-      *ptype = KLFitter::Particles::kNeutrino;
-      return 1;
-    }
+  *ptype = static_cast<KLFitter::Particles::ParticleType>(fNameLocations[handle].first);
+  *index = fNameLocations[handle].second;
+  particle = &(*ParticleContainer(*ptype))[*index];
 
-  // loop over all bosons
-  unsigned int nbosons = fNameBosons.size();
-  for (unsigned int i = 0; i < nbosons; ++i)
-    if (name == fNameBosons[i]) {
-      particle = fBosons[i].get();
-      *index = i;
-      *ptype = KLFitter::Particles::kBoson;
-      return 1;
-    }
+  // particle found
+  return 1;
+}
 
-  // loop over all photons
-  unsigned int nphotons = fNamePhotons.size();
-  for (unsigned int i = 0; i < nphotons; ++i)
-    if (name == fNamePhotons[i]) {
-      particle = fPhotons[i].get();
-      *index = i;
-      *ptype = KLFitter::Particles::kPhoton;
-      return 1;
-    }
+// ---------------------------------------------------------
+int KLFitter::Particles::InternName(const std::string& name) {
+  if (fNameTable) {
+    auto it = fNameTable->handles.find(name);
+    if (it != fNameTable->handles.end())
+      return it->second;
 
-  // particle not found
-  return 0;
+    // do not modify a table used by other sets of particles
+    if (fNameTable.use_count() > 1)
+      fNameTable = std::make_shared<NameTable>(*fNameTable);
+  } else {
+    fNameTable = std::make_shared<NameTable>();
+  }
+
+  int handle = static_cast<int>(fNameTable->names.size());
+  fNameTable->names.push_back(name);
+  fNameTable->handles.emplace(name, handle);
+  return handle;
+}
+
+// ---------------------------------------------------------
+void KLFitter::Particles::UpdateNameLocations() {
+  fNameLocations.assign(fNameTable ? fNameTable->names.size() : 0, std::make_pair(-1, -1));
+
+  // the first particle with a name is found, in the order of the types
+  for (KLFitter::Particles::ParticleType ptype = kParton; ptype <= kPhoton; ++ptype) {
+    const std::vector<int>& handles = *ParticleNameContainer(ptype);
+    for (std::size_t i = 0; i < handles.size(); ++i)
+      if (fNameLocations[handles[i]].first < 0)
+        fNameLocations[handles[i]] = std::make_pair(static_cast<int>(ptype), static_cast<int>(i));
+  }
+
+  fNameLocationsValid = true;
+}
+
+// ---------------------------------------------------------
+int KLFitter::Particles::ShareNameTable(const KLFitter::Particles& other) {
+  if (NParticles() != 0) {
+    std::cout << "KLFitter::Particles::ShareNameTable(). The set of particles is not empty." << std::endl;
+    return 0;
+  }
+
+  fNameTable = other.fNameTable;
+  fNameLocations.clear();
+  fNameLocationsValid = true;
+
+  // no error
+  return 1;
 }
 
 // ---------------------------------------------------------
 TLorentzVector* KLFitter::Particles::Parton(int index) {
   // no check on index range for CPU-time reasons
-  return fPartons[index].get();
+  return &fPartons[index];
 }
 
 // ---------------------------------------------------------
 TLorentzVector* KLFitter::Particles::Electron(int index) {
   // no check on index range for CPU-time reasons
-  return fElectrons[index].get();
+  return &fElectrons[index];
 }
 
 // ---------------------------------------------------------
 TLorentzVector* KLFitter::Particles::Muon(int index) {
   // no check on index range for CPU-time reasons
-  return fMuons[index].get();
+  return &fMuons[index];
 }
 
 // ---------------------------------------------------------
 TLorentzVector* KLFitter::Particles::Tau(int index) {
   // no check on index range for CPU-time reasons
-  return fTaus[index].get();
+  return &fTaus[index];
 }
 
 // ---------------------------------------------------------
 TLorentzVector* KLFitter::Particles::Boson(int index) {
   // no check on index range for CPU-time reasons
-  return fBosons[index].get();
+  return &fBosons[index];
 }
 
 // ---------------------------------------------------------
 TLorentzVector* KLFitter::Particles::Neutrino(int index) {
   // no check on index range for CPU-time reasons
-  return fNeutrinos[index].get();
+  return &fNeutrinos[index];
 }
 
 // ---------------------------------------------------------
 TLorentzVector* KLFitter::Particles::Photon(int index) {
   // no check on index range for CPU-time reasons
-  return fPhotons[index].get();
+  return &fPhotons[index];
 }
 
 // ---------------------------------------------------------
 int KLFitter::Particles::NParticles(KLFitter::Particles::ParticleType ptype) {
-  return static_cast<int>(ParticleContainer(ptype)->size());
+  return static_cast<int>(ParticleNameContainer(ptype)->size());
 }
 
 // ---------------------------------------------------------
@@ -497,11 +485,11 @@ std::string KLFitter::Particles::NameParticle(int index, KLFitter::Particles::Pa
     return "";
 
   // return name
-  return (*ParticleNameContainer(ptype))[index];
+  return fNameTable->names[(*ParticleNameContainer(ptype))[index]];
 }
 
 // ---------------------------------------------------------
-int KLFitter::Particles::CheckIndex(std::vector<std::unique_ptr<TLorentzVector> >* container, int index) {
+int KLFitter::Particles::CheckIndex(std::vector<TLorentzVector>* container, int index) {
   // check container
   if (!container) {
     std::cout << "KLFitter::Particles::CheckIndex(). Container does not exist." << std::endl;
@@ -519,7 +507,7 @@ int KLFitter::Particles::CheckIndex(std::vector<std::unique_ptr<TLorentzVector>
 }
 
 // ---------------------------------------------------------
-std::vector<std::unique_ptr<TLorentzVector> >* KLFitter::Particles::ParticleContainer(KLFitter::Particles::ParticleType ptype) {
+std::vector<TLorentzVector>* KLFitter::Particles::ParticleContainer(KLFitter::Particles::ParticleType ptype) {
   // return particle container
   switch (ptype) {
   case KLFitter::Particles::kParton:
@@ -551,7 +539,7 @@ std::vector<std::unique_ptr<TLorentzVector> >* KLFitter::Particles::ParticleCont
 }
 
 // ---------------------------------------------------------
-std::vector <std::string>* KLFitter::Particles::ParticleNameContainer(KLFitter::Particles::ParticleType ptype) {
+std::vector<int>* KLFitter::Particles::ParticleNameContainer(KLFitter::Particles::ParticleType ptype) {
   // return container
   if (ptype == KLFitter::Particles::kParton) {
     return &fNamePartons;
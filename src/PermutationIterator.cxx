@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2009--2018, the KLFitter developer team
+ *
+ * This file is part of KLFitter.
+ *
+ * KLFitter is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * KLFitter is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with KLFitter. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KLFitter/PermutationIterator.h"
+
+#include <algorithm>
+#include <iostream>
+
+// ---------------------------------------------------------
+KLFitter::PermutationIterator::PermutationIterator(int nobjects, int npositions)
+  : fNObjects(nobjects)
+  , fNPositions(npositions < 0 ? nobjects : npositions)
+  , fUnused(0)
+  , fValid(false) {
+  if (fNObjects > 63) {
+    std::cout << "KLFitter::PermutationIterator::PermutationIterator(). More than 63 objects are not supported." << std::endl;
+    fNObjects = 0;
+    fNPositions = 1;
+  }
+
+  Rewind();
+}
+
+// ---------------------------------------------------------
+KLFitter::PermutationIterator::~PermutationIterator() = default;
+
+// ---------------------------------------------------------
+void KLFitter::PermutationIterator::Rewind() {
+  fValid = fNObjects >= 0 && fNPositions <= fNObjects;
+  if (!fValid)
+    return;
+
+  // the first combination has the lowest objects, i.e. the unused
+  // objects in the lowest bits
+  fUnused = (std::uint64_t(1) << (fNObjects - fNPositions)) - 1;
+  fCombination.resize(fNPositions);
+  fPermutation.resize(fNPositions);
+  SetCombination();
+}
+
+// ---------------------------------------------------------
+bool KLFitter::PermutationIterator::Next() {
+  if (!fValid)
+    return false;
+
+  if (std::next_permutation(fPermutation.begin(), fPermutation.end()))
+    return true;
+
+  return NextCombination();
+}
+
+// ---------------------------------------------------------
+bool KLFitter::PermutationIterator::NextCombination() {
+  if (!fValid)
+    return false;
+
+  // the only combination uses all objects
+  if (fUnused == 0) {
+    fValid = false;
+    return false;
+  }
+
+  // next larger bitmask with the same number of bits (Gosper's hack)
+  const std::uint64_t lowest = fUnused & (~fUnused + 1);
+  const std::uint64_t ripple = fUnused + lowest;
+  fUnused = (((ripple ^ fUnused) >> 2) / lowest) | ripple;
+
+  if (fUnused >> fNObjects) {
+    fValid = false;
+    return false;
+  }
+
+  SetCombination();
+  return true;
+}
+
+// ---------------------------------------------------------
+void KLFitter::PermutationIterator::SetCombination() {
+  int position = 0;
+  for (int i = 0; i < fNObjects; ++i) {
+    if (!((fUnused >> (fNObjects - 1 - i)) & 1))
+      fCombination[position++] = i;
+  }
+  std::copy(fCombination.begin(), fCombination.end(), fPermutation.begin());
+}
@@ -20,25 +20,331 @@
 #include "KLFitter/Permutations.h"
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "KLFitter/PermutationIterator.h"
+
+namespace {
+/**
+  * A hash of a vector of particle indices.
+  */
+struct IndexVectorHash {
+  std::size_t operator()(const std::vector<int>& indices) const {
+    std::size_t hash = indices.size();
+    for (int index : indices)
+      hash ^= std::hash<int>()(index) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+  }
+};
+
+/**
+  * Add all permutations of the given (sorted) values to a table, in
+  * lexicographic order, skipping the permutations which violate the
+  * constraints as early as possible.
+  * @param values The values.
+  * @param before Per position, the positions with smaller values.
+  * @param forbidden Per position, the forbidden values.
+  * @param position The position to be set.
+  * @param permutation The permutation.
+  * @param used Flags for the values already used.
+  * @param table The table.
+  */
+void AddConstrainedPermutations(const std::vector<int>& values, const std::vector<std::vector<int> >& before,
+                                const std::vector<std::vector<int> >& forbidden, std::size_t position,
+                                std::vector<int>* permutation, std::vector<bool>* used, std::vector<std::vector<int> >* table) {
+  if (position == values.size()) {
+    table->emplace_back(*permutation);
+    return;
+  }
+
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    if ((*used)[i])
+      continue;
+    const int value = values[i];
+    if (std::find(forbidden[position].begin(), forbidden[position].end(), value) != forbidden[position].end())
+      continue;
+    bool ordered = true;
+    for (int other : before[position])
+      ordered &= (*permutation)[other] < value;
+    if (!ordered)
+      continue;
+
+    (*permutation)[position] = value;
+    (*used)[i] = true;
+    AddConstrainedPermutations(values, before, forbidden, position + 1, permutation, used, table);
+    (*used)[i] = false;
+  }
+}
+
+/**
+  * The permutations of a sub-table (see CreateSubTable()) which fulfil
+  * the declared constraints, counted, ranked and unranked without
+  * creating them. The permutations are numbered in the order of the
+  * created table.
+  */
+class ConstrainedSubTable {
+ public:
+  /**
+    * The constructor.
+    * @param combinations The combinations of objects, in the order of
+    * the sub-table.
+    * @param ordered Pairs of positions with increasing indices.
+    * @param forbidden Pairs of positions and indices which are forbidden.
+    */
+  ConstrainedSubTable(const std::vector<std::vector<int> >& combinations, const std::vector<std::pair<int, int> >& ordered,
+                      const std::vector<std::pair<int, int> >& forbidden)
+    : fCombinations(combinations)
+    , fMemo(combinations.size())
+    , fTotal(0) {
+    const std::size_t size = fCombinations.empty() ? 0 : fCombinations.front().size();
+    fBefore.resize(size);
+    fForbidden.resize(size);
+    fNeeded.resize(size + 1);
+    for (const auto& positions : ordered) {
+      if (positions.second < static_cast<int>(size)) {
+        fBefore[positions.second].push_back(positions.first);
+        for (int position = positions.first + 1; position <= positions.second; ++position)
+          fNeeded[position].push_back(positions.first);
+      }
+    }
+    for (const auto& position : forbidden) {
+      if (position.first < static_cast<int>(size))
+        fForbidden[position.first].push_back(position.second);
+    }
+
+    std::vector<int> prefix;
+    for (std::size_t icombination = 0; icombination < fCombinations.size(); ++icombination) {
+      fCounts.push_back(Completions(icombination, &prefix));
+      fTotal += fCounts.back();
+    }
+  }
+
+  /**
+    * Return the number of permutations.
+    */
+  long long Count() const { return fTotal; }
+
+  /**
+    * Get the permutation with the given rank.
+    * @param rank The rank.
+    * @param permutation The permutation.
+    * @return False if the rank is out of range.
+    */
+  bool Unrank(long long rank, std::vector<int>* permutation) {
+    if (rank < 0 || rank >= fTotal)
+      return false;
+
+    std::size_t icombination = 0;
+    while (rank >= fCounts[icombination])
+      rank -= fCounts[icombination++];
+
+    const std::vector<int>& values = fCombinations[icombination];
+    permutation->clear();
+    while (permutation->size() < values.size()) {
+      for (int value : values) {
+        if (!Allowed(*permutation, value))
+          continue;
+        permutation->push_back(value);
+        const long long count = Completions(icombination, permutation);
+        if (rank < count)
+          break;
+        rank -= count;
+        permutation->pop_back();
+      }
+    }
+    return true;
+  }
+
+  /**
+    * Get the rank of a permutation.
+    * @param permutation The permutation.
+    * @return The rank, or -1 if the permutation is not part of the
+    * sub-table.
+    */
+  long long Rank(const std::vector<int>& permutation) {
+    std::vector<int> values(permutation);
+    std::sort(values.begin(), values.end());
+    auto it = std::lower_bound(fCombinations.begin(), fCombinations.end(), values);
+    if (it == fCombinations.end() || *it != values)
+      return -1;
+
+    const std::size_t icombination = it - fCombinations.begin();
+    long long rank = 0;
+    for (std::size_t i = 0; i < icombination; ++i)
+      rank += fCounts[i];
+
+    std::vector<int> prefix;
+    for (int chosen : permutation) {
+      if (!Allowed(prefix, chosen))
+        return -1;
+      for (int value : values) {
+        if (value >= chosen)
+          break;
+        if (!Allowed(prefix, value))
+          continue;
+        prefix.push_back(value);
+        rank += Completions(icombination, &prefix);
+        prefix.pop_back();
+      }
+      prefix.push_back(chosen);
+    }
+    return rank;
+  }
+
+ private:
+  /**
+    * Check whether a value may follow a prefix.
+    */
+  bool Allowed(const std::vector<int>& prefix, int value) const {
+    const std::size_t position = prefix.size();
+    if (std::find(prefix.begin(), prefix.end(), value) != prefix.end())
+      return false;
+    if (std::find(fForbidden[position].begin(), fForbidden[position].end(), value) != fForbidden[position].end())
+      return false;
+    for (int other : fBefore[position]) {
+      if (prefix[other] >= value)
+        return false;
+    }
+    return true;
+  }
+
+  /**
+    * The number of permutations of a combination which start with a
+    * (valid) prefix. The result only depends on the position, the
+    * values used and the values in positions with constraints on later
+    * positions, which are the key of the memo.
+    */
+  long long Completions(std::size_t icombination, std::vector<int>* prefix) {
+    const std::vector<int>& values = fCombinations[icombination];
+    const std::size_t position = prefix->size();
+    if (position == values.size())
+      return 1;
+
+    std::vector<int> key(1, static_cast<int>(position));
+    for (int value : values)
+      key.push_back(std::find(prefix->begin(), prefix->end(), value) != prefix->end());
+    for (int other : fNeeded[position])
+      key.push_back((*prefix)[other]);
+    auto it = fMemo[icombination].find(key);
+    if (it != fMemo[icombination].end())
+      return it->second;
+
+    long long count = 0;
+    for (int value : values) {
+      if (!Allowed(*prefix, value))
+        continue;
+      prefix->push_back(value);
+      count += Completions(icombination, prefix);
+      prefix->pop_back();
+    }
+    fMemo[icombination][key] = count;
+    return count;
+  }
+
+  std::vector<std::vector<int> > fCombinations;
+  std::vector<std::vector<int> > fBefore;
+  std::vector<std::vector<int> > fForbidden;
+  std::vector<std::vector<int> > fNeeded;
+  std::vector<std::unordered_map<std::vector<int>, long long, IndexVectorHash> > fMemo;
+  std::vector<long long> fCounts;
+  long long fTotal;
+};
+
+/**
+  * The particle types of the permutations, in their order.
+  */
+const KLFitter::Particles::ParticleType kPermutedTypes[] = {KLFitter::Particles::kParton, KLFitter::Particles::kElectron,
+                                                            KLFitter::Particles::kMuon, KLFitter::Particles::kPhoton};
+
+/**
+  * The number of permutations of all sub-tables.
+  */
+long long CountTablePermutations(const std::vector<ConstrainedSubTable>& subtables) {
+  long long count = 1;
+  for (const auto& subtable : subtables)
+    count *= subtable.Count();
+  return count;
+}
+
+/**
+  * Get the permutation of all sub-tables with the given rank. The
+  * permutations of the first sub-table are the outermost loop.
+  */
+bool UnrankTablePermutation(std::vector<ConstrainedSubTable>* subtables, long long rank, std::vector<int>* permutation) {
+  if (rank < 0 || rank >= CountTablePermutations(*subtables))
+    return false;
+
+  std::vector<long long> ranks(subtables->size());
+  for (std::size_t i = subtables->size(); i-- > 0;) {
+    ranks[i] = rank % (*subtables)[i].Count();
+    rank /= (*subtables)[i].Count();
+  }
+
+  permutation->clear();
+  std::vector<int> part;
+  for (std::size_t i = 0; i < subtables->size(); ++i) {
+    (*subtables)[i].Unrank(ranks[i], &part);
+    permutation->insert(permutation->end(), part.begin(), part.end());
+  }
+  return true;
+}
+}  // namespace
 
 // ---------------------------------------------------------
 KLFitter::Permutations::Permutations(KLFitter::Particles ** p, KLFitter::Particles ** pp)
   : fParticles(p)
   , fParticlesPermuted(pp)
-  , fPermutationIndex(-1) {
+  , fIndexOnly(false)
+  , fPermutationIndex(-1)
+  , fCreated(false)
+  , fOrderedPositions(KLFitter::Particles::kPhoton + 1)
+  , fForbiddenPositions(KLFitter::Particles::kPhoton + 1) {
   // empty
 }
 
 // ---------------------------------------------------------
-KLFitter::Permutations::Permutations(const Permutations& o) = default;
+KLFitter::Permutations::Permutations(const Permutations& o)
+  : Permutations(o.fParticles, o.fParticlesPermuted) {
+  *this = o;
+}
 
 // ---------------------------------------------------------
 KLFitter::Permutations::~Permutations() = default;
 
 // ---------------------------------------------------------
-KLFitter::Permutations& KLFitter::Permutations::operator=(const KLFitter::Permutations& obj) = default;
+KLFitter::Permutations& KLFitter::Permutations::operator=(const KLFitter::Permutations& obj) {
+  if (this == &obj)
+    return *this;
+
+  fParticles = obj.fParticles;
+  fParticlesPermuted = obj.fParticlesPermuted;
+  fIndexOnly = obj.fIndexOnly;
+  fPermutationIndex = obj.fPermutationIndex;
+  fCreated = obj.fCreated;
+  fOrderedPositions = obj.fOrderedPositions;
+  fForbiddenPositions = obj.fForbiddenPositions;
+  fGroupInvariances = obj.fGroupInvariances;
+  fTablePartons = obj.fTablePartons;
+  fTableElectrons = obj.fTableElectrons;
+  fTableMuons = obj.fTableMuons;
+  fTablePhotons = obj.fTablePhotons;
+
+  // copy the tables into the storage of this object; the pools are
+  // not copied
+  RecycleTables();
+  for (const auto& particles : obj.fParticlesTable)
+    *NewPermutedParticles() = particles;
+  for (const auto& permutation : obj.fPermutationTable)
+    *NewPermutation() = permutation;
+  fParticlesView = obj.fParticlesView;
+
+  return *this;
+}
 
 // ---------------------------------------------------------
 int KLFitter::Permutations::SetPermutation(int index) {
@@ -54,7 +360,28 @@ int KLFitter::Permutations::SetPermutation(int index) {
   }
 
   // set permutation
-  (*fParticlesPermuted) = &fParticlesTable[index];
+  if (fIndexOnly) {
+    if (!CheckParticles())
+      return 0;
+
+    // the particles are created for the first permutation and then
+    // overwritten in place
+    const std::vector<int>& permutation = fPermutationTable[index];
+    if (fParticlesView.NParticles() == 0) {
+      AddPermutedParticles(permutation, &fParticlesView);
+    } else {
+      int offset = 0;
+      for (KLFitter::Particles::ParticleType ptype = KLFitter::Particles::kParton; ptype <= KLFitter::Particles::kPhoton; ++ptype) {
+        int n = fParticlesView.NParticles(ptype);
+        for (int i = 0; i < n; ++i)
+          fParticlesView.CopyParticle(i, ptype, *fParticles, permutation[offset + i]);
+        offset += n;
+      }
+    }
+    (*fParticlesPermuted) = &fParticlesView;
+  } else {
+    (*fParticlesPermuted) = &fParticlesTable[index];
+  }
 
   // set permutation index
   fPermutationIndex = index;
@@ -64,45 +391,136 @@ int KLFitter::Permutations::SetPermutation(int index) {
 }
 
 // ---------------------------------------------------------
-int KLFitter::Permutations::CreatePermutations(int nPartonsInPermutations) {
-  // reset existing particle and permuation tables
-  Reset();
+int KLFitter::Permutations::CopyTables(const KLFitter::Permutations& other) {
+  KLFitter::Particles** particles = fParticles;
+  KLFitter::Particles** particlesPermuted = fParticlesPermuted;
+
+  *this = other;
 
-  // create new table of particles
-  fParticlesTable = std::vector<KLFitter::Particles>{};
+  fParticles = particles;
+  fParticlesPermuted = particlesPermuted;
+  fPermutationIndex = -1;
 
-  // create new table of permutations
-  fPermutationTable = std::vector<std::vector<int> >{};
+  // no error
+  return 1;
+}
+
+// ---------------------------------------------------------
+int KLFitter::Permutations::SetPermutationTable(const std::vector<std::vector<int> >& table) {
+  // check particles
+  if (!CheckParticles())
+    return 0;
+
+  RecycleTables();
+  fPermutationIndex = -1;
+
+  // add the permutations and their particles
+  for (const auto& permutation : table) {
+    *NewPermutation() = permutation;
+    if (!fIndexOnly)
+      AddPermutedParticles(permutation, NewPermutedParticles());
+  }
+
+  fCreated = true;
+
+  // no error
+  return 1;
+}
+
+// ---------------------------------------------------------
+int KLFitter::Permutations::TableSignature(int nPartonsInPermutations, long long first, long long count, std::vector<long long>* signature) {
+  signature->clear();
+  if (!CheckParticles())
+    return 0;
+
+  for (KLFitter::Particles::ParticleType ptype : kPermutedTypes)
+    signature->push_back((*fParticles)->NParticles(ptype));
+  signature->push_back(nPartonsInPermutations);
+  signature->push_back(first);
+  signature->push_back(count);
+
+  // the declarations, each preceded by its size
+  for (KLFitter::Particles::ParticleType ptype : kPermutedTypes) {
+    for (const auto* positions : {&fOrderedPositions[ptype], &fForbiddenPositions[ptype]}) {
+      signature->push_back(positions->size());
+      for (const auto& position : *positions) {
+        signature->push_back(position.first);
+        signature->push_back(position.second);
+      }
+    }
+  }
+  signature->push_back(fGroupInvariances.size());
+  for (const auto& group : fGroupInvariances) {
+    signature->push_back(group.ptype);
+    for (const auto* positions : {&group.indexVectorPosition1, &group.indexVectorPosition2}) {
+      signature->push_back(positions->size());
+      signature->insert(signature->end(), positions->begin(), positions->end());
+    }
+  }
+
+  // no error
+  return 1;
+}
+
+// ---------------------------------------------------------
+int KLFitter::Permutations::CreatePermutations(int nPartonsInPermutations, long long first, long long count) {
+  // reset existing particle and permuation tables, but keep the
+  // declared invariances
+  RecycleTables();
 
   // check particles
   CheckParticles();
 
+  // create a range of permutations from their ranks
+  if (first != 0 || count >= 0) {
+    if (!fGroupInvariances.empty()) {
+      std::cout << "KLFitter::Permutations::CreatePermutations(). Ranges are not available with group invariances." << std::endl;
+      return 0;
+    }
+
+    std::vector<ConstrainedSubTable> subtables;
+    for (const auto& combinations : SubTableCombinations(nPartonsInPermutations))
+      subtables.emplace_back(combinations.second, fOrderedPositions[combinations.first], fForbiddenPositions[combinations.first]);
+    long long last = CountTablePermutations(subtables);
+    if (count >= 0)
+      last = std::min(last, first + count);
+
+    std::vector<int> permutation;
+    for (long long rank = std::max(first, 0LL); rank < last; ++rank) {
+      UnrankTablePermutation(&subtables, rank, &permutation);
+      if (!fIndexOnly)
+        AddPermutedParticles(permutation, NewPermutedParticles());
+      *NewPermutation() = permutation;
+    }
+
+    fCreated = true;
+
+    // no error
+    return 1;
+  }
+
   // get number of objects per category
   int npartons   = (*fParticles)->NPartons();
   int nelectrons = (*fParticles)->NElectrons();
   int nmuons     = (*fParticles)->NMuons();
   int nphotons     = (*fParticles)->NPhotons();
 
-  bool isDilepton(false);
-
-  if (nelectrons != 0 && (*fParticles)->LeptonCharge(0, KLFitter::Particles::kElectron) != -9)
-    isDilepton = true;
-
-  if (nmuons != 0 && (*fParticles)->LeptonCharge(0, KLFitter::Particles::kMuon) != -9)
-    isDilepton = true;
-
   // create table for parton, electron, muon and photons permutations
   fTablePartons = std::vector<std::vector<int> >{};
-  CreateSubTable(npartons, &fTablePartons, nPartonsInPermutations);
+  CreateSubTable(npartons, &fTablePartons, nPartonsInPermutations,
+                 fOrderedPositions[KLFitter::Particles::kParton], fForbiddenPositions[KLFitter::Particles::kParton]);
 
   fTableElectrons = std::vector<std::vector<int> >{};
-  CreateSubTable(nelectrons, &fTableElectrons);
+  CreateSubTable(nelectrons, &fTableElectrons, -1,
+                 fOrderedPositions[KLFitter::Particles::kElectron], fForbiddenPositions[KLFitter::Particles::kElectron]);
 
   fTableMuons = std::vector<std::vector<int> >{};
-  CreateSubTable(nmuons, &fTableMuons);
+  CreateSubTable(nmuons, &fTableMuons, -1,
+                 fOrderedPositions[KLFitter::Particles::kMuon], fForbiddenPositions[KLFitter::Particles::kMuon]);
 
   fTablePhotons = std::vector<std::vector<int> >{};
-  CreateSubTable(nphotons, &fTablePhotons);
+  CreateSubTable(nphotons, &fTablePhotons, -1,
+                 fOrderedPositions[KLFitter::Particles::kPhoton], fForbiddenPositions[KLFitter::Particles::kPhoton]);
 
   int npartonsPerm = npartons;
   if (nPartonsInPermutations >= 0)
@@ -115,6 +533,18 @@ int KLFitter::Permutations::CreatePermutations(int nPartonsInPermutations) {
   int npermphotons     = fTablePhotons.size() <= 0 ? 1 : fTablePhotons.size();
   int npermoverall   = npartonsPerm + nelectrons + nmuons + nphotons;
 
+  // no permutations are left if the declared invariances and
+  // forbidden positions exclude all permutations of a category
+  for (KLFitter::Particles::ParticleType ptype : {KLFitter::Particles::kParton, KLFitter::Particles::kElectron,
+                                                  KLFitter::Particles::kMuon, KLFitter::Particles::kPhoton}) {
+    bool constrained = !fOrderedPositions[ptype].empty() || !fForbiddenPositions[ptype].empty();
+    std::vector<std::vector<int> >* table = ptype == KLFitter::Particles::kParton ? &fTablePartons :
+                                            ptype == KLFitter::Particles::kElectron ? &fTableElectrons :
+                                            ptype == KLFitter::Particles::kMuon ? &fTableMuons : &fTablePhotons;
+    if (constrained && table->empty())
+      npermpartons = 0;
+  }
+
   // loop over all parton permutations
   for (int ipermparton = 0; ipermparton < npermpartons; ++ipermparton) {
     // loop over all electron permutations
@@ -123,147 +553,327 @@ int KLFitter::Permutations::CreatePermutations(int nPartonsInPermutations) {
       for (int ipermmuon = 0; ipermmuon < npermmuons; ++ipermmuon) {
         // loop over all photon permutations
         for (int ipermphoton = 0; ipermphoton < npermphotons; ++ipermphoton) {
-          // create new particles
-          KLFitter::Particles particles{};
-
           // create new permutation
-          std::vector<int> permutation(npermoverall);
-
-          // loop over all partons
-          for (int i = 0; i < npartonsPerm; ++i) {
-            // get index
-            int index = fTablePartons[ipermparton][i];
-
-            // add parton
-            particles.AddParticle((*fParticles)->Parton(index),
-                                  (*fParticles)->DetEta(index, KLFitter::Particles::kParton),
-                                  KLFitter::Particles::kParton,
-                                  (*fParticles)->NameParticle(index, KLFitter::Particles::kParton),
-                                  (*fParticles)->JetIndex(index),
-                                  (*fParticles)->IsBTagged(index),
-                                  (*fParticles)->BTaggingEfficiency(index),
-                                  (*fParticles)->BTaggingRejection(index),
-                                  (*fParticles)->TrueFlavor(index),
-                                  (*fParticles)->BTagWeight(index));
-
-            // set permutation
-            permutation[i] = index;
-          }
-
-          // loop over all electrons
-          for (int i = 0; i < nelectrons; ++i) {
-            // get index
-            int index = fTableElectrons[ipermelectron][i];
-
-            // if isDilepton include charge of the lepton
-            if (isDilepton) {
-              // add electron
-              particles.AddParticle((*fParticles)->Electron(index),
-                                    (*fParticles)->DetEta(index, KLFitter::Particles::kElectron),
-                                    (*fParticles)->LeptonCharge(index, KLFitter::Particles::kElectron),
-                                    KLFitter::Particles::kElectron,
-                                    (*fParticles)->NameParticle(index, KLFitter::Particles::kElectron),
-                                    (*fParticles)->ElectronIndex(index));
-            } else {
-              // add electron
-              particles.AddParticle((*fParticles)->Electron(index),
-                                    (*fParticles)->DetEta(index, KLFitter::Particles::kElectron),
-                                    KLFitter::Particles::kElectron,
-                                    (*fParticles)->NameParticle(index, KLFitter::Particles::kElectron),
-                                    (*fParticles)->ElectronIndex(index));
-            }
-
-            // set permutation
-            permutation[npartonsPerm + i] = index;
-          }
-
-          // loop over all muons
-          for (int i = 0; i < nmuons; ++i) {
-            // get index
-            int index = fTableMuons[ipermmuon][i];
-
-            // if isDilepton include charge of the lepton
-            if (isDilepton) {
-              // add muon
-              particles.AddParticle((*fParticles)->Muon(index),
-                                    (*fParticles)->DetEta(index, KLFitter::Particles::kMuon),
-                                    (*fParticles)->LeptonCharge(index, KLFitter::Particles::kMuon),
-                                    KLFitter::Particles::kMuon,
-                                    (*fParticles)->NameParticle(index, KLFitter::Particles::kMuon),
-                                    (*fParticles)->MuonIndex(index));
-            } else {
-              // add muon
-              particles.AddParticle((*fParticles)->Muon(index),
-                                    (*fParticles)->DetEta(index, KLFitter::Particles::kMuon),
-                                    KLFitter::Particles::kMuon,
-                                    (*fParticles)->NameParticle(index, KLFitter::Particles::kMuon),
-                                    (*fParticles)->MuonIndex(index));
-            }
-
-            // set permutation
-            permutation[npartonsPerm + nelectrons + i] = index;
-          }
-
-          // loop over all photons
-          for (int i = 0; i < nphotons; ++i) {
-            // get index
-            int index = fTablePhotons[ipermphoton][i];
-
-            // add photon
-            particles.AddParticle((*fParticles)->Photon(index),
-                                  (*fParticles)->DetEta(index, KLFitter::Particles::kPhoton),
-                                  KLFitter::Particles::kPhoton,
-                                  (*fParticles)->NameParticle(index, KLFitter::Particles::kPhoton),
-                                  (*fParticles)->PhotonIndex(index));
-
-            // set permutation
-            permutation[npartonsPerm + nelectrons + nmuons + i] = index;
-          }
+          std::vector<int>& permutation = *NewPermutation();
+          permutation.resize(npermoverall);
+
+          for (int i = 0; i < npartonsPerm; ++i)
+            permutation[i] = fTablePartons[ipermparton][i];
+          for (int i = 0; i < nelectrons; ++i)
+            permutation[npartonsPerm + i] = fTableElectrons[ipermelectron][i];
+          for (int i = 0; i < nmuons; ++i)
+            permutation[npartonsPerm + nelectrons + i] = fTableMuons[ipermmuon][i];
+          for (int i = 0; i < nphotons; ++i)
+            permutation[npartonsPerm + nelectrons + nmuons + i] = fTablePhotons[ipermphoton][i];
 
           // add particles to table
-          fParticlesTable.emplace_back(particles);
-
-          // add permutation to table
-          fPermutationTable.emplace_back(permutation);
+          if (!fIndexOnly)
+            AddPermutedParticles(permutation, NewPermutedParticles());
         }
       }
     }
   }
 
+  // the group invariances are applied to the created permutations;
+  // the declared invariances are kept until the next Reset()
+  fCreated = true;
+  int err = 1;
+  for (const auto& group : fGroupInvariances)
+    err *= InvariantParticleGroupPermutations(group.ptype, group.indexVectorPosition1, group.indexVectorPosition2);
+
+  // return error code
+  return err;
+}
+
+// ---------------------------------------------------------
+void KLFitter::Permutations::AddPermutedParticles(const std::vector<int>& permutation, KLFitter::Particles* particles) {
+  // get number of objects per category
+  int nelectrons = (*fParticles)->NElectrons();
+  int nmuons     = (*fParticles)->NMuons();
+  int nphotons     = (*fParticles)->NPhotons();
+  int npartonsPerm = static_cast<int>(permutation.size()) - nelectrons - nmuons - nphotons;
+
+  bool isDilepton(false);
+
+  // the names are shared with the original particles
+  particles->ShareNameTable(**fParticles);
+
+  if (nelectrons != 0 && (*fParticles)->LeptonCharge(0, KLFitter::Particles::kElectron) != -9)
+    isDilepton = true;
+
+  if (nmuons != 0 && (*fParticles)->LeptonCharge(0, KLFitter::Particles::kMuon) != -9)
+    isDilepton = true;
+
+  // loop over all partons
+  for (int i = 0; i < npartonsPerm; ++i) {
+    // get index
+    int index = permutation[i];
+
+    // add parton
+    particles->AddParticle((*fParticles)->Parton(index),
+                           (*fParticles)->DetEta(index, KLFitter::Particles::kParton),
+                           KLFitter::Particles::kParton,
+                           (*fParticles)->NameParticle(index, KLFitter::Particles::kParton),
+                           (*fParticles)->JetIndex(index),
+                           (*fParticles)->IsBTagged(index),
+                           (*fParticles)->BTaggingEfficiency(index),
+                           (*fParticles)->BTaggingRejection(index),
+                           (*fParticles)->TrueFlavor(index),
+                           (*fParticles)->BTagWeight(index));
+  }
+
+  // loop over all electrons
+  for (int i = 0; i < nelectrons; ++i) {
+    // get index
+    int index = permutation[npartonsPerm + i];
+
+    // if isDilepton include charge of the lepton
+    if (isDilepton) {
+      // add electron
+      particles->AddParticle((*fParticles)->Electron(index),
+                             (*fParticles)->DetEta(index, KLFitter::Particles::kElectron),
+                             (*fParticles)->LeptonCharge(index, KLFitter::Particles::kElectron),
+                             KLFitter::Particles::kElectron,
+                             (*fParticles)->NameParticle(index, KLFitter::Particles::kElectron),
+                             (*fParticles)->ElectronIndex(index));
+    } else {
+      // add electron
+      particles->AddParticle((*fParticles)->Electron(index),
+                             (*fParticles)->DetEta(index, KLFitter::Particles::kElectron),
+                             KLFitter::Particles::kElectron,
+                             (*fParticles)->NameParticle(index, KLFitter::Particles::kElectron),
+                             (*fParticles)->ElectronIndex(index));
+    }
+  }
+
+  // loop over all muons
+  for (int i = 0; i < nmuons; ++i) {
+    // get index
+    int index = permutation[npartonsPerm + nelectrons + i];
+
+    // if isDilepton include charge of the lepton
+    if (isDilepton) {
+      // add muon
+      particles->AddParticle((*fParticles)->Muon(index),
+                             (*fParticles)->DetEta(index, KLFitter::Particles::kMuon),
+                             (*fParticles)->LeptonCharge(index, KLFitter::Particles::kMuon),
+                             KLFitter::Particles::kMuon,
+                             (*fParticles)->NameParticle(index, KLFitter::Particles::kMuon),
+                             (*fParticles)->MuonIndex(index));
+    } else {
+      // add muon
+      particles->AddParticle((*fParticles)->Muon(index),
+                             (*fParticles)->DetEta(index, KLFitter::Particles::kMuon),
+                             KLFitter::Particles::kMuon,
+                             (*fParticles)->NameParticle(index, KLFitter::Particles::kMuon),
+                             (*fParticles)->MuonIndex(index));
+    }
+  }
+
+  // loop over all photons
+  for (int i = 0; i < nphotons; ++i) {
+    // get index
+    int index = permutation[npartonsPerm + nelectrons + nmuons + i];
+
+    // add photon
+    particles->AddParticle((*fParticles)->Photon(index),
+                           (*fParticles)->DetEta(index, KLFitter::Particles::kPhoton),
+                           KLFitter::Particles::kPhoton,
+                           (*fParticles)->NameParticle(index, KLFitter::Particles::kPhoton),
+                           (*fParticles)->PhotonIndex(index));
+  }
+}
+
+// ---------------------------------------------------------
+void KLFitter::Permutations::ErasePermutations(const std::vector<bool>& remove) {
+  // move the kept permutations to the front, keeping their order
+  std::size_t nkept = 0;
+  for (std::size_t iperm = 0; iperm < fPermutationTable.size(); ++iperm) {
+    if (remove[iperm])
+      continue;
+    if (nkept != iperm) {
+      fPermutationTable[nkept].swap(fPermutationTable[iperm]);
+      if (!fIndexOnly)
+        std::swap(fParticlesTable[nkept], fParticlesTable[iperm]);
+    }
+    ++nkept;
+  }
+
+  // keep the storage of the removed permutations
+  while (fPermutationTable.size() > nkept) {
+    fPermutationPool.push_back(std::move(fPermutationTable.back()));
+    fPermutationTable.pop_back();
+  }
+  while (fParticlesTable.size() > nkept) {
+    fParticlesTable.back().Clear();
+    fParticlesPool.push_back(std::move(fParticlesTable.back()));
+    fParticlesTable.pop_back();
+  }
+}
+
+// ---------------------------------------------------------
+void KLFitter::Permutations::RecycleTables() {
+  for (auto& permutation : fPermutationTable)
+    fPermutationPool.push_back(std::move(permutation));
+  fPermutationTable.clear();
+
+  for (auto& particles : fParticlesTable) {
+    particles.Clear();
+    fParticlesPool.push_back(std::move(particles));
+  }
+  fParticlesTable.clear();
+
+  fParticlesView.Clear();
+}
+
+// ---------------------------------------------------------
+KLFitter::Particles* KLFitter::Permutations::NewPermutedParticles() {
+  if (fParticlesPool.empty()) {
+    fParticlesTable.emplace_back();
+  } else {
+    fParticlesTable.push_back(std::move(fParticlesPool.back()));
+    fParticlesPool.pop_back();
+  }
+  return &fParticlesTable.back();
+}
+
+// ---------------------------------------------------------
+std::vector<int>* KLFitter::Permutations::NewPermutation() {
+  if (fPermutationPool.empty()) {
+    fPermutationTable.emplace_back();
+  } else {
+    fPermutationTable.push_back(std::move(fPermutationPool.back()));
+    fPermutationPool.pop_back();
+    fPermutationTable.back().clear();
+  }
+  return &fPermutationTable.back();
+}
+
+// ---------------------------------------------------------
+int KLFitter::Permutations::Reset() {
+  // Clear particle and permutation tables, keeping their storage.
+  RecycleTables();
+
+  // Clear the declared invariances.
+  fCreated = false;
+  fOrderedPositions.assign(KLFitter::Particles::kPhoton + 1, std::vector<std::pair<int, int> >());
+  fForbiddenPositions.assign(KLFitter::Particles::kPhoton + 1, std::vector<std::pair<int, int> >());
+  fGroupInvariances.clear();
+
   // no error
   return 1;
 }
 
 // ---------------------------------------------------------
-int KLFitter::Permutations::Reset() {
-  // Clear particle and permutation tables.
-  fParticlesTable.clear();
-  fPermutationTable.clear();
+long long KLFitter::Permutations::CountPermutations(int nPartonsInPermutations) {
+  if (!CheckParticles())
+    return -1;
+
+  if (!fGroupInvariances.empty()) {
+    std::cout << "KLFitter::Permutations::CountPermutations(). Not available with group invariances." << std::endl;
+    return -1;
+  }
+
+  std::vector<ConstrainedSubTable> subtables;
+  for (const auto& combinations : SubTableCombinations(nPartonsInPermutations))
+    subtables.emplace_back(combinations.second, fOrderedPositions[combinations.first], fForbiddenPositions[combinations.first]);
+
+  return CountTablePermutations(subtables);
+}
+
+// ---------------------------------------------------------
+int KLFitter::Permutations::UnrankPermutation(long long rank, std::vector<int>* permutation, int nPartonsInPermutations) {
+  if (!CheckParticles())
+    return 0;
+
+  if (!fGroupInvariances.empty()) {
+    std::cout << "KLFitter::Permutations::UnrankPermutation(). Not available with group invariances." << std::endl;
+    return 0;
+  }
+
+  std::vector<ConstrainedSubTable> subtables;
+  for (const auto& combinations : SubTableCombinations(nPartonsInPermutations))
+    subtables.emplace_back(combinations.second, fOrderedPositions[combinations.first], fForbiddenPositions[combinations.first]);
+
+  if (!UnrankTablePermutation(&subtables, rank, permutation)) {
+    std::cout << "KLFitter::Permutations::UnrankPermutation(). Rank out of range." << std::endl;
+    return 0;
+  }
 
   // no error
   return 1;
 }
 
 // ---------------------------------------------------------
-int KLFitter::Permutations::CreateSubTable(int Nobj, std::vector<std::vector<int> >* table, int Nmax) {
-  if (Nmax < 0) {
-    std::vector<int> vidx;
-    for (int i(0); i < Nobj; ++i) {
-      vidx.push_back(i);
-    }
+long long KLFitter::Permutations::RankPermutation(const std::vector<int>& permutation, int nPartonsInPermutations) {
+  if (!CheckParticles())
+    return -1;
 
-    do {
-      table->emplace_back(std::vector<int>(vidx));
-    } while (std::next_permutation(vidx.begin(), vidx.end()));
-  } else {
-    std::vector<std::vector<int> > v = Get_M_from_N(Nobj, Nmax);
+  if (!fGroupInvariances.empty()) {
+    std::cout << "KLFitter::Permutations::RankPermutation(). Not available with group invariances." << std::endl;
+    return -1;
+  }
+
+  long long rank = 0;
+  std::size_t offset = 0;
+  for (const auto& combinations : SubTableCombinations(nPartonsInPermutations)) {
+    ConstrainedSubTable subtable(combinations.second, fOrderedPositions[combinations.first], fForbiddenPositions[combinations.first]);
+    const std::size_t size = combinations.second.empty() ? 0 : combinations.second.front().size();
+    if (offset + size > permutation.size())
+      return -1;
+    const long long subrank = subtable.Rank(std::vector<int>(permutation.begin() + offset, permutation.begin() + offset + size));
+    if (subrank < 0)
+      return -1;
+    rank = rank * subtable.Count() + subrank;
+    offset += size;
+  }
+  if (offset != permutation.size())
+    return -1;
+
+  return rank;
+}
+
+// ---------------------------------------------------------
+std::vector<std::pair<KLFitter::Particles::ParticleType, std::vector<std::vector<int> > > >
+KLFitter::Permutations::SubTableCombinations(int nPartonsInPermutations) {
+  std::vector<std::pair<KLFitter::Particles::ParticleType, std::vector<std::vector<int> > > > result;
+  for (KLFitter::Particles::ParticleType ptype : kPermutedTypes) {
+    const int nobj = (*fParticles)->NParticles(ptype);
+    std::vector<std::vector<int> > combinations;
+    KLFitter::PermutationIterator iterator(nobj, ptype == KLFitter::Particles::kParton ? nPartonsInPermutations : -1);
+    for (; iterator.Valid(); iterator.NextCombination())
+      combinations.emplace_back(iterator.Combination());
+    result.emplace_back(ptype, combinations);
+  }
+  return result;
+}
 
-    for (unsigned int i(0), n(v.size()); i < n; ++i) {
-      std::vector<int> vidx = v[i];
-      do {
-        table->emplace_back(std::vector<int>(vidx));
-      } while (std::next_permutation(vidx.begin(), vidx.end()));
+// ---------------------------------------------------------
+int KLFitter::Permutations::CreateSubTable(int Nobj, std::vector<std::vector<int> >* table, int Nmax,
+                                           const std::vector<std::pair<int, int> >& ordered,
+                                           const std::vector<std::pair<int, int> >& forbidden) {
+  if (!ordered.empty() || !forbidden.empty()) {
+    // create only the permutations which fulfil the constraints, in
+    // the same order as below
+    for (KLFitter::PermutationIterator iterator(Nobj, Nmax); iterator.Valid(); iterator.NextCombination()) {
+      const std::vector<int>& values = iterator.Combination();
+      std::vector<std::vector<int> > before(values.size());
+      for (const auto& positions : ordered) {
+        if (positions.second < static_cast<int>(values.size()))
+          before[positions.second].push_back(positions.first);
+      }
+      std::vector<std::vector<int> > forbiddenvalues(values.size());
+      for (const auto& position : forbidden) {
+        if (position.first < static_cast<int>(values.size()))
+          forbiddenvalues[position.first].push_back(position.second);
+      }
+      std::vector<int> permutation(values.size());
+      std::vector<bool> used(values.size(), false);
+      AddConstrainedPermutations(values, before, forbiddenvalues, 0, &permutation, &used, table);
     }
+  } else {
+    for (KLFitter::PermutationIterator iterator(Nobj, Nmax); iterator.Valid(); iterator.Next())
+      table->emplace_back(iterator.Permutation());
   }
 
   // no error
@@ -305,10 +915,21 @@ int KLFitter::Permutations::InvariantParticlePermutations(KLFitter::Particles::P
   // no error
   int err = 1;
 
+  // before the creation of the permutations, only the permutations
+  // with increasing indices in all pairs of positions are created
+  if (!fCreated) {
+    for (std::size_t i = 0; i < indexVector.size(); ++i) {
+      for (std::size_t j = i + 1; j < indexVector.size(); ++j)
+        fOrderedPositions[ptype].emplace_back(indexVector[i], indexVector[j]);
+    }
+    return err;
+  }
+
   // loop over all permutations (if there are only 2 indices left)
   if (indexVector.size() == 2) {
     // get number of permutations
     int nperm = NPermutations();
+    std::vector<bool> remove(nperm, false);
 
     for (int iperm = nperm-1; iperm >= 0; --iperm) {
       int offset = 0;
@@ -322,11 +943,10 @@ int KLFitter::Permutations::InvariantParticlePermutations(KLFitter::Particles::P
 
       // check indices
       if (permutation[index1] >= permutation[index2]) {
-        fPermutationTable.erase(fPermutationTable.begin() + iperm);
-
-        fParticlesTable.erase(fParticlesTable.begin() + iperm);
+        remove[iperm] = true;
       }
     }
+    ErasePermutations(remove);
   } else {
     // repeat until there are only 2 indices left
     while (indexVector.size() >= 2) {
@@ -390,54 +1010,61 @@ int KLFitter::Permutations::InvariantParticleGroupPermutations(KLFitter::Particl
     }
   }
 
-  // swap indices
-  indexVectorPosition1.clear();
-  std::set<int>::iterator it_indexSetPosition1Begin = indexSetPosition1.begin();
-  std::set<int>::iterator it_indexSetPosition1End   = indexSetPosition1.end();
-  for (; it_indexSetPosition1Begin != it_indexSetPosition1End; it_indexSetPosition1Begin++)
-    indexVectorPosition1.push_back(*it_indexSetPosition1Begin);
-
-  // no error
-  int err = 1;
-
-  // loop over all permutations
-  // get number of permutations
-  int nperm = NPermutations();
-
-  for (int iperm1 = nperm-1; iperm1 >= 1; --iperm1) {
-    int offset = 0;
-    for (KLFitter::Particles::ParticleType itype = KLFitter::Particles::kParton; itype < ptype; ++itype)
-      offset += (*fParticles)->NParticles(itype);
-
-    // get permutation
-    const std::vector<int>& permutation1 = fPermutationTable[iperm1];
-
-    for (int iperm2 = iperm1-1; iperm2 >= 0; --iperm2) {
-      // get second permutation
-      const std::vector<int>& permutation2 = fPermutationTable[iperm2];
-
-      // loop over index vectors
-      unsigned int numberOfInvariantMatches(0);
+  // before the creation of the permutations, the invariance is
+  // applied right after the creation
+  if (!fCreated) {
+    GroupInvariance group;
+    group.ptype = ptype;
+    group.indexVectorPosition1 = indexVectorPosition1;
+    group.indexVectorPosition2 = indexVectorPosition2;
+    fGroupInvariances.push_back(group);
+    return 1;
+  }
 
-      for (unsigned int i = 0, I = indexVectorPosition1.size(); i < I; i++)  {
-        int indexPosition1 = indexVectorPosition1[i] + offset;
-        int indexPosition2 = indexVectorPosition2[i] + offset;
+  int offset = 0;
+  for (KLFitter::Particles::ParticleType itype = KLFitter::Particles::kParton; itype < ptype; ++itype)
+    offset += (*fParticles)->NParticles(itype);
 
-        // check indices
-        if (permutation1[indexPosition1] == permutation2[indexPosition2] && permutation1[indexPosition2] == permutation2[indexPosition1])
-          numberOfInvariantMatches++;
+  // check that the positions are part of the permutations
+  if (NPermutations() > 0) {
+    const int size = static_cast<int>(fPermutationTable.front().size());
+    for (unsigned int i = 0, I = indexVectorPosition1.size(); i < I; i++) {
+      if (std::max(indexVectorPosition1[i], indexVectorPosition2[i]) + offset >= size) {
+        std::cout << "KLFitter::Permutations::InvariantParticleGroupPermutations(). Position not part of the permutations." << std::endl;
+        return 0;
       }
+    }
+  }
 
-      if (numberOfInvariantMatches == indexVectorPosition1.size()) {
-        fPermutationTable.erase(fPermutationTable.begin() + iperm2);
+  // Two permutations are invariant if the particles in the positions
+  // of the two groups are exchanged. Going backwards through the
+  // table, a permutation is removed if a later permutation which is
+  // kept has the exchanged particles. The particles in the group
+  // positions of the kept permutations are stored in a hash set.
+  const std::size_t ngroup = indexVectorPosition1.size();
+  std::unordered_set<std::vector<int>, IndexVectorHash> kept;
+  kept.reserve(fPermutationTable.size());
+  std::vector<bool> remove(fPermutationTable.size(), false);
+  std::vector<int> key(2 * ngroup);
+  std::vector<int> exchanged(2 * ngroup);
+  for (int iperm = NPermutations() - 1; iperm >= 0; --iperm) {
+    const std::vector<int>& permutation = fPermutationTable[iperm];
+    for (std::size_t i = 0; i < ngroup; ++i) {
+      key[i] = permutation[indexVectorPosition1[i] + offset];
+      key[ngroup + i] = permutation[indexVectorPosition2[i] + offset];
+      exchanged[i] = key[ngroup + i];
+      exchanged[ngroup + i] = key[i];
+    }
 
-        fParticlesTable.erase(fParticlesTable.begin() + iperm2);
-      }
-    }  // second permutation
-  }  // first permutation
+    if (kept.count(exchanged))
+      remove[iperm] = true;
+    else
+      kept.insert(key);
+  }
+  ErasePermutations(remove);
 
-  // return error code
-  return err;
+  // no error
+  return 1;
 }
 
 // ---------------------------------------------------------
@@ -452,6 +1079,13 @@ int KLFitter::Permutations::RemoveParticlePermutations(KLFitter::Particles::Part
     return 0;
   }
 
+  // before the creation of the permutations, these permutations are
+  // not created
+  if (!fCreated) {
+    fForbiddenPositions[ptype].emplace_back(position, index);
+    return 1;
+  }
+
   // get offset for the particle type
   int offset = 0;
   for (KLFitter::Particles::ParticleType itype = KLFitter::Particles::kParton; itype < ptype; ++itype)
@@ -459,20 +1093,33 @@ int KLFitter::Permutations::RemoveParticlePermutations(KLFitter::Particles::Part
   position += offset;
 
   // loop over all permutations
+  std::vector<bool> remove(NPermutations(), false);
   for (int iPerm(NPermutations()-1); iPerm >= 0; --iPerm) {
     const std::vector<int>& permutation = fPermutationTable[iPerm];
 
     if (permutation[position] == index) {
-      fPermutationTable.erase(fPermutationTable.begin() + iPerm);
-
-      fParticlesTable.erase(fParticlesTable.begin() + iPerm);
+      remove[iPerm] = true;
     }
   }
+  ErasePermutations(remove);
 
   // return error code;
   return 1;
 }
 
+// ---------------------------------------------------------
+int KLFitter::Permutations::RemovePermutations(const std::vector<bool>& remove) {
+  if (remove.size() != fPermutationTable.size()) {
+    std::cout << "KLFitter::Permutations::RemovePermutations(). Number of flags does not match the number of permutations." << std::endl;
+    return 0;
+  }
+
+  ErasePermutations(remove);
+
+  // no error
+  return 1;
+}
+
 // ---------------------------------------------------------
 int KLFitter::Permutations::CheckParticles() {
   // check if particles are defined
@@ -494,35 +1141,3 @@ int KLFitter::Permutations::CheckParticles() {
 std::vector<std::vector<int> >* KLFitter::Permutations::PermutationTable() {
   return &fPermutationTable;
 }
-
-// ---------------------------------------------------------
-std::vector<int> KLFitter::Permutations::Get_int_vector(int i) {
-  std::vector<int> vtmp;
-  vtmp.push_back(i);
-  return vtmp;
-}
-
-// ---------------------------------------------------------
-std::vector<int> KLFitter::Permutations::Get_int_plus_vector(int i, std::vector<int> v) {
-  std::vector<int> vtmp = Get_int_vector(i);
-  for (unsigned int j(0), jend(v.size()); j < jend; ++j) {
-    vtmp.push_back(v[j]);
-  }
-  return vtmp;
-}
-
-// ---------------------------------------------------------
-std::vector<std::vector<int> > KLFitter::Permutations::Get_M_from_N(unsigned int N, unsigned int M, unsigned int start) {
-  std::vector<std::vector<int> > v(0);
-  for (unsigned int i(start); i < N-(M-1); ++i) {
-    if (M == 1) {
-      v.push_back(Get_int_vector(i));
-    } else {
-      std::vector<std::vector<int> > vnext = Get_M_from_N(N, M-1, i+1);
-      for (unsigned int j(0), jend(vnext.size()); j < jend; ++j) {
-        v.push_back(Get_int_plus_vector(i, vnext[j]));
-      }
-    }
-  }
-  return v;
-}
@@ -19,8 +19,10 @@
 
 #include "KLFitter/ResDoubleGaussBase.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <limits>
 
 // ---------------------------------------------------------
 KLFitter::ResDoubleGaussBase::ResDoubleGaussBase(const char * filename) : KLFitter::ResolutionBase(10) {
@@ -40,6 +42,31 @@ KLFitter::ResDoubleGaussBase::ResDoubleGaussBase(std::vector<double> const& para
 // ---------------------------------------------------------
 KLFitter::ResDoubleGaussBase::~ResDoubleGaussBase() = default;
 
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussBase::GetMean1Derivative(double x) {
+  return NumericDerivative(&ResDoubleGaussBase::GetMean1, x);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussBase::GetSigma1Derivative(double x) {
+  return NumericDerivative(&ResDoubleGaussBase::GetSigma1, x);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussBase::GetAmplitude2Derivative(double x) {
+  return NumericDerivative(&ResDoubleGaussBase::GetAmplitude2, x);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussBase::GetMean2Derivative(double x) {
+  return NumericDerivative(&ResDoubleGaussBase::GetMean2, x);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussBase::GetSigma2Derivative(double x) {
+  return NumericDerivative(&ResDoubleGaussBase::GetSigma2, x);
+}
+
 // ---------------------------------------------------------
 double KLFitter::ResDoubleGaussBase::GetSigma(double xmeas) {
   // Calculate mean width of both gaussians; weight the width of the 2nd one with its amplitude
@@ -68,3 +95,61 @@ double KLFitter::ResDoubleGaussBase::p(double x, double xmeas, bool *good) {
   // calculate double-Gaussian
   return 1./sqrt(2.*M_PI) / (s1 + a2 * s2) * (exp(-(dx-m1)*(dx-m1)/(2 * s1*s1)) + a2 * exp(-(dx-m2)*(dx-m2)/(2 * s2 * s2)));
 }
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussBase::LogPDerivative(double x, double xmeas, bool *good) {
+  double m1 = GetMean1(x);
+  double s1 = GetSigma1(x);
+  double a2 = GetAmplitude2(x);
+  double m2 = GetMean2(x);
+  double s2 = GetSigma2(x);
+  double dm1 = GetMean1Derivative(x);
+  double dm2 = GetMean2Derivative(x);
+
+  // the values clamped by the sanity check are constant (the check
+  // stops at the first negative width)
+  double ds1 = s1 < 0. ? 0. : GetSigma1Derivative(x);
+  double da2 = a2 < 0. ? 0. : GetAmplitude2Derivative(x);
+  double ds2 = (s1 >= 0. && s2 < 0.) ? 0. : GetSigma2Derivative(x);
+  *good = CheckDoubleGaussianSanity(&s1, &a2, &s2);
+
+  double dx = (x - xmeas) / x;
+  double ddx = xmeas / (x * x);
+
+  // log p = log(g1 + a2 * g2) - log(s1 + a2 * s2) + const, where both
+  // Gaussians are scaled by the larger one to avoid underflows
+  double q1 = -(dx-m1)*(dx-m1)/(2 * s1*s1);
+  double q2 = -(dx-m2)*(dx-m2)/(2 * s2*s2);
+  double qmax = a2 > 0. ? std::max(q1, q2) : q1;
+  double g1 = exp(q1 - qmax);
+  double g2 = exp(q2 - qmax);
+  double dq1 = -(dx-m1)*(ddx-dm1)/(s1*s1) + (dx-m1)*(dx-m1)*ds1/(s1*s1*s1);
+  double dq2 = -(dx-m2)*(ddx-dm2)/(s2*s2) + (dx-m2)*(dx-m2)*ds2/(s2*s2*s2);
+
+  double g = g1 + a2 * g2;
+  double dg = g1 * dq1 + da2 * g2 + a2 * g2 * dq2;
+
+  return dg / g - (ds1 + da2 * s2 + a2 * ds2) / (s1 + a2 * s2);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussBase::GetPMax(double xmin, double xmax, double par) {
+  // (1 + a2) / (s1 + a2 * s2) is bounded by 1 / min(s1, s2), and the
+  // minimum of a monotonic width is reached at one of the limits
+  double smin = std::numeric_limits<double>::infinity();
+  for (double x : {xmin, xmax}) {
+    double s1 = GetSigma1(x);
+    double a2 = GetAmplitude2(x);
+    double s2 = GetSigma2(x);
+    CheckDoubleGaussianSanity(&s1, &a2, &s2);
+    smin = std::min(smin, std::min(s1, s2));
+  }
+
+  return 1./sqrt(2.*M_PI) / smin;
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussBase::NumericDerivative(double (ResDoubleGaussBase::*func)(double), double x) {
+  double h = 1e-6 * std::max(std::fabs(x), 1.);
+  return ((this->*func)(x + h) - (this->*func)(x - h)) / (2. * h);
+}
@@ -55,3 +55,28 @@ double KLFitter::ResDoubleGaussE_1::GetMean2(double x) {
 double KLFitter::ResDoubleGaussE_1::GetSigma2(double x) {
   return fParameters[8] + fParameters[9] * x;
 }
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_1::GetMean1Derivative(double x) {
+  return fParameters[1];
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_1::GetSigma1Derivative(double x) {
+  return -0.5 * fParameters[2] / (x * sqrt(x));
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_1::GetAmplitude2Derivative(double x) {
+  return fParameters[5];
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_1::GetMean2Derivative(double x) {
+  return fParameters[7];
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_1::GetSigma2Derivative(double x) {
+  return fParameters[9];
+}
@@ -55,3 +55,28 @@ double KLFitter::ResDoubleGaussE_2::GetMean2(double x) {
 double KLFitter::ResDoubleGaussE_2::GetSigma2(double x) {
   return fParameters[8] + fParameters[9] * x;
 }
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_2::GetMean1Derivative(double x) {
+  return -0.5 * fParameters[0] / (x * sqrt(x)) + fParameters[1];
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_2::GetSigma1Derivative(double x) {
+  return -0.5 * fParameters[2] / (x * sqrt(x));
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_2::GetAmplitude2Derivative(double x) {
+  return -0.5 * fParameters[4] / (x * sqrt(x)) + fParameters[5];
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_2::GetMean2Derivative(double x) {
+  return fParameters[7];
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_2::GetSigma2Derivative(double x) {
+  return fParameters[9];
+}
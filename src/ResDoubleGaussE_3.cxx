@@ -55,3 +55,28 @@ double KLFitter::ResDoubleGaussE_3::GetMean2(double x) {
 double KLFitter::ResDoubleGaussE_3::GetSigma2(double x) {
   return fParameters[8]/ x + fParameters[9];
 }
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_3::GetMean1Derivative(double x) {
+  return -fParameters[0] / (x * x);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_3::GetSigma1Derivative(double x) {
+  return -0.5 * fParameters[2]*fParameters[2] / (x * x) / GetSigma1(x);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_3::GetAmplitude2Derivative(double x) {
+  return fParameters[5];
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_3::GetMean2Derivative(double x) {
+  return -fParameters[6] / (x * x);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_3::GetSigma2Derivative(double x) {
+  return -fParameters[8] / (x * x);
+}
@@ -55,3 +55,28 @@ double KLFitter::ResDoubleGaussE_4::GetMean2(double x) {
 double KLFitter::ResDoubleGaussE_4::GetSigma2(double x) {
   return fParameters[8] + fParameters[9] * x;
 }
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_4::GetMean1Derivative(double x) {
+  return -fParameters[1] / (x * x);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_4::GetSigma1Derivative(double x) {
+  return -0.5 * fParameters[3] / (x * sqrt(x));
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_4::GetAmplitude2Derivative(double x) {
+  return -fParameters[5] / (x * x);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_4::GetMean2Derivative(double x) {
+  return -0.5 * fParameters[7] / (x * sqrt(x));
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussE_4::GetSigma2Derivative(double x) {
+  return fParameters[9];
+}
@@ -55,3 +55,28 @@ double KLFitter::ResDoubleGaussPt::GetMean2(double x) {
 double KLFitter::ResDoubleGaussPt::GetSigma2(double x) {
   return fParameters[8] + x * fParameters[9];
 }
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussPt::GetMean1Derivative(double x) {
+  return fParameters[1];
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussPt::GetSigma1Derivative(double x) {
+  return fParameters[3];
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussPt::GetAmplitude2Derivative(double x) {
+  return fParameters[5];
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussPt::GetMean2Derivative(double x) {
+  return fParameters[7];
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResDoubleGaussPt::GetSigma2Derivative(double x) {
+  return fParameters[9];
+}
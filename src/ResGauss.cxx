@@ -48,3 +48,14 @@ double KLFitter::ResGauss::p(double x, double xmeas, bool *good) {
   *good = true;
   return TMath::Gaus(xmeas, x, fParameters[0], true);
 }
+
+// ---------------------------------------------------------
+double KLFitter::ResGauss::LogPDerivative(double x, double xmeas, bool *good) {
+  *good = true;
+  return (xmeas - x) / (fParameters[0] * fParameters[0]);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResGauss::GetPMax(double xmin, double xmax, double par) {
+  return TMath::Gaus(0., 0., fParameters[0], true);
+}
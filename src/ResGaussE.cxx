@@ -19,7 +19,10 @@
 
 #include "KLFitter/ResGaussE.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+
 #include "TMath.h"
 
 // ---------------------------------------------------------
@@ -49,3 +52,30 @@ double KLFitter::ResGaussE::p(double x, double xmeas, bool *good) {
   double sigma = GetSigma(x);
   return TMath::Gaus(xmeas, x, sigma, true);
 }
+
+// ---------------------------------------------------------
+double KLFitter::ResGaussE::LogPDerivative(double x, double xmeas, bool *good) {
+  *good = true;
+  // log p = -u^2/2 - log(sigma) + const with u = (xmeas - x)/sigma,
+  // where sigma depends on x as well
+  double sigma = GetSigma(x);
+  double dsigma = fParameters[0] + 0.5 * fParameters[1] / sqrt(x);
+  double u = (xmeas - x) / sigma;
+  return (u * (1. + u * dsigma) - dsigma) / sigma;
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResGaussE::GetPMax(double xmin, double xmax, double par) {
+  // the width is a quadratic function of sqrt(x), its minimum is
+  // reached at one of the limits or at the vertex
+  double sigma = std::min(GetSigma(xmin), GetSigma(xmax));
+  if (fParameters[0] > 0) {
+    double u = -fParameters[1] / (2. * fParameters[0]);
+    if (u > 0 && u * u > xmin && u * u < xmax)
+      sigma = std::min(sigma, GetSigma(u * u));
+  }
+  if (sigma <= 0)
+    return std::numeric_limits<double>::infinity();
+
+  return TMath::Gaus(0., 0., sigma, true);
+}
@@ -19,7 +19,9 @@
 
 #include "KLFitter/ResGaussPt.h"
 
+#include <algorithm>
 #include <iostream>
+
 #include "TMath.h"
 
 // ---------------------------------------------------------
@@ -52,3 +54,18 @@ double KLFitter::ResGaussPt::p(double x, double xmeas, bool *good) {
   double sigma = GetSigma(x);
   return TMath::Gaus(xmeas, x, sigma, true);
 }
+
+// ---------------------------------------------------------
+double KLFitter::ResGaussPt::LogPDerivative(double x, double xmeas, bool *good) {
+  *good = true;
+  // the width is piecewise constant
+  double sigma = GetSigma(x);
+  return (xmeas - x) / (sigma * sigma);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResGaussPt::GetPMax(double xmin, double xmax, double par) {
+  // the width is constant below and above 200
+  double sigma = std::min(GetSigma(xmin), GetSigma(xmax));
+  return TMath::Gaus(0., 0., sigma, true);
+}
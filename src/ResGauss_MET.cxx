@@ -53,3 +53,15 @@ double KLFitter::ResGauss_MET::p(double x, double xmeas, bool *good, double sume
   double sigma = GetSigma(sumet);
   return TMath::Gaus(xmeas, x, sigma, true);
 }
+
+// ---------------------------------------------------------
+double KLFitter::ResGauss_MET::LogPDerivative(double x, double xmeas, bool *good, double sumet) {
+  *good = true;
+  double sigma = GetSigma(sumet);
+  return (xmeas - x) / (sigma * sigma);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResGauss_MET::GetPMax(double xmin, double xmax, double sumet) {
+  return TMath::Gaus(0., 0., GetSigma(sumet), true);
+}
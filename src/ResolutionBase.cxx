@@ -19,8 +19,11 @@
 
 #include "KLFitter/ResolutionBase.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <limits>
 
 // ---------------------------------------------------------
 KLFitter::ResolutionBase::ResolutionBase(int npar) {
@@ -48,6 +51,33 @@ KLFitter::ResolutionBase::ResolutionBase(std::vector <double> parameters) {
 // ---------------------------------------------------------
 KLFitter::ResolutionBase::~ResolutionBase() = default;
 
+// ---------------------------------------------------------
+double KLFitter::ResolutionBase::GetPMax(double xmin, double xmax, double par) {
+  return std::numeric_limits<double>::infinity();
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResolutionBase::LogPDerivative(double x, double xmeas, bool *good) {
+  const double h = 1e-6 * std::max(std::fabs(x), 1.);
+  bool goodup = true;
+  bool gooddown = true;
+  const double up = std::log(p(x + h, xmeas, &goodup));
+  const double down = std::log(p(x - h, xmeas, &gooddown));
+  *good = goodup && gooddown;
+  return (up - down) / (2. * h);
+}
+
+// ---------------------------------------------------------
+double KLFitter::ResolutionBase::LogPDerivative(double x, double xmeas, bool *good, double par) {
+  const double h = 1e-6 * std::max(std::fabs(x), 1.);
+  bool goodup = true;
+  bool gooddown = true;
+  const double up = std::log(p(x + h, xmeas, &goodup, par));
+  const double down = std::log(p(x - h, xmeas, &gooddown, par));
+  *good = goodup && gooddown;
+  return (up - down) / (2. * h);
+}
+
 // ---------------------------------------------------------
 int KLFitter::ResolutionBase::Par(int index, double *par) {
   // check parameter range
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2009--2018, the KLFitter developer team
+ *
+ * This file is part of KLFitter.
+ *
+ * KLFitter is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * KLFitter is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with KLFitter. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the likelihoods of LikelihoodTTHLeptonJets,
+// LikelihoodTTZTrilepton, LikelihoodTopAllHadronic and
+// LikelihoodSgTopWtLJ against reference values and their analytic
+// gradients against central finite differences. The reference values
+// were computed with the likelihoods before they were templated on
+// the number type.
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "KLFitter/DetectorSnowmass.h"
+#include "KLFitter/Fitter.h"
+#include "KLFitter/LikelihoodSgTopWtLJ.h"
+#include "KLFitter/LikelihoodTTHLeptonJets.h"
+#include "KLFitter/LikelihoodTTZTrilepton.h"
+#include "KLFitter/LikelihoodTopAllHadronic.h"
+#include "KLFitter/Permutations.h"
+#include "TLorentzVector.h"
+
+namespace {
+const double met_x{24.409};
+const double met_y{9.302};
+const double sumet{126.126};
+const double tolerance{1e-5};
+const double reference_tolerance{1e-10};
+
+// The number of permutations checked per likelihood, each at the
+// initial parameters scaled by the factors below.
+const int npermutations{4};
+const std::vector<double> factors{0.98, 1.0, 1.02};
+
+// LikelihoodSgTopWtLJ does not define the likelihood components.
+class LikelihoodSgTopWtLJ : public KLFitter::LikelihoodSgTopWtLJ {
+ public:
+  std::vector<double> LogLikelihoodComponents(std::vector<double>) override { return {}; }
+};
+
+// An event with the first njets jets and nleptons electrons of a fixed
+// list; the first two jets are b-tagged.
+std::unique_ptr<KLFitter::Particles> getExampleParticles(int njets, int nleptons) {
+  const std::vector<std::vector<double> > jets{{109.76644, -1.72677, -1.89648, 321.52453},
+                                               {42.62102, 1.70513, -1.70058, 122.33720},
+                                               {129.14176, 1.58536, -2.52456, 331.68742},
+                                               {115.65143, 1.55883, 0.11097, 289.89696},
+                                               {100.51990, 1.14155, 1.46838, 175.17933},
+                                               {146.40852, 0.69004, 3.02919, 184.49715}};
+  const std::vector<std::vector<double> > leptons{{36.50896, 0.66745, 2.61193, 44.95000},
+                                                  {46.38216, -0.21381, -1.83514, 47.45000},
+                                                  {44.30869, 0.87361, 1.70395, 62.32200}};
+
+  std::unique_ptr<KLFitter::Particles> particles{new KLFitter::Particles};
+  for (int i = 0; i < njets; ++i) {
+    TLorentzVector jet{};
+    jet.SetPtEtaPhiE(jets[i][0], jets[i][1], jets[i][2], jets[i][3]);
+    particles->AddParticle(&jet, jet.Eta(), KLFitter::Particles::kParton, "", i, i < 2, 0.7, 125.);
+  }
+  for (int i = 0; i < nleptons; ++i) {
+    TLorentzVector lep{};
+    lep.SetPtEtaPhiE(leptons[i][0], leptons[i][1], leptons[i][2], leptons[i][3]);
+    particles->AddParticle(&lep, lep.Eta(), KLFitter::Particles::kElectron, "", i);
+  }
+  return particles;
+}
+
+// The relative deviation of an analytic from a numerical derivative.
+double deviation(double analytic, double numeric) {
+  return std::fabs(analytic - numeric) / std::max(1., std::fabs(numeric));
+}
+
+// Compare the likelihood of the first permutations at a few points
+// around the initial parameters with the reference values and the
+// gradient with the numerical one, and return the number of
+// deviations.
+int checkLikelihood(const std::string& name, KLFitter::LikelihoodBase* lh, KLFitter::Particles* particles,
+                    KLFitter::DetectorBase* detector, const std::vector<double>& reference) {
+  KLFitter::Fitter fitter{};
+  fitter.SetLikelihood(lh);
+  if (!fitter.SetDetector(detector)) {
+    std::cerr << "Setting up the detector failed" << std::endl;
+    return 1;
+  }
+  fitter.SetParticles(particles);
+  if (!lh->HasAnalyticGradient() || fitter.Permutations()->NPermutations() < npermutations) {
+    std::cout << name << ": no analytic gradient or too few permutations" << std::endl;
+    return 1;
+  }
+
+  int ndeviations{0};
+  std::size_t ireference{0};
+  for (int iperm = 0; iperm < npermutations; ++iperm) {
+    fitter.Permutations()->SetPermutation(iperm);
+    lh->SetET_miss_XY_SumET(met_x, met_y, sumet);
+    lh->Initialize();
+    const std::vector<double> initial = lh->GetInitialParameters();
+    for (const double factor : factors) {
+      std::vector<double> parameters{initial};
+      for (auto& par : parameters) { par *= factor; }
+      const double value = lh->LogLikelihood(parameters);
+      if (ireference >= reference.size() ||
+          !(std::fabs(value - reference[ireference]) <= reference_tolerance * std::fabs(reference[ireference]))) {
+        std::cout << std::setprecision(17) << name << ", permutation " << iperm << ", factor " << factor
+                  << ": log-likelihood " << value << std::endl;
+        ++ndeviations;
+      }
+      ++ireference;
+
+      std::vector<double> analytic{};
+      std::vector<double> numeric{};
+      if (lh->LogLikelihoodGradient(parameters, &analytic) != value) {
+        std::cout << name << ", permutation " << iperm << ": the gradient changes the log-likelihood" << std::endl;
+        ++ndeviations;
+      }
+      lh->LikelihoodBase::LogLikelihoodGradient(parameters, &numeric);
+      if (analytic.size() != numeric.size()) {
+        ++ndeviations;
+        continue;
+      }
+      for (std::size_t i = 0; i < analytic.size(); ++i) {
+        if (!(deviation(analytic[i], numeric[i]) < tolerance)) {
+          std::cout << name << ", permutation " << iperm << ", parameter " << i << ": analytic " << analytic[i]
+                    << ", numerical " << numeric[i] << std::endl;
+          ++ndeviations;
+        }
+      }
+    }
+  }
+  return ndeviations;
+}
+}  // namespace
+
+// ---------------------------------------------------------
+// ---------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Wrong number of arguments." << std::endl;
+    std::cerr << "Usage: test-lh-gradients [base directory]" << std::endl;
+    return -1;
+  }
+  const auto base_dir = std::string(argv[1]);
+
+  KLFitter::DetectorSnowmass detector{base_dir + "/data/transferfunctions/snowmass"};
+  int ndeviations{0};
+
+  {
+    const auto particles = getExampleParticles(6, 1);
+    KLFitter::LikelihoodTTHLeptonJets lh{};
+    lh.SetLeptonType(KLFitter::LikelihoodTTHLeptonJets::kElectron);
+    const std::vector<double> reference{-107.92718801762646, -105.52416674339472, -108.55136872529246,
+                                        -106.08846178006699, -103.67474259301085, -106.69133870003813,
+                                        -105.60801465024733, -103.22693423666017, -106.27462540850691,
+                                        -103.47191592269165, -101.07242499518948, -104.1012673150701};
+    ndeviations += checkLikelihood("LikelihoodTTHLeptonJets", &lh, particles.get(), &detector, reference);
+  }
+
+  {
+    const auto particles = getExampleParticles(4, 3);
+    KLFitter::LikelihoodTTZTrilepton lh{};
+    lh.SetLeptonType(KLFitter::LikelihoodTTZTrilepton::kElectron);
+    const std::vector<double> reference{-65.708745722923666, -60.179192197077931, -66.104582355129267,
+                                        -66.801225562013656, -61.272704572260146, -67.199148194536917,
+                                        -65.97012063022072, -60.440944775886912, -66.366723288049627,
+                                        -59.851211614482189, -54.382163667233272, -60.360343691641653};
+    ndeviations += checkLikelihood("LikelihoodTTZTrilepton", &lh, particles.get(), &detector, reference);
+  }
+
+  {
+    const auto particles = getExampleParticles(6, 0);
+    KLFitter::LikelihoodTopAllHadronic lh{};
+    const std::vector<double> reference{-108.39409899965648, -108.6259478237823, -109.25110980011243,
+                                        -110.15455934922382, -110.37603075835094, -110.99155358127548,
+                                        -105.56115831570355, -105.82675308471073, -106.48297195640863,
+                                        -105.07753879091401, -105.34311220887082, -105.9993110533007};
+    ndeviations += checkLikelihood("LikelihoodTopAllHadronic", &lh, particles.get(), &detector, reference);
+  }
+
+  {
+    const auto particles = getExampleParticles(4, 1);
+    LikelihoodSgTopWtLJ lh{};
+    lh.SetLeptonType(KLFitter::LikelihoodSgTopWtLJ::kElectron);
+    lh.SetHadronicTop();
+    const std::vector<double> reference{-74.858696850911628, -72.274579506302985, -74.893432846966334,
+                                        -76.02482108845507, -73.716427793058173, -76.600535934336122,
+                                        -81.709584106646957, -79.285240334804598, -82.129691747596013,
+                                        -84.438081285254981, -82.038019045176952, -84.846908247840034};
+    ndeviations += checkLikelihood("LikelihoodSgTopWtLJ (hadronic top)", &lh, particles.get(), &detector, reference);
+  }
+
+  {
+    const auto particles = getExampleParticles(4, 1);
+    LikelihoodSgTopWtLJ lh{};
+    lh.SetLeptonType(KLFitter::LikelihoodSgTopWtLJ::kElectron);
+    lh.SetLeptonicTop();
+    const std::vector<double> reference{-69.527789428922219, -67.007993774854128, -69.685313766084931,
+                                        -70.725303766949168, -68.481154583795472, -71.423656664798045,
+                                        -75.488297923457864, -73.130033061694007, -76.034599556943164,
+                                        -71.468350742060167, -70.945064093816882, -74.67207863801049};
+    ndeviations += checkLikelihood("LikelihoodSgTopWtLJ (leptonic top)", &lh, particles.get(), &detector, reference);
+  }
+
+  std::cout << "Likelihoods and gradients: " << ndeviations << " deviations" << std::endl;
+
+  return ndeviations == 0 ? 0 : -1;
+}
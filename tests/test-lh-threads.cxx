@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2009--2018, the KLFitter developer team
+ *
+ * This file is part of KLFitter.
+ *
+ * KLFitter is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * KLFitter is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with KLFitter. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks that likelihoods and fitters in different threads do not
+// interfere: concurrent evaluations and batch fits must reproduce
+// the single-threaded results exactly. The test is meant to be run
+// under ThreadSanitizer as well.
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "KLFitter/DetectorSnowmass.h"
+#include "KLFitter/Fitter.h"
+#include "KLFitter/LikelihoodTopLeptonJets.h"
+#include "KLFitter/Permutations.h"
+#include "TLorentzVector.h"
+
+namespace {
+const unsigned int nthreads{4};
+const double met_x{24.409};
+const double met_y{9.302};
+const double sumet{26.126};
+
+std::unique_ptr<KLFitter::Particles> getExampleParticles(double scale) {
+  TLorentzVector jet1{};
+  jet1.SetPtEtaPhiE(133.56953 * scale, 0.2231264, 1.7798618, 137.56292 * scale);
+  TLorentzVector jet2{};
+  jet2.SetPtEtaPhiE(77.834281 * scale, 0.8158330, -1.533635, 105.72334 * scale);
+  TLorentzVector jet3{};
+  jet3.SetPtEtaPhiE(49.327293 * scale, 1.9828589, -1.878274, 182.64006 * scale);
+  TLorentzVector jet4{};
+  jet4.SetPtEtaPhiE(43.140816 * scale, 0.4029131, -0.472721, 47.186804 * scale);
+  TLorentzVector lep{};
+  lep.SetPtEtaPhiE(30.501886, 0.4483959, 2.9649317, 33.620113);
+
+  std::unique_ptr<KLFitter::Particles> particles{new KLFitter::Particles};
+  particles->AddParticle(&jet1, jet1.Eta(), KLFitter::Particles::kParton, "", 0, false, 0.7, 125.);
+  particles->AddParticle(&jet2, jet2.Eta(), KLFitter::Particles::kParton, "", 1, false, 0.7, 125.);
+  particles->AddParticle(&jet3, jet3.Eta(), KLFitter::Particles::kParton, "", 2, true, 0.7, 125.);
+  particles->AddParticle(&jet4, jet4.Eta(), KLFitter::Particles::kParton, "", 3, false, 0.7, 125.);
+  particles->AddParticle(&lep, lep.Eta(), KLFitter::Particles::kMuon, "", 0);
+  return particles;
+}
+
+std::unique_ptr<KLFitter::LikelihoodBase> createLikelihood() {
+  std::unique_ptr<KLFitter::LikelihoodTopLeptonJets> lh{new KLFitter::LikelihoodTopLeptonJets};
+  lh->SetLeptonType(KLFitter::LikelihoodTopLeptonJets::LeptonType::kMuon);
+  lh->SetBTagging(KLFitter::LikelihoodBase::BtaggingMethod::kWorkingPoint);
+  return std::unique_ptr<KLFitter::LikelihoodBase>{lh.release()};
+}
+
+// Evaluate the likelihood of every permutation at a few points
+// around the initial parameters, without fitting.
+std::vector<double> evaluateLikelihood(KLFitter::Fitter* fitter) {
+  KLFitter::LikelihoodBase* lh = fitter->Likelihood();
+  std::vector<double> values{};
+  for (int iperm = 0; iperm < fitter->Permutations()->NPermutations(); ++iperm) {
+    fitter->Permutations()->SetPermutation(iperm);
+    lh->SetET_miss_XY_SumET(met_x, met_y, sumet);
+    lh->Initialize();
+    lh->PropagateBTaggingInformation();
+    const std::vector<double> initial = lh->GetInitialParameters();
+    for (const double factor : {0.95, 1.0, 1.05}) {
+      std::vector<double> parameters{initial};
+      for (auto& par : parameters) { par *= factor; }
+      values.emplace_back(lh->LogLikelihood(parameters));
+    }
+    values.emplace_back(lh->LogEventProbabilityBTag());
+  }
+  return values;
+}
+}  // namespace
+
+
+// ---------------------------------------------------------
+// ---------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Wrong number of arguments." << std::endl;
+    std::cerr << "Usage: test-lh-threads [base directory]" << std::endl;
+    return -1;
+  }
+  const auto base_dir = std::string(argv[1]);
+
+  KLFitter::DetectorSnowmass detector{base_dir + "/data/transferfunctions/snowmass"};
+  const auto particles = getExampleParticles(1.);
+
+  // Reference values from a single thread.
+  KLFitter::Fitter fitter{};
+  auto lh = createLikelihood();
+  fitter.SetLikelihood(lh.get());
+  if (!fitter.SetDetector(&detector)) {
+    std::cerr << "Setting up the detector failed" << std::endl;
+    return -1;
+  }
+  fitter.SetParticles(particles.get());
+  const std::vector<double> reference = evaluateLikelihood(&fitter);
+
+  // The same evaluation in several threads at once, with one
+  // fitter and cloned likelihood per thread and a shared detector.
+  std::vector<std::unique_ptr<KLFitter::Fitter> > fitters{};
+  std::vector<std::unique_ptr<KLFitter::LikelihoodBase> > likelihoods{};
+  for (unsigned int i = 0; i < nthreads; ++i) {
+    fitters.emplace_back(new KLFitter::Fitter{});
+    likelihoods.emplace_back(lh->Clone());
+    fitters.back()->SetLikelihood(likelihoods.back().get());
+    fitters.back()->SetDetector(&detector);
+    fitters.back()->SetParticles(particles.get());
+  }
+  std::vector<std::vector<double> > values(nthreads);
+  std::vector<std::thread> threads{};
+  for (unsigned int i = 0; i < nthreads; ++i) {
+    threads.emplace_back([&fitters, &values, i]() {
+      for (int repeat = 0; repeat < 20; ++repeat) {
+        values.at(i) = evaluateLikelihood(fitters.at(i).get());
+      }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+
+  int nfailed{0};
+  for (const auto& thread_values : values) {
+    if (thread_values != reference) ++nfailed;
+  }
+  std::cout << "Concurrent likelihood evaluation: " << nthreads << " threads, "
+            << nfailed << " with deviating results" << std::endl;
+
+  // A batch fit of several events must reproduce the serial fits,
+  // both with the default Minuit in BAT and with Minuit2. Simulated
+  // annealing is turned off, as its random numbers depend on the
+  // history of each likelihood.
+  fitter.TurnOffSA();
+  std::vector<std::unique_ptr<KLFitter::Particles> > events{};
+  std::vector<KLFitter::Fitter::BatchEvent> batch{};
+  for (int ievent = 0; ievent < 8; ++ievent) {
+    events.emplace_back(getExampleParticles(0.9 + 0.025 * ievent));
+    batch.emplace_back(events.back().get(), met_x, met_y, sumet);
+  }
+
+  int ndeviations{0};
+  for (const bool minuit2 : {false, true}) {
+    fitter.SetUseMinuit2(minuit2);
+    std::vector<KLFitter::Fitter::EventResult> results{};
+    if (!fitter.FitBatch(batch, &results, nthreads)) {
+      std::cerr << "The batch fit failed" << std::endl;
+      return -1;
+    }
+
+    int nbatch{0};
+    for (std::size_t ievent = 0; ievent < events.size(); ++ievent) {
+      fitter.SetParticles(events.at(ievent).get());
+      fitter.SetET_miss_XY_SumET(met_x, met_y, sumet);
+      const auto& result = results.at(ievent);
+      if (result.status != 1 || static_cast<int>(result.permutations.size()) != fitter.Permutations()->NPermutations()) {
+        ++nbatch;
+        continue;
+      }
+      for (int iperm = 0; iperm < fitter.Permutations()->NPermutations(); ++iperm) {
+        fitter.Fit(iperm);
+        const auto& perm = result.permutations.at(iperm);
+        if (perm.parameters != fitter.Likelihood()->GetBestFitParameters() ||
+            perm.minuitStatus != fitter.MinuitStatus() ||
+            perm.convergenceStatus != fitter.ConvergenceStatus()) {
+          ++nbatch;
+        }
+      }
+    }
+    std::cout << "Batch fit" << (minuit2 ? " with Minuit2: " : ": ") << events.size() << " events, "
+              << nbatch << " deviating permutations" << std::endl;
+    ndeviations += nbatch;
+  }
+
+  return (nfailed == 0 && ndeviations == 0) ? 0 : -1;
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2009--2018, the KLFitter developer team
+ *
+ * This file is part of KLFitter.
+ *
+ * KLFitter is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * KLFitter is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with KLFitter. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the analytic gradient of LikelihoodTopLeptonJets and the
+// derivatives of the transfer functions against central finite
+// differences, and the fit with the analytic gradient against the
+// default fit.
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "KLFitter/DetectorSnowmass.h"
+#include "KLFitter/Fitter.h"
+#include "KLFitter/LikelihoodTopLeptonJets.h"
+#include "KLFitter/Permutations.h"
+#include "KLFitter/ResDoubleGaussE_1.h"
+#include "KLFitter/ResDoubleGaussE_2.h"
+#include "KLFitter/ResDoubleGaussE_3.h"
+#include "KLFitter/ResDoubleGaussE_4.h"
+#include "KLFitter/ResDoubleGaussE_5.h"
+#include "KLFitter/ResDoubleGaussPt.h"
+#include "TLorentzVector.h"
+
+namespace {
+const double met_x{24.409};
+const double met_y{9.302};
+const double sumet{26.126};
+const double tolerance{1e-5};
+const double fit_tolerance{1e-2};
+
+std::unique_ptr<KLFitter::Particles> getExampleParticles(KLFitter::Particles::ParticleType lepton_type) {
+  TLorentzVector jet1{};
+  jet1.SetPtEtaPhiE(133.56953, 0.2231264, 1.7798618, 137.56292);
+  TLorentzVector jet2{};
+  jet2.SetPtEtaPhiE(77.834281, 0.8158330, -1.533635, 105.72334);
+  TLorentzVector jet3{};
+  jet3.SetPtEtaPhiE(49.327293, 1.9828589, -1.878274, 182.64006);
+  TLorentzVector jet4{};
+  jet4.SetPtEtaPhiE(43.140816, 0.4029131, -0.472721, 47.186804);
+  TLorentzVector lep{};
+  lep.SetPtEtaPhiE(30.501886, 0.4483959, 2.9649317, 33.620113);
+
+  std::unique_ptr<KLFitter::Particles> particles{new KLFitter::Particles};
+  particles->AddParticle(&jet1, jet1.Eta(), KLFitter::Particles::kParton, "", 0, false, 0.7, 125.);
+  particles->AddParticle(&jet2, jet2.Eta(), KLFitter::Particles::kParton, "", 1, false, 0.7, 125.);
+  particles->AddParticle(&jet3, jet3.Eta(), KLFitter::Particles::kParton, "", 2, true, 0.7, 125.);
+  particles->AddParticle(&jet4, jet4.Eta(), KLFitter::Particles::kParton, "", 3, false, 0.7, 125.);
+  particles->AddParticle(&lep, lep.Eta(), lepton_type, "", 0);
+  return particles;
+}
+
+// The relative deviation of an analytic from a numerical derivative.
+double deviation(double analytic, double numeric) {
+  return std::fabs(analytic - numeric) / std::max(1., std::fabs(numeric));
+}
+
+// Compare the gradient of every permutation at a few points around
+// the initial parameters and return the number of deviations.
+int checkLikelihoodGradient(KLFitter::Fitter* fitter) {
+  KLFitter::LikelihoodBase* lh = fitter->Likelihood();
+  int ndeviations{0};
+  for (int iperm = 0; iperm < fitter->Permutations()->NPermutations(); ++iperm) {
+    fitter->Permutations()->SetPermutation(iperm);
+    lh->SetET_miss_XY_SumET(met_x, met_y, sumet);
+    lh->Initialize();
+    const std::vector<double> initial = lh->GetInitialParameters();
+    for (const double factor : {0.98, 1.0, 1.02}) {
+      std::vector<double> parameters{initial};
+      for (auto& par : parameters) { par *= factor; }
+      std::vector<double> analytic{};
+      std::vector<double> numeric{};
+      const double value = lh->LogLikelihoodGradient(parameters, &analytic);
+      lh->LikelihoodBase::LogLikelihoodGradient(parameters, &numeric);
+      if (value != lh->LogLikelihood(parameters) || analytic.size() != numeric.size()) {
+        ++ndeviations;
+        continue;
+      }
+      for (std::size_t i = 0; i < analytic.size(); ++i) {
+        if (!(deviation(analytic[i], numeric[i]) < tolerance)) {
+          std::cout << "Permutation " << iperm << ", parameter " << i << ": analytic " << analytic[i]
+                    << ", numerical " << numeric[i] << std::endl;
+          ++ndeviations;
+        }
+      }
+    }
+  }
+  return ndeviations;
+}
+
+// Fit every permutation with the default Minuit path and with the
+// analytic gradient (see Fitter::SetUseAnalyticGradient()) and return
+// the number of permutations with a different optimum or Minuit
+// status.
+int checkFitWithGradient(KLFitter::Fitter* fitter) {
+  int ndeviations{0};
+  for (int iperm = 0; iperm < fitter->Permutations()->NPermutations(); ++iperm) {
+    fitter->SetUseAnalyticGradient(false);
+    if (!fitter->Fit(iperm)) {
+      ++ndeviations;
+      continue;
+    }
+    const KLFitter::Fitter::FitResult reference = *fitter->Result(iperm);
+    fitter->SetUseAnalyticGradient(true);
+    if (!fitter->Fit(iperm)) {
+      ++ndeviations;
+      continue;
+    }
+    const KLFitter::Fitter::FitResult& result = *fitter->Result(iperm);
+
+    bool same = result.minuitStatus == reference.minuitStatus &&
+                std::fabs(result.logLikelihood - reference.logLikelihood) < fit_tolerance &&
+                result.parameters.size() == reference.parameters.size();
+    for (std::size_t i = 0; same && i < result.parameters.size(); ++i) {
+      same = std::fabs(result.parameters[i] - reference.parameters[i]) <= 0.5 * reference.parameterErrors[i] + 1e-6;
+    }
+    if (!same) {
+      std::cout << "Permutation " << iperm << ": Minuit status " << result.minuitStatus << " (" << reference.minuitStatus
+                << "), log-likelihood " << result.logLikelihood << " (" << reference.logLikelihood << ")" << std::endl;
+      ++ndeviations;
+    }
+  }
+  fitter->SetUseAnalyticGradient(false);
+  return ndeviations;
+}
+
+// Compare the derivative of a transfer function at a few points and
+// return the number of deviations.
+int checkTFDerivative(KLFitter::ResolutionBase* tf) {
+  int ndeviations{0};
+  for (const double x : {25., 60., 140., 320.}) {
+    for (const double ratio : {0.8, 1.0, 1.15}) {
+      bool good{true};
+      const double analytic = tf->LogPDerivative(x, ratio * x, &good);
+      const double numeric = tf->ResolutionBase::LogPDerivative(x, ratio * x, &good);
+      if (!(deviation(analytic, numeric) < tolerance)) ++ndeviations;
+    }
+  }
+  return ndeviations;
+}
+}  // namespace
+
+
+// ---------------------------------------------------------
+// ---------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Wrong number of arguments." << std::endl;
+    std::cerr << "Usage: test-ljets-gradient [base directory]" << std::endl;
+    return -1;
+  }
+  const auto base_dir = std::string(argv[1]);
+
+  KLFitter::DetectorSnowmass detector{base_dir + "/data/transferfunctions/snowmass"};
+
+  int nlikelihood{0};
+  int nfit{0};
+  for (const auto lepton : {KLFitter::LikelihoodTopLeptonJets::LeptonType::kElectron,
+                            KLFitter::LikelihoodTopLeptonJets::LeptonType::kMuon}) {
+    const auto particles = getExampleParticles(lepton == KLFitter::LikelihoodTopLeptonJets::LeptonType::kMuon ?
+                                               KLFitter::Particles::kMuon : KLFitter::Particles::kElectron);
+    KLFitter::LikelihoodTopLeptonJets lh{};
+    lh.SetLeptonType(lepton);
+    KLFitter::Fitter fitter{};
+    fitter.SetLikelihood(&lh);
+    if (!fitter.SetDetector(&detector)) {
+      std::cerr << "Setting up the detector failed" << std::endl;
+      return -1;
+    }
+    fitter.SetParticles(particles.get());
+    nlikelihood += checkLikelihoodGradient(&fitter);
+    fitter.TurnOffSA();
+    fitter.SetET_miss_XY_SumET(met_x, met_y, sumet);
+    nfit += checkFitWithGradient(&fitter);
+  }
+  std::cout << "Likelihood gradient: " << nlikelihood << " deviating derivatives" << std::endl;
+  std::cout << "Fit with gradient: " << nfit << " deviating permutations" << std::endl;
+
+  // The double Gaussians are not used by the Snowmass detector.
+  const std::vector<double> parameters{0.02, -0.0001, 0.8, 0.04, 0.15, 0.0004, -0.08, 0.0002, 0.12, 0.0003};
+  KLFitter::ResDoubleGaussE_1 tf1{parameters};
+  KLFitter::ResDoubleGaussE_2 tf2{parameters};
+  KLFitter::ResDoubleGaussE_3 tf3{parameters};
+  KLFitter::ResDoubleGaussE_4 tf4{parameters};
+  KLFitter::ResDoubleGaussE_5 tf5{parameters};
+  KLFitter::ResDoubleGaussPt tfpt{parameters};
+  int ntf{0};
+  for (KLFitter::ResolutionBase* tf : std::vector<KLFitter::ResolutionBase*>{&tf1, &tf2, &tf3, &tf4, &tf5, &tfpt}) {
+    ntf += checkTFDerivative(tf);
+  }
+  std::cout << "Transfer functions: " << ntf << " deviating derivatives" << std::endl;
+
+  return (nlikelihood == 0 && nfit == 0 && ntf == 0) ? 0 : -1;
+}
@@ -122,8 +122,9 @@ int main(int argc, char* argv[]) {
   std::vector<float> evt_probs{};
   for (int perm = 0; perm < nperm; ++perm) {
     fitter.Fit(perm);
-    lh_values.emplace_back(fitter.Likelihood()->LogLikelihood(fitter.Likelihood()->GetBestFitParameters()));
-    evt_probs.emplace_back(std::exp(fitter.Likelihood()->LogEventProbability()));
+    const KLFitter::Fitter::FitResult* result = fitter.Result(perm);
+    lh_values.emplace_back(result->logLikelihood);
+    evt_probs.emplace_back(std::exp(result->logEventProbability));
   }
 
   normalizeValues(&evt_probs);
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2009--2018, the KLFitter developer team
+ *
+ * This file is part of KLFitter.
+ *
+ * KLFitter is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * KLFitter is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with KLFitter. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks that the cache of permutation tables across events (see
+// Fitter::SetPermutationCache()) reproduces the tables and the fit
+// results without the cache, for LikelihoodTopLeptonJets and
+// LikelihoodTTZTrilepton with and without b-tagging vetoes. The
+// events differ in the numbers of jets and leptons and in the
+// b-tagging, and some of them share the signature of an earlier one.
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "KLFitter/DetectorSnowmass.h"
+#include "KLFitter/Fitter.h"
+#include "KLFitter/LikelihoodTTZTrilepton.h"
+#include "KLFitter/LikelihoodTopLeptonJets.h"
+#include "KLFitter/Permutations.h"
+#include "TLorentzVector.h"
+
+namespace {
+const double met_x{24.409};
+const double met_y{9.302};
+const double sumet{126.126};
+
+// The description of an event: the numbers of jets, electrons and
+// muons, a bit mask of the b-tagged jets and a scale of the jet
+// energies.
+struct EventSpec {
+  int njets;
+  int nelectrons;
+  int nmuons;
+  unsigned int btags;
+  double scale;
+};
+
+std::unique_ptr<KLFitter::Particles> getExampleParticles(const EventSpec& spec) {
+  const std::vector<std::vector<double> > jets{{109.76644, -1.72677, -1.89648, 321.52453},
+                                               {42.62102, 1.70513, -1.70058, 122.33720},
+                                               {129.14176, 1.58536, -2.52456, 331.68742},
+                                               {115.65143, 1.55883, 0.11097, 289.89696},
+                                               {100.51990, 1.14155, 1.46838, 175.17933}};
+  const std::vector<std::vector<double> > leptons{{36.50896, 0.66745, 2.61193, 44.95000},
+                                                  {46.38216, -0.21381, -1.83514, 47.45000},
+                                                  {44.30869, 0.87361, 1.70395, 62.32200},
+                                                  {30.50189, 0.44840, 2.96493, 33.62011}};
+
+  std::unique_ptr<KLFitter::Particles> particles{new KLFitter::Particles};
+  for (int i = 0; i < spec.njets; ++i) {
+    TLorentzVector jet{};
+    jet.SetPtEtaPhiE(jets[i][0] * spec.scale, jets[i][1], jets[i][2], jets[i][3] * spec.scale);
+    particles->AddParticle(&jet, jet.Eta(), KLFitter::Particles::kParton, "", i, (spec.btags >> i) & 1, 0.7, 125.);
+  }
+  for (int i = 0; i < spec.nelectrons + spec.nmuons; ++i) {
+    TLorentzVector lep{};
+    lep.SetPtEtaPhiE(leptons[i][0], leptons[i][1], leptons[i][2], leptons[i][3]);
+    if (i < spec.nelectrons) {
+      particles->AddParticle(&lep, lep.Eta(), KLFitter::Particles::kElectron, "", i);
+    } else {
+      particles->AddParticle(&lep, lep.Eta(), KLFitter::Particles::kMuon, "", i - spec.nelectrons);
+    }
+  }
+  return particles;
+}
+
+// Set up the events in a fitter with and in one without the cache,
+// compare the permutation tables and fit all permutations, and
+// return the number of deviations.
+int checkCache(const std::string& name, KLFitter::LikelihoodBase* lh, KLFitter::DetectorBase* detector,
+               const std::vector<EventSpec>& specs) {
+  std::unique_ptr<KLFitter::LikelihoodBase> lhcached{lh->Clone()};
+  KLFitter::Fitter fitter{};
+  KLFitter::Fitter cached{};
+  fitter.SetLikelihood(lh);
+  cached.SetLikelihood(lhcached.get());
+  cached.SetPermutationCache(4);
+  if (!fitter.SetDetector(detector) || !cached.SetDetector(detector)) {
+    std::cerr << "Setting up the detector failed" << std::endl;
+    return 1;
+  }
+  fitter.TurnOffSA();
+  cached.TurnOffSA();
+
+  int ndeviations{0};
+  for (std::size_t ievent = 0; ievent < specs.size(); ++ievent) {
+    const auto particles = getExampleParticles(specs[ievent]);
+    const int status = fitter.SetParticles(particles.get());
+    if (cached.SetParticles(particles.get()) != status ||
+        *cached.Permutations()->PermutationTable() != *fitter.Permutations()->PermutationTable()) {
+      std::cout << name << ", event " << ievent << ": the permutation tables differ" << std::endl;
+      ++ndeviations;
+      continue;
+    }
+    fitter.SetET_miss_XY_SumET(met_x, met_y, sumet);
+    cached.SetET_miss_XY_SumET(met_x, met_y, sumet);
+
+    for (int iperm = 0; iperm < fitter.Permutations()->NPermutations(); ++iperm) {
+      fitter.Fit(iperm);
+      cached.Fit(iperm);
+      const KLFitter::Fitter::FitResult* result = fitter.Result(iperm);
+      const KLFitter::Fitter::FitResult* cachedresult = cached.Result(iperm);
+      if (!result || !cachedresult || result->parameters != cachedresult->parameters ||
+          result->logEventProbability != cachedresult->logEventProbability ||
+          result->minuitStatus != cachedresult->minuitStatus ||
+          result->convergenceStatus != cachedresult->convergenceStatus) {
+        std::cout << name << ", event " << ievent << ", permutation " << iperm << ": the results differ" << std::endl;
+        ++ndeviations;
+      }
+    }
+  }
+  return ndeviations;
+}
+}  // namespace
+
+// ---------------------------------------------------------
+// ---------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Wrong number of arguments." << std::endl;
+    std::cerr << "Usage: test-permutation-cache [base directory]" << std::endl;
+    return -1;
+  }
+  const auto base_dir = std::string(argv[1]);
+
+  KLFitter::DetectorSnowmass detector{base_dir + "/data/transferfunctions/snowmass"};
+  const std::vector<KLFitter::LikelihoodBase::BtaggingMethod> methods{KLFitter::LikelihoodBase::kNotag,
+                                                                     KLFitter::LikelihoodBase::kVeto,
+                                                                     KLFitter::LikelihoodBase::kVetoHybridNoFit};
+  int ndeviations{0};
+
+  // With three b-tagged jets out of four, every permutation has a
+  // b-tagged jet in the position of a light quark, so that
+  // kVetoHybridNoFit falls back to the veto of untagged b quarks.
+  const std::vector<EventSpec> ljets{{4, 0, 1, 0x3, 1.},  {5, 0, 1, 0x3, 1.},  {4, 0, 1, 0x3, 1.05},
+                                     {5, 0, 1, 0x6, 1.},  {5, 0, 1, 0x3, 0.95}, {4, 0, 1, 0x7, 1.},
+                                     {4, 1, 1, 0x3, 1.},  {4, 0, 1, 0x7, 0.95}};
+  for (const auto method : methods) {
+    KLFitter::LikelihoodTopLeptonJets lh{};
+    lh.SetLeptonType(KLFitter::LikelihoodTopLeptonJets::kMuon);
+    lh.SetBTagging(method);
+    ndeviations += checkCache("LikelihoodTopLeptonJets, b-tagging " + std::to_string(method), &lh, &detector, ljets);
+  }
+
+  // The invariances of LikelihoodTTZTrilepton depend on the number of
+  // jets and on the muons of an electron channel.
+  const std::vector<EventSpec> ttz{{4, 3, 0, 0x3, 1.}, {5, 3, 0, 0x3, 1.}, {4, 3, 0, 0x3, 1.05},
+                                   {4, 3, 1, 0x3, 1.}, {4, 3, 0, 0x7, 1.}, {5, 3, 0, 0x3, 0.95}};
+  for (const auto method : methods) {
+    KLFitter::LikelihoodTTZTrilepton lh{};
+    lh.SetLeptonType(KLFitter::LikelihoodTTZTrilepton::kElectron);
+    lh.SetBTagging(method);
+    ndeviations += checkCache("LikelihoodTTZTrilepton, b-tagging " + std::to_string(method), &lh, &detector, ttz);
+  }
+
+  std::cout << "Permutation cache: " << ndeviations << " deviations" << std::endl;
+
+  return ndeviations == 0 ? 0 : -1;
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2009--2018, the KLFitter developer team
+ *
+ * This file is part of KLFitter.
+ *
+ * KLFitter is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * KLFitter is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with KLFitter. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the counting, ranking and unranking of permutations and the
+// creation of ranges of permutations against the full tables, for
+// 4 to 8 jets with the invariances of LikelihoodTopLeptonJets and
+// LikelihoodTTZTrilepton and with and without a limited number of
+// partons per permutation. Checks the b-tagging veto of
+// kVetoHybridNoFit against the vetoes applied to the full table, with
+// and without permutations passing the strict veto.
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "KLFitter/Fitter.h"
+#include "KLFitter/LikelihoodTTZTrilepton.h"
+#include "KLFitter/LikelihoodTopLeptonJets.h"
+#include "KLFitter/Permutations.h"
+#include "TLorentzVector.h"
+
+namespace {
+// The numbers of ranges which are put together to the full table.
+const std::vector<long long> range_numbers{1, 3, 16};
+
+// An event with the first njets jets of a fixed list, nelectrons
+// electrons and nmuons muons; btags is a bit mask of the b-tagged jets.
+std::unique_ptr<KLFitter::Particles> getExampleParticles(int njets, int nelectrons, int nmuons,
+                                                         unsigned int btags = 0x3) {
+  const std::vector<std::vector<double> > jets{{109.76644, -1.72677, -1.89648, 321.52453},
+                                               {42.62102, 1.70513, -1.70058, 122.33720},
+                                               {129.14176, 1.58536, -2.52456, 331.68742},
+                                               {115.65143, 1.55883, 0.11097, 289.89696},
+                                               {100.51990, 1.14155, 1.46838, 175.17933},
+                                               {146.40852, 0.69004, 3.02919, 184.49715},
+                                               {77.834281, 0.81583, -1.53364, 105.72334},
+                                               {43.140816, 0.40291, -0.47272, 47.186804}};
+  const std::vector<std::vector<double> > leptons{{36.50896, 0.66745, 2.61193, 44.95000},
+                                                  {46.38216, -0.21381, -1.83514, 47.45000},
+                                                  {44.30869, 0.87361, 1.70395, 62.32200},
+                                                  {30.50189, 0.44840, 2.96493, 33.62011}};
+
+  std::unique_ptr<KLFitter::Particles> particles{new KLFitter::Particles};
+  for (int i = 0; i < njets; ++i) {
+    TLorentzVector jet{};
+    jet.SetPtEtaPhiE(jets[i][0], jets[i][1], jets[i][2], jets[i][3]);
+    particles->AddParticle(&jet, jet.Eta(), KLFitter::Particles::kParton, "", i, (btags >> i) & 1, 0.7, 125.);
+  }
+  for (int i = 0; i < nelectrons + nmuons; ++i) {
+    TLorentzVector lep{};
+    lep.SetPtEtaPhiE(leptons[i][0], leptons[i][1], leptons[i][2], leptons[i][3]);
+    if (i < nelectrons) {
+      particles->AddParticle(&lep, lep.Eta(), KLFitter::Particles::kElectron, "", i);
+    } else {
+      particles->AddParticle(&lep, lep.Eta(), KLFitter::Particles::kMuon, "", i - nelectrons);
+    }
+  }
+  return particles;
+}
+
+// Create the table of an event with the invariances of the likelihood
+// and compare it with the count, the ranks and the ranges of the
+// permutations. Return the number of deviations.
+int checkPermutations(const std::string& name, KLFitter::LikelihoodBase* lh, KLFitter::Particles* particles,
+                      int npartons) {
+  KLFitter::Fitter fitter{};
+  fitter.SetLikelihood(lh);
+  if (!fitter.SetParticles(particles, npartons)) {
+    std::cout << name << ": setting the particles failed" << std::endl;
+    return 1;
+  }
+  KLFitter::Permutations* permutations = fitter.Permutations();
+  const std::vector<std::vector<int> > table = *permutations->PermutationTable();
+
+  int ndeviations{0};
+  if (permutations->CountPermutations(npartons) != static_cast<long long>(table.size())) {
+    std::cout << name << ": " << permutations->CountPermutations(npartons) << " permutations counted, "
+              << table.size() << " created" << std::endl;
+    ++ndeviations;
+  }
+
+  // the light quarks are invariant in both likelihoods, so swapping
+  // them gives a permutation which is not created (checked for every
+  // tenth permutation, as every rank enumerates the combinations)
+  std::vector<int> permutation{};
+  for (std::size_t rank = 0; rank < table.size(); ++rank) {
+    if (!permutations->UnrankPermutation(rank, &permutation, npartons) || permutation != table[rank] ||
+        permutations->RankPermutation(table[rank], npartons) != static_cast<long long>(rank)) {
+      std::cout << name << ", permutation " << rank << ": wrong rank" << std::endl;
+      ++ndeviations;
+    }
+    if (rank % 10 != 0) continue;
+    std::swap(permutation.at(2), permutation.at(3));
+    if (permutations->RankPermutation(permutation, npartons) != -1) {
+      std::cout << name << ", permutation " << rank << ": invariant permutation ranked" << std::endl;
+      ++ndeviations;
+    }
+  }
+
+  for (const long long number : range_numbers) {
+    const long long size = (static_cast<long long>(table.size()) + number - 1) / number;
+    std::vector<std::vector<int> > ranges{};
+    for (long long first = 0; first < static_cast<long long>(table.size()); first += size) {
+      if (!permutations->CreatePermutations(npartons, first, size)) {
+        ++ndeviations;
+        break;
+      }
+      const std::vector<std::vector<int> >& range = *permutations->PermutationTable();
+      ranges.insert(ranges.end(), range.begin(), range.end());
+    }
+    if (ranges != table) {
+      std::cout << name << ": the ranges of " << size << " permutations differ from the table" << std::endl;
+      ++ndeviations;
+    }
+  }
+  return ndeviations;
+}
+
+// Compare the table of LikelihoodTopLeptonJets with kVetoHybridNoFit
+// with the permutations of the table without b-tagging which have no
+// b-tagged jet in the position of a light quark or, if there are none
+// (fallback), no untagged jet in the position of a b quark. Return
+// the number of deviations.
+int checkHybridVeto(const std::string& name, KLFitter::Particles* particles, bool fallback) {
+  KLFitter::LikelihoodTopLeptonJets lh{};
+  lh.SetLeptonType(KLFitter::LikelihoodTopLeptonJets::kMuon);
+  lh.SetBTagging(KLFitter::LikelihoodBase::kNotag);
+  KLFitter::Fitter fitter{};
+  fitter.SetLikelihood(&lh);
+  if (!fitter.SetParticles(particles)) {
+    std::cout << name << ": setting the particles failed" << std::endl;
+    return 1;
+  }
+
+  // the model partons are the hadronic and the leptonic b quark and
+  // the two light quarks
+  std::vector<std::vector<int> > strict{};
+  std::vector<std::vector<int> > light{};
+  for (const auto& permutation : *fitter.Permutations()->PermutationTable()) {
+    if (!particles->IsBTagged(permutation[2]) && !particles->IsBTagged(permutation[3]))
+      strict.emplace_back(permutation);
+    if (particles->IsBTagged(permutation[0]) && particles->IsBTagged(permutation[1]))
+      light.emplace_back(permutation);
+  }
+  if (strict.empty() != fallback) {
+    std::cout << name << ": " << strict.size() << " permutations pass the strict veto" << std::endl;
+    return 1;
+  }
+
+  lh.SetBTagging(KLFitter::LikelihoodBase::kVetoHybridNoFit);
+  if (!fitter.SetParticles(particles) || *fitter.Permutations()->PermutationTable() != (fallback ? light : strict)) {
+    std::cout << name << ": the permutations differ from the veto" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+}  // namespace
+
+// ---------------------------------------------------------
+// ---------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Wrong number of arguments." << std::endl;
+    std::cerr << "Usage: test-permutations [base directory]" << std::endl;
+    return -1;
+  }
+
+  int ndeviations{0};
+  for (int njets = 4; njets <= 8; ++njets) {
+    for (const int npartons : {-1, 4, 5}) {
+      if (npartons > njets) continue;
+      const std::string suffix = ", " + std::to_string(njets) + " jets, " + std::to_string(npartons) + " partons";
+
+      const auto ljets = getExampleParticles(njets, 0, 1);
+      KLFitter::LikelihoodTopLeptonJets lhljets{};
+      lhljets.SetLeptonType(KLFitter::LikelihoodTopLeptonJets::kMuon);
+      lhljets.SetBTagging(KLFitter::LikelihoodBase::kNotag);
+      ndeviations += checkPermutations("LikelihoodTopLeptonJets" + suffix, &lhljets, ljets.get(), npartons);
+
+      const auto ttz = getExampleParticles(njets, 3, 1);
+      KLFitter::LikelihoodTTZTrilepton lhttz{};
+      lhttz.SetLeptonType(KLFitter::LikelihoodTTZTrilepton::kElectron);
+      lhttz.SetBTagging(KLFitter::LikelihoodBase::kNotag);
+      ndeviations += checkPermutations("LikelihoodTTZTrilepton" + suffix, &lhttz, ttz.get(), npartons);
+    }
+  }
+
+  // With two b-tagged jets, some permutations pass the strict veto of
+  // kVetoHybridNoFit. With three b-tagged jets out of four, a b-tagged
+  // jet is in the position of a light quark in every permutation.
+  const auto strict = getExampleParticles(5, 0, 1, 0x3);
+  ndeviations += checkHybridVeto("kVetoHybridNoFit, strict veto", strict.get(), false);
+  const auto fallback = getExampleParticles(4, 0, 1, 0x7);
+  ndeviations += checkHybridVeto("kVetoHybridNoFit, fallback", fallback.get(), true);
+
+  std::cout << "Permutations: " << ndeviations << " deviations" << std::endl;
+
+  return ndeviations == 0 ? 0 : -1;
+}
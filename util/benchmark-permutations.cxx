@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2009--2018, the KLFitter developer team
+ *
+ * This file is part of KLFitter.
+ *
+ * KLFitter is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * KLFitter is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with KLFitter. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmark of the removal of the permutations which exchange the
+// two top quarks in the all-hadronic channel, comparing the hash-based
+// InvariantParticleGroupPermutations() with the pairwise comparison
+// of all permutations it replaces.
+
+// c++ includes
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// KLFitter includes
+#include "KLFitter/Particles.h"
+#include "KLFitter/Permutations.h"
+
+// ROOT includes
+#include "TLorentzVector.h"
+
+namespace {
+// The positions of the partons of the two top quarks.
+const std::vector<int> top1{0, 2, 3};
+const std::vector<int> top2{1, 4, 5};
+
+// Create the permutations of an all-hadronic event with the given
+// number of jets, with the invariances of the W decays and of the
+// jets not in the event, as in LikelihoodTopAllHadronic.
+void createPermutations(KLFitter::Permutations* permutations) {
+  const int njets = permutations->Particles()->NPartons();
+  std::vector<int> unused;
+  for (int i = 6; i < njets; ++i)
+    unused.push_back(i);
+
+  permutations->Reset();
+  permutations->InvariantParticlePermutations(KLFitter::Particles::kParton, {2, 3});
+  permutations->InvariantParticlePermutations(KLFitter::Particles::kParton, {4, 5});
+  permutations->InvariantParticlePermutations(KLFitter::Particles::kParton, unused);
+  permutations->CreatePermutations();
+}
+
+// The pairwise comparison: a permutation is removed if a later
+// permutation which is kept has the partons of the two top quarks
+// exchanged.
+std::vector<std::vector<int> > removePairwise(const std::vector<std::vector<int> >& table) {
+  std::vector<bool> removed(table.size(), false);
+  for (int iperm1 = static_cast<int>(table.size()) - 1; iperm1 >= 1; --iperm1) {
+    if (removed[iperm1])
+      continue;
+    for (int iperm2 = iperm1 - 1; iperm2 >= 0; --iperm2) {
+      bool exchanged = true;
+      for (std::size_t i = 0; i < top1.size() && exchanged; ++i) {
+        exchanged = table[iperm1][top1[i]] == table[iperm2][top2[i]] &&
+                    table[iperm1][top2[i]] == table[iperm2][top1[i]];
+      }
+      if (exchanged)
+        removed[iperm2] = true;
+    }
+  }
+
+  std::vector<std::vector<int> > result;
+  for (std::size_t iperm = 0; iperm < table.size(); ++iperm) {
+    if (!removed[iperm])
+      result.push_back(table[iperm]);
+  }
+  return result;
+}
+}  // namespace
+
+int main() {
+  int nfailed = 0;
+  for (int njets : {6, 8, 10}) {
+    KLFitter::Particles particles{};
+    for (int i = 0; i < njets; ++i) {
+      TLorentzVector jet{};
+      jet.SetPtEtaPhiM(150. - 10. * i, 0.1 * i, 0.5 * i, 5.);
+      particles.AddParticle(&jet, jet.Eta(), KLFitter::Particles::kParton, "", i);
+    }
+    KLFitter::Particles* original = &particles;
+    KLFitter::Particles* permuted = nullptr;
+    KLFitter::Permutations permutations{&original, &permuted};
+    permutations.SetIndexOnly(true);
+    createPermutations(&permutations);
+    const std::vector<std::vector<int> > table = *permutations.PermutationTable();
+
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<std::vector<int> > reference = removePairwise(table);
+    const std::chrono::duration<double> pairwise = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    permutations.InvariantParticleGroupPermutations(KLFitter::Particles::kParton, top1, top2);
+    const std::chrono::duration<double> hashed = std::chrono::steady_clock::now() - start;
+
+    const bool same = reference == *permutations.PermutationTable();
+    if (!same)
+      ++nfailed;
+    std::cout << njets << " jets: " << table.size() << " -> " << permutations.NPermutations() << " permutations, "
+              << "pairwise " << pairwise.count() * 1e3 << " ms, hashed " << hashed.count() * 1e3 << " ms, "
+              << "speedup " << pairwise.count() / hashed.count() << (same ? "" : ", DIFFERENT RESULT") << std::endl;
+  }
+
+  return nfailed == 0 ? 0 : 1;
+}
@@ -95,6 +95,10 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
+  // Keep the model particles in the fit results, which are read
+  // for every permutation below.
+  fitter.SetResultDetail(KLFitter::Fitter::kResultModelParticles);
+
   bool isFirst(true);
 
   // Open the output ROOT file.
@@ -299,9 +303,10 @@ int main(int argc, char *argv[]) {
     for (int iperm  = 0; iperm < nperm; iperm++) {
       // Do the fitting magic.
       fitter.Fit(iperm);
+      const KLFitter::Fitter::FitResult* result = fitter.Result(iperm);
 
       // Read the output and convergence status of the fit.
-      unsigned int ConvergenceStatusBitWord = fitter.ConvergenceStatus();
+      unsigned int ConvergenceStatusBitWord = result->convergenceStatus;
       bool MinuitDidNotConverge = (ConvergenceStatusBitWord & fitter.MinuitDidNotConvergeMask) != 0;
       bool FitAbortedDueToNaN = (ConvergenceStatusBitWord & fitter.FitAbortedDueToNaNMask) != 0;
       bool AtLeastOneFitParameterAtItsLimit = (ConvergenceStatusBitWord & fitter.AtLeastOneFitParameterAtItsLimitMask) != 0;
@@ -309,11 +314,11 @@ int main(int argc, char *argv[]) {
 
       // Get log likelihood and event probability values. Note
       // that the event probablity is _not_ normalized.
-      double likelihood = fitter.Likelihood()->LogLikelihood(fitter.Likelihood()->GetBestFitParameters());
-      double event_probability = std::exp(fitter.Likelihood()->LogEventProbability());
+      double likelihood = result->logLikelihood;
+      double event_probability = std::exp(result->logEventProbability);
 
       // Get the values of all fitted variables.
-      auto modelParticles = fitter.Likelihood()->ParticlesModel();
+      auto modelParticles = result->modelParticles.get();
       auto permutedParticles = fitter.Likelihood()->PParticlesPermuted();
 
       // Hadronic b quark.